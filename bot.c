@@ -0,0 +1,239 @@
+// ----------------------------------------------------------------------
+// File: bot.c
+//
+// Name: Al Shaffer & Marshall Liu
+//
+// Description: This BOT module is a simple computer player. It goes
+//     for as many of one face as it can, stops rolling when it has a
+//     full house, a large straight or a YAHTZEE it can still use, and
+//     scores wherever the dice are worth the most. It plays through
+//     game_step() like anyone else, so it's useful for playing lots of
+//     headless games and as something to measure better players by.
+//
+//     It can instead pick its keeps with the SEARCH module, given a
+//     time limit per decision.
+// ----------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "score.h"
+#include "rules.h"
+#include "game.h"
+#include "search.h"
+#include "bot.h"
+
+// When the dice don't fit anything, a zero goes on the first unused
+// item in this list, which are the ones that are least often missed.
+static const int Dump_order[NUMBER_OF_CATEGORIES] = {
+    ACES, YAHTZEE, TWOS, KIND4, STRAIGHT_LG, THREES, FULL_HOUSE,
+    STRAIGHT_SM, KIND3, FOURS, FIVES, SIXES, CHANCE
+};
+
+
+// **************************************************************************
+// **************************** GLOBAL VARIABLES ****************************
+// **************************************************************************
+
+static struct search_t Search;             // When searching
+static long            Deadline_us = -1;   // For searching; < 0 if not
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     best_item
+// Inputs
+//     game
+//         The game being played.
+// Outputs
+//     function result
+// Description
+//     Returns the item the dice are worth the most in, of the ones
+//     the Joker rule allows, or the first of those in Dump_order if
+//     they're worth nothing.
+// ---------------------------------------------------------------------
+static int best_item(const struct game_t *game)
+{
+    int best = 0;
+    int best_score = 0;
+    int score;
+
+    for (int item = ACES; item <= CHANCE; ++item) {
+        if (!rules_allowed(game->dice, game->used, item)) {
+            continue;
+        }
+        score = rules_card_score(game->dice, game->used, item);
+        if (score > best_score) {
+            best = item;
+            best_score = score;
+        }
+    }
+    for (int i = 0; (best == 0) && (i < NUMBER_OF_CATEGORIES); ++i) {
+        if (rules_allowed(game->dice, game->used, Dump_order[i])) {
+            best = Dump_order[i];
+        }
+    }
+
+    return best;
+
+}//end best_item
+
+
+// ---------------------------------------------------------------------
+// Function
+//     is_made
+// Inputs
+//     game
+//         The game being played.
+// Outputs
+//     function result
+// Description
+//     Returns true if the dice already are something that can't be
+//     improved on by rolling and that's still open on the scorecard.
+// ---------------------------------------------------------------------
+static bool is_made(const struct game_t *game)
+{
+    static const int made[] = { YAHTZEE, STRAIGHT_LG, FULL_HOUSE };
+
+    for (unsigned int i = 0; i < sizeof(made) / sizeof(made[0]); ++i) {
+        if (!(game->used & (1u << made[i])) &&
+            (rules_score(game->dice, made[i]) > 0)) {
+            return true;
+        }
+    }
+
+    return false;
+
+}//end is_made
+
+
+// ---------------------------------------------------------------------
+// Function
+//     keep_for
+// Inputs
+//     game
+//         The game being played.
+// Outputs
+//     function result
+// Description
+//     Returns the dice to keep (a bit mask) before the next roll: all
+//     the dice showing the most common face, the higher face if there
+//     is a tie.
+// ---------------------------------------------------------------------
+static unsigned int keep_for(const struct game_t *game)
+{
+    int          count[NUMBER_OF_SIDES + 1] = { 0 };
+    int          face = NUMBER_OF_SIDES;
+    unsigned int keep = 0;
+
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        ++count[game->dice[i]];
+    }
+    for (int f = NUMBER_OF_SIDES; f >= 1; --f) {
+        if (count[f] > count[face]) {
+            face = f;
+        }
+    }
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        if (game->dice[i] == face) {
+            keep |= 1u << i;
+        }
+    }
+
+    return keep;
+
+}//end keep_for
+
+
+// ************************************************************************
+// *************************  EXTERNAL FUNCTIONS **************************
+// ************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     bot_choose
+// Inputs
+//     game
+//         A game that isn't over.
+// Outputs
+//     function result
+// Description
+//     Returns what the bot does next: switch one die between keep and
+//     roll, roll, or score.
+// ---------------------------------------------------------------------
+struct game_action_t bot_choose(const struct game_t *game)
+{
+    struct game_action_t action = { GAME_SCORE, 0 };
+    unsigned int         change;
+
+    if (Deadline_us >= 0) {
+        return search_choose(&Search, game, Deadline_us);
+    }
+    if ((game->roll < MAX_ROLLS) && !is_made(game)) {
+        change = keep_for(game) ^ game->keep;
+        if (change != 0) {
+            action.type = GAME_KEEP;
+            action.arg  = __builtin_ctz(change) + 1;
+        } else {
+            action.type = GAME_ROLL;
+        }
+        return action;
+    }
+
+    action.arg = best_item(game);
+    return action;
+
+}//end bot_choose
+
+
+// ---------------------------------------------------------------------
+// Function
+//     bot_search
+// Inputs
+//     deadline_us
+//         How long each keep may take to pick, in microseconds (0 for
+//         no limit), or < 0 to go back to the simple player.
+// Outputs
+//     none
+// Description
+//     This function makes the bot pick its keeps by searching the rest
+//     of the turn.
+// ---------------------------------------------------------------------
+void bot_search(const long deadline_us)
+{
+    if ((deadline_us >= 0) && (Deadline_us < 0)) {
+        search_init(&Search);
+    }
+    Deadline_us = deadline_us;
+
+}//end bot_search
+
+
+// ---------------------------------------------------------------------
+// Function
+//     bot_play
+// Inputs
+//     game
+//         Where to put the finished game.
+//     seed
+//         The seed for the dice.
+// Outputs
+//     function result
+// Description
+//     This function plays a whole game and returns its grand total.
+// ---------------------------------------------------------------------
+int bot_play(struct game_t *game, const uint64_t seed)
+{
+    game_new(game, seed);
+    while (!game_over(game)) {
+        game_step(game, bot_choose(game), game);
+    }
+
+    return game_total(game);
+
+}//end bot_play
+
+// end bot.c
@@ -0,0 +1,19 @@
+// -------------------------------------------------------------------
+// File: bot.h
+//
+// Name: Marshall Liu
+//
+// Description: This is the header file for the BOT module, a simple
+//     computer player for headless games.
+// -------------------------------------------------------------------
+
+#ifndef BOT_H
+#define BOT_H
+
+#include "game.h"
+
+extern struct game_action_t bot_choose(const struct game_t *game);
+extern void bot_search(const long deadline_us);
+extern int bot_play(struct game_t *game, const uint64_t seed);
+
+#endif // BOT_H
@@ -0,0 +1,548 @@
+// ----------------------------------------------------------------------
+// File: dicetest.c
+//
+// Name: Al Shaffer & Marshall Liu
+//
+// Description: This is a statistical test of the dice. It rolls the
+//     dice exactly the way a game does (rules_seed() to start, then
+//     rules_roll() for each roll) on several threads at once, and then
+//     checks what came up:
+//
+//         - every face comes up equally often, on each die and overall
+//         - each pair of dice in a roll is independent (chi-square
+//           over the 36 pairs of faces, and their correlation)
+//         - a roll is independent of the roll before it
+//         - YAHTZEE, straights, full houses and so on come up as often
+//           as they should, which is worked out exactly by trying all
+//           7776 rolls
+//         - all 7776 rolls come up equally often
+//
+//     Each seed is used for a game's worth of rolls before moving on
+//     to the next seed, the way consecutive games are played, so both
+//     the seeding and the generator are tested. Every roll is counted
+//     by which of the 7776 it was, which is all that's needed for
+//     everything but the roll-to-roll test, so the rolling loop does
+//     very little besides rolling.
+//
+//     A test fails if its p-value is below the -a level. The program
+//     exits with EXIT_FAILURE if any test fails.
+//
+// Syntax: ./yahtzee_dice [-n rolls] [-t threads] [-s seed]
+//                        [-p rolls_per_seed] [-a alpha]
+// ----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "score.h"
+#include "rules.h"
+
+#define DEFAULT_ROLLS    1000000000ULL
+#define DEFAULT_SEED     1
+#define DEFAULT_PER_SEED (MAX_TURNS * MAX_ROLLS)   // A game's worth
+#define DEFAULT_ALPHA    1e-6
+#define MAX_THREADS      64
+#define SEEDS_PER_CHUNK  4096
+#define ROLLS            7776     // NUMBER_OF_SIDES ^ NUMBER_OF_DICE
+#define PAIRS            (NUMBER_OF_SIDES * NUMBER_OF_SIDES)
+#define BASE_10          10
+
+_Static_assert(NUMBER_OF_DICE == 5 && NUMBER_OF_SIDES == 6,
+               "ROLLS assumes five six-sided dice");
+
+
+// **************************************************************************
+// ****************************  DEFINED TYPES   ****************************
+// **************************************************************************
+
+// What one thread counted
+struct counts_t {
+    uint64_t rolls[ROLLS];          // By which roll it was
+    uint64_t serial[PAIRS * PAIRS]; // Last two dice of a roll by the
+                                    // last two of the roll before
+    uint64_t total;
+};
+
+// One rolling thread
+struct roller_t {
+    pthread_t       thread;
+    struct counts_t counts;
+};
+
+// A pattern of dice and how often it should come up
+struct pattern_t {
+    const char *name;
+    int         item;               // The item it scores in
+    uint64_t    ways;               // Out of ROLLS
+};
+
+
+// **************************************************************************
+// **************************** GLOBAL VARIABLES ****************************
+// **************************************************************************
+
+static uint64_t Seed = DEFAULT_SEED;
+static uint64_t Num_seeds;
+static uint64_t Per_seed = DEFAULT_PER_SEED;
+static uint64_t Next_seed;          // The next chunk to be claimed
+static double   Alpha = DEFAULT_ALPHA;
+static int      Failures;
+
+static struct pattern_t Patterns[] = {
+    { "3 of a kind",    KIND3,       0 },
+    { "4 of a kind",    KIND4,       0 },
+    { "Full house",     FULL_HOUSE,  0 },
+    { "Small straight", STRAIGHT_SM, 0 },
+    { "Large straight", STRAIGHT_LG, 0 },
+    { "Yahtzee",        YAHTZEE,     0 },
+};
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     roll_index
+// Inputs
+//     dice
+//         The face values of all the dice.
+// Outputs
+//     function result
+// Description
+//     Returns which of the 7776 rolls this is, 0 thru ROLLS - 1. The
+//     last die is the least significant.
+// ---------------------------------------------------------------------
+static inline unsigned int roll_index(const unsigned char dice[])
+{
+    unsigned int index = 0;
+
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        index = index * NUMBER_OF_SIDES + (dice[i] - 1);
+    }
+
+    return index;
+
+}//end roll_index
+
+
+// ---------------------------------------------------------------------
+// Function
+//     roll_loop
+// Inputs
+//     arg
+//         The roller_t for this thread.
+// Outputs
+//     function result
+// Description
+//     This is a rolling thread. It claims chunks of seeds until there
+//     are none left, and rolls Per_seed times from each.
+// ---------------------------------------------------------------------
+static void *roll_loop(void *arg)
+{
+    struct counts_t *c = &((struct roller_t *)arg)->counts;
+    unsigned char    dice[NUMBER_OF_DICE];
+    unsigned int     index;
+    unsigned int     previous;
+    uint64_t         first;
+    uint64_t         last;
+    uint64_t         rng;
+
+    for (;;) {
+        first = __atomic_fetch_add(&Next_seed, SEEDS_PER_CHUNK,
+                                   __ATOMIC_RELAXED);
+        if (first >= Num_seeds) {
+            break;
+        }
+        last = (first + SEEDS_PER_CHUNK < Num_seeds) ?
+               first + SEEDS_PER_CHUNK : Num_seeds;
+
+        for (uint64_t s = first; s < last; ++s) {
+            rng = rules_seed(Seed + s);
+            rules_roll(dice, 0, &rng);
+            index = roll_index(dice);
+            ++c->rolls[index];
+            previous = index % PAIRS;
+            for (uint64_t r = 1; r < Per_seed; ++r) {
+                rules_roll(dice, 0, &rng);
+                index = roll_index(dice);
+                ++c->rolls[index];
+                ++c->serial[previous * PAIRS + index % PAIRS];
+                previous = index % PAIRS;
+            }
+        }
+        c->total += (last - first) * Per_seed;
+    }
+
+    return NULL;
+
+}//end roll_loop
+
+
+// ---------------------------------------------------------------------
+// Function
+//     chi_square_p
+// Inputs
+//     x
+//         A chi-square statistic.
+//     dof
+//         Its degrees of freedom.
+// Outputs
+//     function result
+// Description
+//     Returns the chance of a statistic at least this big, by the
+//     Wilson-Hilferty approximation, which is plenty close enough for
+//     deciding pass or fail.
+// ---------------------------------------------------------------------
+static double chi_square_p(const double x, const int dof)
+{
+    double k = dof;
+    double z = (cbrt(x / k) - (1 - 2 / (9 * k))) / sqrt(2 / (9 * k));
+
+    return 0.5 * erfc(z / sqrt(2));
+
+}//end chi_square_p
+
+
+// ---------------------------------------------------------------------
+// Function
+//     verdict
+// Inputs
+//     name
+//         What was tested.
+//     detail
+//         The statistic, already formatted.
+//     p
+//         The p-value.
+// Outputs
+//     none
+// Description
+//     This function prints one test's result and counts it if it
+//     failed.
+// ---------------------------------------------------------------------
+static void verdict(const char *name, const char *detail, const double p)
+{
+    bool failed = (p < Alpha);
+
+    Failures += failed;
+    printf("%-30s %-34s p = %-10.3g %s\n", name, detail, p,
+           failed ? "FAIL" : "ok");
+
+}//end verdict
+
+
+// ---------------------------------------------------------------------
+// Function
+//     chi_square_test
+// Inputs
+//     name
+//         What's being tested.
+//     observed
+//         How many times each outcome came up.
+//     cells
+//         How many outcomes there are. They're all equally likely.
+// Outputs
+//     none
+// Description
+//     This function tests that the outcomes came up equally often.
+// ---------------------------------------------------------------------
+static void chi_square_test(const char *name, const uint64_t observed[],
+                            const int cells)
+{
+    double total = 0;
+    double expected;
+    double x = 0;
+    char   detail[64];
+
+    for (int i = 0; i < cells; ++i) {
+        total += observed[i];
+    }
+    expected = total / cells;
+    for (int i = 0; i < cells; ++i) {
+        x += (observed[i] - expected) * (observed[i] - expected) / expected;
+    }
+
+    snprintf(detail, sizeof(detail), "chi2 = %.1f (%i dof)", x, cells - 1);
+    verdict(name, detail, chi_square_p(x, cells - 1));
+
+}//end chi_square_test
+
+
+// ---------------------------------------------------------------------
+// Function
+//     correlation_test
+// Inputs
+//     name
+//         What's being tested.
+//     joint
+//         How often each pair of faces came up, first face major.
+// Outputs
+//     none
+// Description
+//     This function tests that the two faces aren't correlated. For
+//     independent dice, r times the square root of the count is close
+//     to a standard normal.
+// ---------------------------------------------------------------------
+static void correlation_test(const char *name, const uint64_t joint[])
+{
+    double n = 0;
+    double sx = 0;
+    double sy = 0;
+    double sxx = 0;
+    double syy = 0;
+    double sxy = 0;
+    double c;
+    double r;
+    double z;
+    char   detail[64];
+
+    for (int x = 1; x <= NUMBER_OF_SIDES; ++x) {
+        for (int y = 1; y <= NUMBER_OF_SIDES; ++y) {
+            c = joint[(x - 1) * NUMBER_OF_SIDES + (y - 1)];
+            n   += c;
+            sx  += c * x;
+            sy  += c * y;
+            sxx += c * x * x;
+            syy += c * y * y;
+            sxy += c * x * y;
+        }
+    }
+    r = (n * sxy - sx * sy) /
+        sqrt((n * sxx - sx * sx) * (n * syy - sy * sy));
+    z = r * sqrt(n);
+
+    snprintf(detail, sizeof(detail), "r = %+.2e (z = %+.2f)", r, z);
+    verdict(name, detail, erfc(fabs(z) / sqrt(2)));
+
+}//end correlation_test
+
+
+// ---------------------------------------------------------------------
+// Function
+//     die_of
+// Inputs
+//     index
+//         Which of the 7776 rolls.
+//     die
+//         Which die, 0 thru NUMBER_OF_DICE - 1.
+// Outputs
+//     function result
+// Description
+//     Returns the face (0 thru NUMBER_OF_SIDES - 1) the die shows in
+//     that roll.
+// ---------------------------------------------------------------------
+static int die_of(unsigned int index, const int die)
+{
+    for (int i = NUMBER_OF_DICE - 1; i > die; --i) {
+        index /= NUMBER_OF_SIDES;
+    }
+
+    return index % NUMBER_OF_SIDES;
+
+}//end die_of
+
+
+// ---------------------------------------------------------------------
+// Function
+//     analyze
+// Inputs
+//     c
+//         Everything every thread counted.
+// Outputs
+//     none
+// Description
+//     This function runs every test on the counts.
+// ---------------------------------------------------------------------
+static void analyze(const struct counts_t *c)
+{
+    uint64_t      faces[NUMBER_OF_SIDES];
+    uint64_t      joint[PAIRS];
+    uint64_t      seen;
+    unsigned char dice[NUMBER_OF_DICE];
+    unsigned int  index;
+    double        n = c->total;
+    double        p;
+    double        z;
+    char          name[64];
+    char          detail[64];
+
+    // Each die on its own, then all of them together
+    memset(faces, 0, sizeof(faces));
+    for (int d = 0; d < NUMBER_OF_DICE; ++d) {
+        uint64_t die_faces[NUMBER_OF_SIDES] = { 0 };
+
+        for (index = 0; index < ROLLS; ++index) {
+            die_faces[die_of(index, d)] += c->rolls[index];
+        }
+        for (int f = 0; f < NUMBER_OF_SIDES; ++f) {
+            faces[f] += die_faces[f];
+        }
+        snprintf(name, sizeof(name), "Faces of die %i", d + 1);
+        chi_square_test(name, die_faces, NUMBER_OF_SIDES);
+    }
+    chi_square_test("Faces of all dice", faces, NUMBER_OF_SIDES);
+
+    // Every pair of dice in a roll
+    for (int a = 0; a < NUMBER_OF_DICE; ++a) {
+        for (int b = a + 1; b < NUMBER_OF_DICE; ++b) {
+            memset(joint, 0, sizeof(joint));
+            for (index = 0; index < ROLLS; ++index) {
+                joint[die_of(index, a) * NUMBER_OF_SIDES +
+                      die_of(index, b)] += c->rolls[index];
+            }
+            snprintf(name, sizeof(name), "Dice %i and %i, pairs", a + 1,
+                     b + 1);
+            chi_square_test(name, joint, PAIRS);
+            snprintf(name, sizeof(name), "Dice %i and %i, correlation",
+                     a + 1, b + 1);
+            correlation_test(name, joint);
+        }
+    }
+
+    // One roll to the next, by the same die
+    for (int d = 0; d < 2; ++d) {
+        memset(joint, 0, sizeof(joint));
+        for (int prev = 0; prev < PAIRS; ++prev) {
+            for (int next = 0; next < PAIRS; ++next) {
+                joint[((d == 0) ? prev / NUMBER_OF_SIDES :
+                       prev % NUMBER_OF_SIDES) * NUMBER_OF_SIDES +
+                      ((d == 0) ? next / NUMBER_OF_SIDES :
+                       next % NUMBER_OF_SIDES)] +=
+                    c->serial[prev * PAIRS + next];
+            }
+        }
+        snprintf(name, sizeof(name), "Die %i, roll to roll",
+                 NUMBER_OF_DICE - 1 + d);
+        correlation_test(name, joint);
+    }
+    chi_square_test("Dice 4-5, roll to roll", c->serial, PAIRS * PAIRS);
+
+    // The patterns, against their exact chances
+    for (unsigned int i = 0; i < sizeof(Patterns) / sizeof(Patterns[0]);
+         ++i) {
+        seen = 0;
+        for (index = 0; index < ROLLS; ++index) {
+            for (int d = 0; d < NUMBER_OF_DICE; ++d) {
+                dice[d] = die_of(index, d) + 1;
+            }
+            if (rules_score(dice, Patterns[i].item) > 0) {
+                seen += c->rolls[index];
+            }
+        }
+        p = (double)Patterns[i].ways / ROLLS;
+        z = (seen - n * p) / sqrt(n * p * (1 - p));
+        snprintf(detail, sizeof(detail), "%.6f vs %llu/%i (z = %+.2f)",
+                 seen / n, (unsigned long long)Patterns[i].ways, ROLLS, z);
+        verdict(Patterns[i].name, detail, erfc(fabs(z) / sqrt(2)));
+    }
+
+    // And every roll
+    chi_square_test("All 7776 rolls", c->rolls, ROLLS);
+
+}//end analyze
+
+
+// ---------------------------------------------------------------------
+// Function
+//     count_patterns
+// Inputs
+//     none
+// Outputs
+//     none
+// Description
+//     This function works out exactly how many of the 7776 rolls make
+//     each pattern, by scoring every one of them.
+// ---------------------------------------------------------------------
+static void count_patterns(void)
+{
+    unsigned char dice[NUMBER_OF_DICE];
+
+    for (unsigned int index = 0; index < ROLLS; ++index) {
+        for (int d = 0; d < NUMBER_OF_DICE; ++d) {
+            dice[d] = die_of(index, d) + 1;
+        }
+        for (unsigned int i = 0; i < sizeof(Patterns) / sizeof(Patterns[0]);
+             ++i) {
+            Patterns[i].ways += (rules_score(dice, Patterns[i].item) > 0);
+        }
+    }
+
+}//end count_patterns
+
+
+// **************************************************************************
+// *********************************  MAIN **********************************
+// **************************************************************************
+int main(int argc, char *argv[])
+{
+    static struct roller_t rollers[MAX_THREADS];
+    static struct counts_t all;
+    uint64_t               rolls = DEFAULT_ROLLS;
+    long                   threads = sysconf(_SC_NPROCESSORS_ONLN);
+    struct timespec        start;
+    struct timespec        end;
+    double                 seconds;
+    int                    opt;
+
+    while ((opt = getopt(argc, argv, "n:t:s:p:a:")) != -1) {
+        if (opt == 'n') {
+            rolls = strtod(optarg, NULL);   // So 1e10 works
+        } else if (opt == 't') {
+            threads = atoi(optarg);
+        } else if (opt == 's') {
+            Seed = strtoull(optarg, NULL, BASE_10);
+        } else if (opt == 'p') {
+            Per_seed = strtoull(optarg, NULL, BASE_10);
+        } else if (opt == 'a') {
+            Alpha = strtod(optarg, NULL);
+        } else {
+            fprintf(stderr, "Syntax: %s [-n rolls] [-t threads] [-s seed] "
+                    "[-p rolls_per_seed] [-a alpha]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if ((threads < 1) || (threads > MAX_THREADS) || (Per_seed < 2)) {
+        fprintf(stderr, "Error: need 1 thru %i threads and at least 2 "
+                "rolls per seed\n", MAX_THREADS);
+        return EXIT_FAILURE;
+    }
+    Num_seeds = (rolls + Per_seed - 1) / Per_seed;
+
+    count_patterns();
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int t = 0; t < threads; ++t) {
+        pthread_create(&rollers[t].thread, NULL, roll_loop, &rollers[t]);
+    }
+    for (int t = 0; t < threads; ++t) {
+        pthread_join(rollers[t].thread, NULL);
+        for (int i = 0; i < ROLLS; ++i) {
+            all.rolls[i] += rollers[t].counts.rolls[i];
+        }
+        for (int i = 0; i < PAIRS * PAIRS; ++i) {
+            all.serial[i] += rollers[t].counts.serial[i];
+        }
+        all.total += rollers[t].counts.total;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    printf("%llu rolls from %llu seeds on %li thread(s) in %.2f s "
+           "(%.0f million rolls/sec)\n\n", (unsigned long long)all.total,
+           (unsigned long long)Num_seeds, threads, seconds,
+           all.total / seconds / 1e6);
+    analyze(&all);
+    printf("\n%i test(s) failed at alpha = %g\n", Failures, Alpha);
+
+    return (Failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+} // end main
+
+// end dicetest.c
@@ -0,0 +1,351 @@
+// ----------------------------------------------------------------------
+// File: duel.c
+//
+// Name: Al Shaffer & Marshall Liu
+//
+// Description: This is a driver for the WINPROB module. It sets up a
+//     two-player match from given scorecards, sums the opponent up by
+//     playing their game out many times (for the most points, with the
+//     SOLVER module), solves for the best chance of beating that, and
+//     then checks the answer by playing matches: once playing to win
+//     and once playing for points, against fresh opponent games.
+//
+//     A position is given as used,upper,total: the items used as a hex
+//     mask (bit 0 is ACES), the upper section total, and the total so
+//     far with any bonus (YAHTZEE, if used, counts as scored 0). Both
+//     players start a fresh game by default.
+//     Solving from a fresh game takes a while; give -t more threads, or
+//     start later in the game.
+//
+// Syntax: ./yahtzee_duel [-p used,upper,total] [-o used,upper,total]
+//                        [-g opponent_games] [-m matches] [-s seed]
+//                        [-t threads]
+// ----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "score.h"
+#include "rules.h"
+#include "game.h"
+#include "solver.h"
+#include "winprob.h"
+#include "timing.h"
+
+#define DEFAULT_GAMES   20000
+#define DEFAULT_MATCHES 10000
+#define DEFAULT_SEED    1
+#define BASE_10         10
+#define BASE_16         16
+
+
+// **************************************************************************
+// ****************************  DEFINED TYPES   ****************************
+// **************************************************************************
+
+// Where a player's game starts
+struct position_t {
+    unsigned int mask;     // Items used, bit item - 1
+    int          upper;    // Upper section total
+    int          total;    // Total so far, bonus included
+};
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     most_scored
+// Inputs
+//     mask
+//         The items used.
+// Outputs
+//     function result
+// Description
+//     Returns the most a scorecard with those items used could have
+//     scored so far: each at its best, the upper bonus if those could
+//     make it, and a YAHTZEE bonus on every other turn if YAHTZEE was
+//     scored.
+// ---------------------------------------------------------------------
+static int most_scored(const unsigned int mask)
+{
+    const struct solver_dice_t *d = solver_dice();
+    int                         best;
+    int                         most = 0;
+    int                         upper = 0;
+
+    for (int item = ACES; item <= CHANCE; ++item) {
+        if (!(mask & (1u << (item - ACES)))) {
+            continue;
+        }
+        best = 0;
+        for (int r = 0; r < SOLVER_ROLLS; ++r) {
+            best = (d->roll_score[r][item] > best) ? d->roll_score[r][item]
+                                                   : best;
+        }
+        most  += best;
+        upper += (item <= SIXES) ? best : 0;
+    }
+    most += (upper >= BONUS_THRESHOLD) ? SCORE_BONUS : 0;
+    if (mask & SOLVER_YAHTZEE_BIT) {
+        most += (__builtin_popcount(mask) - 1) * SCORE_YAHTZEE_BONUS;
+    }
+
+    return most;
+
+}//end most_scored
+
+
+// ---------------------------------------------------------------------
+// Function
+//     parse_position
+// Inputs
+//     text
+//         used,upper,total as given on the command line.
+//     position
+//         Where to put it.
+// Outputs
+//     function result
+// Description
+//     This function reads a position, returning false if it doesn't
+//     make sense, including a total the items used couldn't have
+//     scored (which would finish past WINPROB_MAX_TOTAL).
+// ---------------------------------------------------------------------
+static bool parse_position(const char *text, struct position_t *position)
+{
+    char *end;
+
+    position->mask  = strtoul(text, &end, BASE_16);
+    position->upper = (*end == ',') ? strtol(end + 1, &end, BASE_10) : -1;
+    position->total = (*end == ',') ? strtol(end + 1, &end, BASE_10) : -1;
+
+    return (*end == '\0') && (position->mask < SOLVER_MASKS - 1) &&
+           (position->upper >= 0) && (position->total >= position->upper) &&
+           (position->total <= most_scored(position->mask)) &&
+           solver_reachable(position->mask,
+                            (position->upper > BONUS_THRESHOLD) ?
+                            BONUS_THRESHOLD : position->upper);
+
+}//end parse_position
+
+
+// ---------------------------------------------------------------------
+// Function
+//     start_game
+// Inputs
+//     position
+//         Where the game starts.
+//     seed
+//         The seed for the dice.
+//     game
+//         Where to put the game.
+// Outputs
+//     function result
+// Description
+//     This function starts a game from the position and returns what
+//     has to be added to its game_total() to give the position's total.
+//     The upper section total all goes on the first upper item used.
+// ---------------------------------------------------------------------
+static int start_game(const struct position_t *position, const uint64_t seed,
+                      struct game_t *game)
+{
+    game_new(game, seed);
+    game->used = position->mask << ACES;
+    game->turn = __builtin_popcount(position->mask) + 1;
+    if (position->mask & SOLVER_UPPER_BITS) {
+        game->score[__builtin_ctz(position->mask) + ACES] = position->upper;
+    }
+
+    return position->total - game_total(game);
+
+}//end start_game
+
+
+// ---------------------------------------------------------------------
+// Function
+//     play_for_points
+// Inputs
+//     ev
+//         The solved table.
+//     position
+//         Where the game starts.
+//     seed
+//         The seed for the dice.
+// Outputs
+//     function result
+// Description
+//     This function plays a game out for the most points, and returns
+//     the final total.
+// ---------------------------------------------------------------------
+static int play_for_points(const float ev[], const struct position_t *position,
+                           const uint64_t seed)
+{
+    struct solver_turn_t turn = { .state = -1 };
+    struct game_t        game;
+    int                  offset = start_game(position, seed, &game);
+
+    while (!game_over(&game)) {
+        game_step(&game, solver_choose(ev, &game, &turn), &game);
+    }
+
+    return game_total(&game) + offset;
+
+}//end play_for_points
+
+
+// ---------------------------------------------------------------------
+// Function
+//     play_to_win
+// Inputs
+//     w
+//         The solved chances.
+//     position
+//         Where the game starts.
+//     seed
+//         The seed for the dice.
+// Outputs
+//     function result
+// Description
+//     This function plays a game out for the best chance of winning,
+//     and returns the final total.
+// ---------------------------------------------------------------------
+static int play_to_win(const struct winprob_t *w,
+                       const struct position_t *position, const uint64_t seed)
+{
+    struct solver_turn_t turn = { .state = -1 };
+    struct game_t        game;
+    int                  offset = start_game(position, seed, &game);
+
+    while (!game_over(&game)) {
+        game_step(&game, winprob_choose(w, &game, game_total(&game) + offset,
+                                        &turn), &game);
+    }
+
+    return game_total(&game) + offset;
+
+}//end play_to_win
+
+
+// **************************************************************************
+// *********************************  MAIN **********************************
+// **************************************************************************
+int main(int argc, char *argv[])
+{
+    static double      opponent[WINPROB_TOTALS];
+    struct position_t  me = { 0, 0, 0 };
+    struct position_t  them = { 0, 0, 0 };
+    unsigned long      games = DEFAULT_GAMES;
+    unsigned long      matches = DEFAULT_MATCHES;
+    uint64_t           seed = DEFAULT_SEED;
+    long               threads = sysconf(_SC_NPROCESSORS_ONLN);
+    struct winprob_t  *w;
+    struct timespec    start;
+    float             *ev;
+    double             wins[2] = { 0, 0 };
+    double             points[2] = { 0, 0 };
+    double             mean = 0;
+    int                final;
+    int                theirs;
+    int                opt;
+
+    while ((opt = getopt(argc, argv, "p:o:g:m:s:t:")) != -1) {
+        if ((opt == 'p') && parse_position(optarg, &me)) {
+            continue;
+        } else if ((opt == 'o') && parse_position(optarg, &them)) {
+            continue;
+        } else if (opt == 'g') {
+            games = strtoul(optarg, NULL, BASE_10);
+        } else if (opt == 'm') {
+            matches = strtoul(optarg, NULL, BASE_10);
+        } else if (opt == 's') {
+            seed = strtoull(optarg, NULL, BASE_10);
+        } else if (opt == 't') {
+            threads = atoi(optarg);
+        } else {
+            fprintf(stderr, "Syntax: %s [-p used,upper,total] "
+                    "[-o used,upper,total] [-g opponent_games] [-m matches] "
+                    "[-s seed] [-t threads]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if ((threads < 1) || (games == 0)) {
+        fprintf(stderr, "Error: need at least one thread and one game\n");
+        return EXIT_FAILURE;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    ev = solver_solve(threads);
+    if (ev == NULL) {
+        perror("solver");
+        return EXIT_FAILURE;
+    }
+    printf("Solved for points in %.2f s (%.3f expected from a fresh game)\n",
+           timing_since(&start), ev[0]);
+
+    // The opponent, summed up
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned long i = 0; i < games; ++i) {
+        final = play_for_points(ev, &them, seed + i);
+        if ((final < 0) || (final > WINPROB_MAX_TOTAL)) {
+            fprintf(stderr, "Error: the opponent finished with %i\n", final);
+            return EXIT_FAILURE;
+        }
+        opponent[final] += 1.0 / games;
+        mean += (double)final / games;
+    }
+    printf("Opponent averages %.2f over %lu games (%.2f s)\n", mean, games,
+           timing_since(&start));
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    w = winprob_solve(opponent, me.mask, threads);
+    if (w == NULL) {
+        perror("winprob");
+        return EXIT_FAILURE;
+    }
+    printf("Solved to win in %.2f s: %zu chances stored (%zu KB)\n",
+           timing_since(&start), w->stored,
+           w->stored * sizeof(uint16_t) / 1024);
+    printf("Chance of winning from here, playing to win: %.4f\n",
+           winprob_value(w, solver_state(me.mask,
+                                         (me.upper > BONUS_THRESHOLD) ?
+                                         BONUS_THRESHOLD : me.upper),
+                         me.total));
+
+    // Check it against fresh opponents, both ways of playing
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned long i = 0; i < matches; ++i) {
+        theirs = play_for_points(ev, &them, seed + games + 2 * i);
+        for (int way = 0; way < 2; ++way) {
+            final = (way == 0) ? play_to_win(w, &me, seed + games + 2 * i + 1)
+                    : play_for_points(ev, &me, seed + games + 2 * i + 1);
+            wins[way]   += (final > theirs) ? 1.0 :
+                           (final == theirs) ? 0.5 : 0.0;
+            points[way] += final;
+        }
+    }
+    if (matches > 0) {
+        for (int way = 0; way < 2; ++way) {
+            printf("Playing %-9s won %.4f +/- %.4f of %lu matches, "
+                   "averaging %.2f\n", (way == 0) ? "to win:" : "for points:",
+                   wins[way] / matches,
+                   sqrt(wins[way] / matches * (1 - wins[way] / matches) /
+                        matches), matches, points[way] / matches);
+        }
+        printf("(%.2f s)\n", timing_since(&start));
+    }
+
+    winprob_free(w);
+    solver_free(ev);
+
+    return EXIT_SUCCESS;
+
+} // end main
+
+// end duel.c
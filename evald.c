@@ -0,0 +1,883 @@
+// ----------------------------------------------------------------------
+// File: evald.c
+//
+// Name: Al Shaffer & Marshall Liu
+//
+// Description: This is the position evaluation daemon. Tools ask it,
+//     over a Unix-domain socket, what every play from a position is
+//     worth, and it answers from the solved table (loaded with -r, or
+//     solved at startup).
+//
+//     Working out a turn is most of the cost of an answer, and every
+//     position with the same scorecard shares its turn, whatever the
+//     dice. So requests aren't answered one at a time: each pass of a
+//     worker's event loop reads every request that has come in, on any
+//     connection, into a batch, and then answers the batch grouped by
+//     scorecard, so each scorecard's rows are decoded and its turn is
+//     worked out once. Replies still go back in the order requests came
+//     in on each connection. Like the game server, a few threads each
+//     run their own epoll loop and share the listening socket.
+//
+//     The protocol is one line per request and one line per reply:
+//
+//         E <used> <upper> <yahtzee> <total> <dice> <roll>
+//             evaluate a position: the items used as a hex mask (bit 0
+//             is ACES), the upper section total, what YAHTZEE was
+//             scored (0 if it's open), the total so far with any
+//             bonuses, the five dice run together, and which roll
+//             (1 thru 3) they're from
+//         T   report the worker's counts
+//
+//     The reply to E is "OK <n> <play>=<value> ..." with the best n
+//     plays first, each with the final total it's expected to lead to:
+//     S<item> scores the dice in an item (only the items the Joker
+//     rule allows are listed), and K<dice> keeps those dice
+//     (K- keeps none) and rolls the rest. The reply to T is "STATS
+//     <requests> <batches> <turns worked out>". Anything else gets
+//     "ERR <reason>".
+//
+// Syntax: ./yahtzee_evald [-s socket_path] [-t threads] [-r table_file]
+//                         [-n plays]
+// ----------------------------------------------------------------------
+
+#define _GNU_SOURCE   // for accept4()
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include "score.h"
+#include "rules.h"
+#include "game.h"
+#include "solver.h"
+#include "evtable.h"
+#include "store.h"
+
+#define DEFAULT_SOCKET  "/tmp/yahtzee_eval.sock"
+#define DEFAULT_THREADS 2
+#define DEFAULT_PLAYS   5
+#define MAX_THREADS     64
+#define MAX_LISTED      10     // Plays in one reply
+#define MAX_PLAYS       (NUMBER_OF_CATEGORIES + (1 << NUMBER_OF_DICE))
+#define LISTEN_BACKLOG  4096
+#define MAX_EVENTS      256
+#define MAX_BATCH       1024
+#define IN_SIZE         256
+#define OUT_SIZE        2048
+#define MAX_REPLY       192
+#define BASE_10         10
+#define BASE_16         16
+
+// Requests
+#define EVALUATE 'E'
+#define STATS    'T'
+
+// The state of a request in the batch that isn't a position
+#define STATE_STATS -1
+#define STATE_ERROR -2
+
+
+// **************************************************************************
+// ****************************  DEFINED TYPES   ****************************
+// **************************************************************************
+
+// One connection. Room in the output buffer is set aside for each of
+// its requests waiting in the batch.
+struct session_t {
+    int           fd;
+    uint32_t      self;        // This session's handle
+    bool          closing;     // Close once flushed
+    bool          touched;     // On the worker's list to flush
+    uint16_t      pending;     // Requests waiting in the batch
+    uint16_t      in_len;
+    uint16_t      out_len;
+    uint16_t      out_off;
+    char          in[IN_SIZE];
+    char          out[OUT_SIZE];
+};
+
+// One request waiting in a batch
+struct request_t {
+    struct session_t *s;
+    int               state;       // The scorecard, or STATE_
+    int               total;
+    int               roll;        // 1 thru MAX_ROLLS
+    unsigned char     dice[NUMBER_OF_DICE];
+    char              reply[MAX_REPLY];
+};
+
+// One play and what it's worth
+struct play_t {
+    char  name[NUMBER_OF_DICE + 2];
+    float value;
+};
+
+// One event loop thread and its batch
+struct worker_t {
+    pthread_t            thread;
+    int                  epfd;
+    struct store_t       sessions;   // session_t records
+    int                  batched;
+    struct request_t     batch[MAX_BATCH];
+    uint32_t             order[MAX_BATCH];  // Scorecard, then arrival
+    int                  num_touched;
+    struct session_t    *touched[MAX_BATCH];
+    struct solver_turn_t turn;       // The last one worked out
+    unsigned long long   accepted;
+    unsigned long long   requests;
+    unsigned long long   batches;
+    unsigned long long   turns;
+};
+
+
+// **************************************************************************
+// **************************** GLOBAL VARIABLES ****************************
+// **************************************************************************
+
+static int               Listen_fd = -1;
+static volatile sig_atomic_t Stopping = 0;
+static struct worker_t  *Workers;
+static int               Num_workers = DEFAULT_THREADS;
+static int               Num_plays = DEFAULT_PLAYS;
+static struct evtable_t *Table;
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    Stopping = 1;
+}//end on_signal
+
+
+// ---------------------------------------------------------------------
+// Function
+//     session_room
+// Inputs
+//     s
+//         A session.
+// Outputs
+//     function result
+// Description
+//     Returns true if there's room to reply to one more request, on
+//     top of the ones already waiting in the batch.
+// ---------------------------------------------------------------------
+static bool session_room(const struct session_t *s)
+{
+    return OUT_SIZE - s->out_len >= (s->pending + 1) * (MAX_REPLY + 1);
+}//end session_room
+
+
+// ---------------------------------------------------------------------
+// Function
+//     session_reply
+// Inputs
+//     s
+//         The session to reply to.
+//     reply
+//         The reply, without the trailing '\n'.
+// Outputs
+//     none
+// Description
+//     This function queues one reply line in the session's output
+//     buffer, in the room set aside for it.
+// ---------------------------------------------------------------------
+static void session_reply(struct session_t *s, const char *reply)
+{
+    size_t len = strlen(reply);
+
+    memcpy(s->out + s->out_len, reply, len);
+    s->out_len += len;
+    s->out[s->out_len++] = '\n';
+
+}//end session_reply
+
+
+// ---------------------------------------------------------------------
+// Function
+//     session_close
+// Inputs
+//     w
+//         The worker that owns the session.
+//     s
+//         The session to end.
+// Outputs
+//     none
+// Description
+//     Disconnects the client and frees the session. A session with
+//     requests in the batch is only marked, and closed once they've
+//     been answered.
+// ---------------------------------------------------------------------
+static void session_close(struct worker_t *w, struct session_t *s)
+{
+    if (s->pending > 0) {
+        s->closing = true;
+        return;
+    }
+    epoll_ctl(w->epfd, EPOLL_CTL_DEL, s->fd, NULL);
+    close(s->fd);
+    store_free(&w->sessions, s->self);
+
+}//end session_close
+
+
+// ---------------------------------------------------------------------
+// Function
+//     session_flush
+// Inputs
+//     w
+//         The worker that owns the session.
+//     s
+//         The session with replies to send.
+// Outputs
+//     function result
+// Description
+//     This function writes as much of the queued replies as the socket
+//     will take, and asks epoll to say when it can take the rest. The
+//     result is false if the session was closed.
+// ---------------------------------------------------------------------
+static bool session_flush(struct worker_t *w, struct session_t *s)
+{
+    struct epoll_event ev;
+    ssize_t            sent;
+
+    while (s->out_off < s->out_len) {
+        sent = send(s->fd, s->out + s->out_off, s->out_len - s->out_off,
+                    MSG_NOSIGNAL);
+        if (sent > 0) {
+            s->out_off += sent;
+        } else if ((sent < 0) && (errno == EINTR)) {
+            continue;
+        } else if ((sent < 0) && ((errno == EAGAIN) ||
+                                  (errno == EWOULDBLOCK))) {
+            break;
+        } else {
+            session_close(w, s);
+            return false;
+        }
+    }
+
+    if (s->out_off == s->out_len) {
+        s->out_off = 0;
+        s->out_len = 0;
+        if (s->closing) {
+            session_close(w, s);
+            return false;
+        }
+        ev.events = EPOLLIN | EPOLLRDHUP;
+    } else {
+        // Stop reading until the client catches up on replies
+        ev.events = EPOLLOUT;
+    }
+    ev.data.ptr = s;
+    epoll_ctl(w->epfd, EPOLL_CTL_MOD, s->fd, &ev);
+
+    return true;
+
+}//end session_flush
+
+
+// ---------------------------------------------------------------------
+// Function
+//     parse_request
+// Inputs
+//     line
+//         The request, without the trailing '\n'.
+//     r
+//         Where to put it.
+// Outputs
+//     function result
+// Description
+//     This function reads a request, returning NULL if it's good, or
+//     else what's wrong with it.
+// ---------------------------------------------------------------------
+static const char *parse_request(const char *line, struct request_t *r)
+{
+    char         *end;
+    unsigned long mask;
+    long          upper;
+    long          yahtzee;
+
+    r->state = STATE_STATS;
+    if ((line[0] == STATS) && (line[1] == '\0')) {
+        return NULL;
+    } else if (line[0] != EVALUATE) {
+        return "unknown request";
+    }
+
+    mask     = strtoul(line + 1, &end, BASE_16);
+    upper    = strtol(end, &end, BASE_10);
+    yahtzee  = strtol(end, &end, BASE_10);
+    r->total = (int)strtol(end, &end, BASE_10);
+    while (*end == ' ') {
+        ++end;
+    }
+    for (int i = 0; i < NUMBER_OF_DICE; ++i, ++end) {
+        if ((*end < '1') || (*end > '0' + NUMBER_OF_SIDES)) {
+            return "bad dice";
+        }
+        r->dice[i] = *end - '0';
+    }
+    r->roll = (int)strtol(end, &end, BASE_10);
+
+    if ((*end != '\0') || (r->roll < 1) || (r->roll > MAX_ROLLS)) {
+        return "bad roll";
+    }
+    upper = (upper > BONUS_THRESHOLD) ? BONUS_THRESHOLD : upper;
+    if ((mask >= SOLVER_MASKS - 1) || (upper < 0) ||
+        !solver_reachable(mask, upper) ||
+        ((yahtzee != 0) && ((yahtzee != SCORE_YAHTZEE) ||
+                            !(mask & SOLVER_YAHTZEE_BIT)))) {
+        return "bad scorecard";
+    }
+    r->state = solver_state(solver_card(mask, yahtzee == SCORE_YAHTZEE),
+                            upper);
+
+    return NULL;
+
+}//end parse_request
+
+
+// ---------------------------------------------------------------------
+// Function
+//     by_order
+// Inputs
+//     a, b
+//         Entries of a worker's order array.
+// Outputs
+//     function result
+// Description
+//     This is the qsort() comparison for the order a batch is answered
+//     in.
+// ---------------------------------------------------------------------
+static int by_order(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}//end by_order
+
+
+// ---------------------------------------------------------------------
+// Function
+//     by_value
+// Inputs
+//     a, b
+//         Plays.
+// Outputs
+//     function result
+// Description
+//     This is the qsort() comparison that puts the best play first.
+// ---------------------------------------------------------------------
+static int by_value(const void *a, const void *b)
+{
+    float x = ((const struct play_t *)a)->value;
+    float y = ((const struct play_t *)b)->value;
+
+    return (x < y) - (x > y);
+}//end by_value
+
+
+// ---------------------------------------------------------------------
+// Function
+//     evaluate
+// Inputs
+//     turn
+//         The values for the request's turn, if it's before the last
+//         roll.
+//     next
+//         The rows of the scorecards after the request's, from
+//         evtable_rows().
+//     r
+//         A position, whose reply gets filled in.
+// Outputs
+//     none
+// Description
+//     This function ranks every play from the position: scoring the
+//     dice in each item the Joker rule allows and, before the last
+//     roll, keeping each set of the dice.
+// ---------------------------------------------------------------------
+static void evaluate(const struct solver_turn_t *turn, const float *next[],
+                     struct request_t *r)
+{
+    const struct solver_dice_t *d = solver_dice();
+    struct play_t               plays[MAX_PLAYS];
+    int                         roll = solver_roll_of(r->dice);
+    unsigned int                items = solver_items(r->state, roll);
+    int                         item;
+    int                         n = 0;
+    int                         len;
+    int                         k;
+
+    for (; items != 0; items &= items - 1) {
+        item = __builtin_ctz(items) + ACES;
+        snprintf(plays[n].name, sizeof(plays[n].name), "S%i", item);
+        plays[n++].value = solver_item_value(next, r->state, roll, item);
+    }
+
+    // Keeping all five is the same as scoring now, so it's left out
+    for (int i = d->sub_start[roll];
+         (r->roll < MAX_ROLLS) && (i < d->sub_start[roll + 1]); ++i) {
+        k = d->subs[i];
+        if (k == SOLVER_FIRST_ROLL + roll) {
+            continue;
+        }
+        len = 0;
+        plays[n].name[len++] = 'K';
+        for (int face = 1; face <= NUMBER_OF_SIDES; ++face) {
+            for (int c = 0; c < d->keep_counts[k][face]; ++c) {
+                plays[n].name[len++] = '0' + face;
+            }
+        }
+        if (len == 1) {
+            plays[n].name[len++] = '-';
+        }
+        plays[n].name[len] = '\0';
+        plays[n++].value = turn->keep[r->roll][k];
+    }
+    qsort(plays, n, sizeof(plays[0]), by_value);
+
+    n = (n < Num_plays) ? n : Num_plays;
+    len = snprintf(r->reply, MAX_REPLY, "OK %i", n);
+    for (int i = 0; i < n; ++i) {
+        len += snprintf(r->reply + len, MAX_REPLY - len, " %s=%.2f",
+                        plays[i].name, r->total + plays[i].value);
+    }
+
+}//end evaluate
+
+
+// ---------------------------------------------------------------------
+// Function
+//     session_input
+// Inputs
+//     w
+//         The worker that owns the session.
+//     s
+//         The session that is readable.
+// Outputs
+//     none
+// Description
+//     This function puts every complete request line the client has
+//     sent into the batch, reading more until the socket is drained.
+//     It stops early, leaving lines in the input buffer, if the batch
+//     is full or there's no room to reply; run_batch() comes back to
+//     them.
+// ---------------------------------------------------------------------
+static void session_input(struct worker_t *w, struct session_t *s)
+{
+    struct request_t *r;
+    const char       *error;
+    ssize_t           got;
+    char             *line;
+    char             *newline;
+    size_t            used;
+
+    while (true) {
+        line = s->in;
+        while ((!s->closing) && session_room(s) &&
+               (w->batched < MAX_BATCH) &&
+               ((newline = memchr(line, '\n', s->in + s->in_len - line))
+                != NULL)) {
+            *newline = '\0';
+            if ((newline > line) && (newline[-1] == '\r')) {
+                newline[-1] = '\0';
+            }
+            r = &w->batch[w->batched++];
+            r->s = s;
+            error = parse_request(line, r);
+            if (error != NULL) {
+                r->state = STATE_ERROR;
+                snprintf(r->reply, MAX_REPLY, "ERR %s", error);
+            }
+            ++s->pending;
+            ++w->requests;
+            if (!s->touched) {
+                s->touched = true;
+                w->touched[w->num_touched++] = s;
+            }
+            line = newline + 1;
+        }
+        used = line - s->in;
+        memmove(s->in, line, s->in_len - used);
+        s->in_len -= used;
+
+        if (s->closing || !session_room(s) || (w->batched == MAX_BATCH)) {
+            return;
+        } else if (s->in_len == IN_SIZE) {
+            // A request that doesn't fit the buffer isn't a request
+            session_close(w, s);
+            return;
+        }
+
+        got = recv(s->fd, s->in + s->in_len, IN_SIZE - s->in_len, 0);
+        if ((got < 0) && (errno == EINTR)) {
+            continue;
+        } else if ((got < 0) && ((errno == EAGAIN) ||
+                                 (errno == EWOULDBLOCK))) {
+            return;
+        } else if (got <= 0) {
+            session_close(w, s);
+            return;
+        }
+        s->in_len += got;
+    }
+
+}//end session_input
+
+
+// ---------------------------------------------------------------------
+// Function
+//     run_batch
+// Inputs
+//     w
+//         The worker.
+// Outputs
+//     none
+// Description
+//     This function answers every request in the batch, a scorecard at
+//     a time, then queues the replies in the order the requests came
+//     in and sends them. Sessions that still have requests buffered
+//     are read again, into the next batch.
+// ---------------------------------------------------------------------
+static void run_batch(struct worker_t *w)
+{
+    float              rows[NUMBER_OF_CATEGORIES + 1][SOLVER_UPPER];
+    const float       *next[NUMBER_OF_CATEGORIES + 1];
+    struct session_t  *touched[MAX_BATCH];
+    struct request_t  *r;
+    struct session_t  *s;
+    int                num_touched = w->num_touched;
+    int                state = STATE_STATS;
+
+    ++w->batches;
+
+    // Requests are numbered by their scorecard, then by arrival, so
+    // sorting the numbers groups the batch by scorecard
+    for (int i = 0; i < w->batched; ++i) {
+        w->order[i] = (uint32_t)(w->batch[i].state - STATE_ERROR) *
+                      MAX_BATCH + i;
+    }
+    qsort(w->order, w->batched, sizeof(w->order[0]), by_order);
+
+    for (int i = 0; i < w->batched; ++i) {
+        r = &w->batch[w->order[i] % MAX_BATCH];
+        if (r->state < 0) {
+            continue;
+        }
+        if (r->state != state) {
+            state = r->state;
+            evtable_rows(Table, state / SOLVER_UPPER, rows, next);
+        }
+        if ((r->roll < MAX_ROLLS) && (w->turn.state != state)) {
+            solver_turn_rows(next, state, &w->turn);
+            ++w->turns;
+        }
+        evaluate(&w->turn, next, r);
+    }
+
+    for (int i = 0; i < w->batched; ++i) {
+        r = &w->batch[i];
+        if (r->state == STATE_STATS) {
+            snprintf(r->reply, MAX_REPLY, "STATS %llu %llu %llu",
+                     w->requests, w->batches, w->turns);
+        }
+        session_reply(r->s, r->reply);
+        --r->s->pending;
+    }
+    w->batched = 0;
+
+    memcpy(touched, w->touched, num_touched * sizeof(touched[0]));
+    w->num_touched = 0;
+    for (int i = 0; i < num_touched; ++i) {
+        s = touched[i];
+        s->touched = false;
+        if (session_flush(w, s) &&
+            (memchr(s->in, '\n', s->in_len) != NULL)) {
+            session_input(w, s);
+        }
+    }
+
+}//end run_batch
+
+
+// ---------------------------------------------------------------------
+// Function
+//     accept_sessions
+// Inputs
+//     w
+//         The worker that saw the listening socket become readable.
+// Outputs
+//     none
+// Description
+//     This function accepts every waiting connection.
+// ---------------------------------------------------------------------
+static void accept_sessions(struct worker_t *w)
+{
+    struct epoll_event ev;
+    struct session_t  *s;
+    uint32_t           self;
+    int                fd;
+
+    while (true) {
+        fd = accept4(Listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK) &&
+                (errno != EINTR)) {
+                perror("accept");
+            }
+            break;
+        }
+
+        self = store_alloc(&w->sessions);
+        if (self == STORE_NONE) {
+            close(fd);
+            continue;
+        }
+
+        s = store_get(&w->sessions, self);
+        memset(s, 0, sizeof(*s));
+        s->fd   = fd;
+        s->self = self;
+
+        ev.events   = EPOLLIN | EPOLLRDHUP;
+        ev.data.ptr = s;
+        if (epoll_ctl(w->epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            close(fd);
+            store_free(&w->sessions, self);
+            continue;
+        }
+        ++w->accepted;
+    }
+
+}//end accept_sessions
+
+
+// ---------------------------------------------------------------------
+// Function
+//     worker_loop
+// Inputs
+//     arg
+//         The worker_t this thread runs.
+// Outputs
+//     function result
+// Description
+//     This is the event loop for one thread. Each pass gathers the
+//     requests from every ready session into a batch and answers it.
+//     It runs until the daemon is told to stop.
+// ---------------------------------------------------------------------
+static void *worker_loop(void *arg)
+{
+    struct worker_t   *w = arg;
+    struct epoll_event events[MAX_EVENTS];
+    struct session_t  *s;
+    int                count;
+
+    while (!Stopping) {
+        count = epoll_wait(w->epfd, events, MAX_EVENTS, 500);
+
+        // Answering a batch can close sessions still in events[], so a
+        // full batch leaves the rest of the events to the next
+        // epoll_wait(), which reports them again (they're level-triggered)
+        for (int i = 0; (i < count) && (w->batched < MAX_BATCH); ++i) {
+            s = events[i].data.ptr;
+            if (s == NULL) {
+                accept_sessions(w);
+            } else if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                session_close(w, s);
+            } else if (events[i].events & EPOLLOUT) {
+                if (session_flush(w, s) && (s->in_len > 0)) {
+                    // Pick up requests that were waiting on room to reply
+                    session_input(w, s);
+                }
+            } else {
+                session_input(w, s);
+            }
+        }
+        while (w->batched > 0) {
+            run_batch(w);
+        }
+    }
+
+    return NULL;
+
+}//end worker_loop
+
+
+// ---------------------------------------------------------------------
+// Function
+//     open_listener
+// Inputs
+//     path
+//         Where to put the Unix-domain socket.
+// Outputs
+//     function result
+// Description
+//     This function creates the non-blocking listening socket,
+//     replacing any old socket file at the same path.
+// ---------------------------------------------------------------------
+static int open_listener(const char *path)
+{
+    struct sockaddr_un addr;
+    int                fd;
+
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Error: socket path is too long\n");
+        return -1;
+    }
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    unlink(path);
+
+    if ((bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) ||
+        (listen(fd, LISTEN_BACKLOG) < 0)) {
+        perror(path);
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+
+}//end open_listener
+
+
+// **************************************************************************
+// *********************************  MAIN **********************************
+// **************************************************************************
+int main(int argc, char *argv[])
+{
+    const char        *path = DEFAULT_SOCKET;
+    const char        *table_file = NULL;
+    float             *ev;
+    struct epoll_event event;
+    struct sigaction   sa;
+    unsigned long long sessions = 0;
+    unsigned long long requests = 0;
+    unsigned long long batches = 0;
+    unsigned long long turns = 0;
+    int                opt;
+
+    while ((opt = getopt(argc, argv, "s:t:r:n:")) != -1) {
+        if (opt == 's') {
+            path = optarg;
+        } else if (opt == 't') {
+            Num_workers = atoi(optarg);
+        } else if (opt == 'r') {
+            table_file = optarg;
+        } else if (opt == 'n') {
+            Num_plays = atoi(optarg);
+        } else {
+            fprintf(stderr, "Syntax: %s [-s socket_path] [-t threads] "
+                    "[-r table_file] [-n plays]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if ((Num_workers < 1) || (Num_workers > MAX_THREADS)) {
+        fprintf(stderr, "Error: threads must be 1 thru %i\n", MAX_THREADS);
+        return EXIT_FAILURE;
+    } else if ((Num_plays < 1) || (Num_plays > MAX_LISTED)) {
+        fprintf(stderr, "Error: plays must be 1 thru %i\n", MAX_LISTED);
+        return EXIT_FAILURE;
+    }
+
+    if (table_file != NULL) {
+        Table = evtable_load(table_file);
+        if (Table == NULL) {
+            return EXIT_FAILURE;
+        }
+    } else {
+        printf("Solving with %i thread(s)...\n", Num_workers);
+        fflush(stdout);
+        ev = solver_solve(Num_workers);
+        Table = (ev != NULL) ? evtable_make(ev, EVTABLE_FLOAT) : NULL;
+        solver_free(ev);
+        if (Table == NULL) {
+            fprintf(stderr, "Error: out of memory\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    Workers = calloc(Num_workers, sizeof(*Workers));
+    if (Workers == NULL) {
+        fprintf(stderr, "Error: out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    Listen_fd = open_listener(path);
+    if (Listen_fd < 0) {
+        return EXIT_FAILURE;
+    }
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    // Every worker waits on the listening socket, but EPOLLEXCLUSIVE
+    // wakes only one of them for each new connection.
+    for (int i = 0; i < Num_workers; ++i) {
+        store_init(&Workers[i].sessions, sizeof(struct session_t));
+        Workers[i].turn.state = -1;
+        Workers[i].epfd = epoll_create1(EPOLL_CLOEXEC);
+        event.events   = EPOLLIN | EPOLLEXCLUSIVE;
+        event.data.ptr = NULL;
+        if ((Workers[i].epfd < 0) ||
+            (epoll_ctl(Workers[i].epfd, EPOLL_CTL_ADD, Listen_fd,
+                       &event) < 0)) {
+            perror("epoll");
+            return EXIT_FAILURE;
+        }
+        pthread_create(&Workers[i].thread, NULL, worker_loop, &Workers[i]);
+    }
+
+    printf("Evaluating YAHTZEE positions on %s with %i thread(s), "
+           "%s table\n", path, Num_workers, evtable_format_name(Table->format));
+    fflush(stdout);
+
+    for (int i = 0; i < Num_workers; ++i) {
+        pthread_join(Workers[i].thread, NULL);
+        sessions += Workers[i].accepted;
+        requests += Workers[i].requests;
+        batches  += Workers[i].batches;
+        turns    += Workers[i].turns;
+        store_destroy(&Workers[i].sessions);
+    }
+
+    close(Listen_fd);
+    unlink(path);
+    printf("%llu sessions, %llu requests in %llu batches "
+           "(%.1f per batch)\n", sessions, requests, batches,
+           (batches > 0) ? (double)requests / batches : 0.0);
+    printf("%llu turns worked out (%.3f per request)\n", turns,
+           (requests > 0) ? (double)turns / requests : 0.0);
+
+    free(Workers);
+    evtable_free(Table);
+
+    return EXIT_SUCCESS;
+
+} // end main
+
+// end evald.c
@@ -0,0 +1,443 @@
+// ----------------------------------------------------------------------
+// File: evalload.c
+//
+// Name: Al Shaffer & Marshall Liu
+//
+// Description: This is a load generator for the position evaluation
+//     daemon. It first plays some games with the bot to get a pool of
+//     positions real games pass through, then opens many connections
+//     at once and asks for positions from the pool, always with one
+//     request in flight per connection. When it's done it reports how
+//     many requests per second were answered and their latency (from
+//     sending each one to getting its reply), and asks the daemon how
+//     well it batched them.
+//
+// Syntax: ./yahtzee_evalload [-s socket_path] [-c connections]
+//                            [-n requests] [-g games]
+// ----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include "score.h"
+#include "rules.h"
+#include "game.h"
+#include "bot.h"
+
+#define DEFAULT_SOCKET      "/tmp/yahtzee_eval.sock"
+#define DEFAULT_CONNECTIONS 100
+#define DEFAULT_REQUESTS    1000   // Requests per connection
+#define DEFAULT_GAMES       200    // Games played for the pool
+#define MAX_EVENTS          256
+#define IN_SIZE             512
+#define MAX_REQUEST         48
+#define LATENCY_BUCKETS     100000 // One per microsecond up to 100 ms
+#define USEC_PER_SEC        1000000.0
+#define NSEC_PER_USEC       1000
+
+
+// **************************************************************************
+// ****************************  DEFINED TYPES   ****************************
+// **************************************************************************
+
+// One position, as a request line
+struct position_t {
+    char request[MAX_REQUEST];
+};
+
+// One simulated client
+struct client_t {
+    int          fd;
+    unsigned int requests_left;
+    uint64_t     rng;         // Which positions to ask for
+    uint64_t     sent_at;     // When the request in flight was sent (ns)
+    size_t       in_len;
+    char         in[IN_SIZE];
+};
+
+
+// **************************************************************************
+// **************************** GLOBAL VARIABLES ****************************
+// **************************************************************************
+
+static unsigned int Latency[LATENCY_BUCKETS + 1]; // last is "or more"
+static unsigned long long Requests;
+static unsigned long long Errors;
+static struct position_t *Pool;
+static unsigned int       Pool_size;
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}//end now_ns
+
+
+// ---------------------------------------------------------------------
+// Function
+//     make_pool
+// Inputs
+//     games
+//         How many games to play.
+// Outputs
+//     function result
+// Description
+//     This function plays games with the bot and keeps every position
+//     it had to decide on, one per roll, as a request for the daemon.
+//     The result is SUCCESS, or !SUCCESS if there's no memory for it.
+// ---------------------------------------------------------------------
+static int make_pool(const int games)
+{
+    struct game_t        game;
+    struct game_action_t action;
+    int                  last_roll;
+    int                  result;
+    char                *request;
+
+    Pool = malloc((size_t)games * MAX_TURNS * MAX_ROLLS * sizeof(*Pool));
+    if (Pool == NULL) {
+        return !SUCCESS;
+    }
+
+    for (int g = 0; g < games; ++g) {
+        game_new(&game, g + 1);
+        last_roll = 0;
+        while (!game_over(&game)) {
+            if (game.roll != last_roll) {
+                request = Pool[Pool_size++].request;
+                snprintf(request, MAX_REQUEST,
+                         "E %x %i %i %i %u%u%u%u%u %u\n",
+                         game.used >> ACES, game_upper(&game),
+                         game.score[YAHTZEE], game_total(&game), game.dice[0], game.dice[1],
+                         game.dice[2], game.dice[3], game.dice[4],
+                         game.roll);
+                last_roll = game.roll;
+            }
+            action = bot_choose(&game);
+            result = game_step(&game, action, &game);
+            if ((result > 0) && (result & GAME_EVENT_NEW_TURN)) {
+                last_roll = 0;
+            }
+        }
+    }
+
+    return SUCCESS;
+
+}//end make_pool
+
+
+// ---------------------------------------------------------------------
+// Function
+//     client_send
+// Inputs
+//     c
+//         The client sending the request.
+//     request
+//         The request line, including the trailing '\n'.
+// Outputs
+//     function result
+// Description
+//     This function sends one request and notes the time it was sent.
+//     Requests are tiny, so a short write is treated as a failure. The
+//     result is false if the request couldn't be sent.
+// ---------------------------------------------------------------------
+static bool client_send(struct client_t *c, const char *request)
+{
+    size_t  len = strlen(request);
+    ssize_t sent;
+
+    c->sent_at = now_ns();
+    do {
+        sent = send(c->fd, request, len, MSG_NOSIGNAL);
+    } while ((sent < 0) && (errno == EINTR));
+
+    return (sent == (ssize_t)len);
+
+}//end client_send
+
+
+// ---------------------------------------------------------------------
+// Function
+//     client_next
+// Inputs
+//     c
+//         The client whose request was just answered.
+// Outputs
+//     function result
+// Description
+//     This function asks for another position from the pool. The
+//     result is false once the client has no more requests to make.
+// ---------------------------------------------------------------------
+static bool client_next(struct client_t *c)
+{
+    if (c->requests_left == 0) {
+        return false;
+    }
+    --c->requests_left;
+
+    // One step of xorshift64 picks the position
+    c->rng ^= c->rng << 13;
+    c->rng ^= c->rng >> 7;
+    c->rng ^= c->rng << 17;
+
+    return client_send(c, Pool[c->rng % Pool_size].request);
+
+}//end client_next
+
+
+// ---------------------------------------------------------------------
+// Function
+//     client_connect
+// Inputs
+//     path
+//         Where the daemon's Unix-domain socket is.
+// Outputs
+//     function result
+// Description
+//     This function opens a connection to the daemon, returning the
+//     socket or -1 if the daemon can't be reached.
+// ---------------------------------------------------------------------
+static int client_connect(const char *path)
+{
+    struct sockaddr_un addr;
+    int                fd;
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+
+}//end client_connect
+
+
+// ---------------------------------------------------------------------
+// Function
+//     daemon_stats
+// Inputs
+//     path
+//         Where the daemon's Unix-domain socket is.
+// Outputs
+//     none
+// Description
+//     This function asks the daemon for its counts, on a connection of
+//     its own, and prints them. With more than one worker thread they
+//     are only the counts of whichever one answers.
+// ---------------------------------------------------------------------
+static void daemon_stats(const char *path)
+{
+    unsigned long long requests;
+    unsigned long long batches;
+    unsigned long long turns;
+    char               reply[IN_SIZE];
+    ssize_t            got;
+    size_t             len = 0;
+    int                fd = client_connect(path);
+
+    if ((fd < 0) || (send(fd, "T\n", 2, MSG_NOSIGNAL) != 2)) {
+        perror(path);
+    } else {
+        while ((len < sizeof(reply) - 1) &&
+               ((got = recv(fd, reply + len, sizeof(reply) - 1 - len,
+                            0)) > 0)) {
+            len += got;
+            if (memchr(reply, '\n', len) != NULL) {
+                break;
+            }
+        }
+        reply[len] = '\0';
+        if (sscanf(reply, "STATS %llu %llu %llu", &requests, &batches,
+                   &turns) == 3) {
+            printf("daemon worker: %llu requests in %llu batches "
+                   "(%.1f per batch), %.3f turns per request\n",
+                   requests, batches,
+                   (batches > 0) ? (double)requests / batches : 0.0,
+                   (requests > 0) ? (double)turns / requests : 0.0);
+        }
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+
+}//end daemon_stats
+
+
+// ---------------------------------------------------------------------
+// Function
+//     percentile
+// Inputs
+//     fraction
+//         Which percentile, as a fraction (0.99 for p99).
+// Outputs
+//     function result
+// Description
+//     This function returns the request latency in microseconds that
+//     the given fraction of requests came in under.
+// ---------------------------------------------------------------------
+static unsigned int percentile(const double fraction)
+{
+    unsigned long long target = (unsigned long long)(Requests * fraction);
+    unsigned long long seen = 0;
+
+    for (unsigned int i = 0; i <= LATENCY_BUCKETS; ++i) {
+        seen += Latency[i];
+        if (seen > target) {
+            return i;
+        }
+    }
+
+    return LATENCY_BUCKETS;
+
+}//end percentile
+
+
+// **************************************************************************
+// *********************************  MAIN **********************************
+// **************************************************************************
+int main(int argc, char *argv[])
+{
+    const char        *path = DEFAULT_SOCKET;
+    int                connections = DEFAULT_CONNECTIONS;
+    int                requests = DEFAULT_REQUESTS;
+    int                games = DEFAULT_GAMES;
+    int                active = 0;
+    int                epfd;
+    int                count;
+    int                opt;
+    struct client_t   *clients;
+    struct client_t   *c;
+    struct epoll_event ev;
+    struct epoll_event events[MAX_EVENTS];
+    uint64_t           start;
+    uint64_t           usec;
+    double             seconds;
+    ssize_t            got;
+    char              *newline;
+
+    while ((opt = getopt(argc, argv, "s:c:n:g:")) != -1) {
+        if (opt == 's') {
+            path = optarg;
+        } else if (opt == 'c') {
+            connections = atoi(optarg);
+        } else if (opt == 'n') {
+            requests = atoi(optarg);
+        } else if (opt == 'g') {
+            games = atoi(optarg);
+        } else {
+            fprintf(stderr, "Syntax: %s [-s socket_path] [-c connections] "
+                    "[-n requests] [-g games]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if ((connections < 1) || (requests < 1) || (games < 1)) {
+        fprintf(stderr, "Error: connections, requests and games must be "
+                "positive\n");
+        return EXIT_FAILURE;
+    }
+
+    clients = calloc(connections, sizeof(*clients));
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if ((clients == NULL) || (epfd < 0) || (make_pool(games) != SUCCESS)) {
+        perror("setup");
+        return EXIT_FAILURE;
+    }
+    printf("%u positions from %i games\n", Pool_size, games);
+
+    // Connect everyone and send their first request
+    start = now_ns();
+    for (int i = 0; i < connections; ++i) {
+        c = &clients[i];
+        c->fd = client_connect(path);
+        if (c->fd < 0) {
+            perror(path);
+            return EXIT_FAILURE;
+        }
+        c->requests_left = requests;
+        c->rng = rules_seed(i + 1);
+        ev.events   = EPOLLIN;
+        ev.data.ptr = c;
+        epoll_ctl(epfd, EPOLL_CTL_ADD, c->fd, &ev);
+        if (client_next(c)) {
+            ++active;
+        }
+    }
+
+    // Answer each reply with the next request until all are done
+    while (active > 0) {
+        count = epoll_wait(epfd, events, MAX_EVENTS, -1);
+        for (int i = 0; i < count; ++i) {
+            c = events[i].data.ptr;
+            got = recv(c->fd, c->in + c->in_len, IN_SIZE - c->in_len, 0);
+            if (got <= 0) {
+                if ((got < 0) && (errno == EINTR)) {
+                    continue;
+                }
+                close(c->fd);
+                --active;
+                ++Errors;
+                continue;
+            }
+            c->in_len += got;
+
+            newline = memchr(c->in, '\n', c->in_len);
+            if (newline == NULL) {
+                continue;
+            }
+
+            usec = (now_ns() - c->sent_at) / NSEC_PER_USEC;
+            ++Latency[(usec < LATENCY_BUCKETS) ? usec : LATENCY_BUCKETS];
+            ++Requests;
+            if (strncmp(c->in, "OK", 2) != 0) {
+                ++Errors;
+            }
+            c->in_len = 0;
+
+            if (!client_next(c)) {
+                close(c->fd);
+                --active;
+            }
+        }
+    }
+    seconds = (now_ns() - start) / (USEC_PER_SEC * NSEC_PER_USEC);
+
+    printf("%llu requests, %llu errors in %.3f s\n",
+           Requests, Errors, seconds);
+    printf("%.0f requests/sec\n", Requests / seconds);
+    printf("latency p50 %u us, p99 %u us, p99.9 %u us\n",
+           percentile(0.50), percentile(0.99), percentile(0.999));
+    daemon_stats(path);
+
+    free(clients);
+    free(Pool);
+    close(epfd);
+
+    return (Errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+} // end main
+
+// end evalload.c
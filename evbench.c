@@ -0,0 +1,330 @@
+// ----------------------------------------------------------------------
+// File: evbench.c
+//
+// Name: Al Shaffer & Marshall Liu
+//
+// Description: This is a benchmark for the EVTABLE module. It solves
+//     the game (or loads a saved table), makes the table in every
+//     format, and for each one measures:
+//
+//         - how far its values are from the solved ones,
+//         - how long a lookup of one value takes, at random scorecards,
+//           each lookup waiting on the one before,
+//         - how long working out a turn takes (what a hint or the bot
+//           does once a turn), at the scorecards real games reach,
+//         - how many points are lost playing from it, by playing the
+//           same games (the same seeds) with each format and comparing
+//           against the solved table.
+//
+//     It can also save a table, for the game's hints (YAHTZEE_TABLE).
+//
+// Syntax: ./yahtzee_evbench [-t threads] [-r table_file]
+//                           [-w table_file [-f format]] [-l lookups]
+//                           [-g games] [-s seed]
+// ----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "score.h"
+#include "rules.h"
+#include "game.h"
+#include "solver.h"
+#include "evtable.h"
+#include "timing.h"
+
+#define DEFAULT_LOOKUPS 4000000
+#define DEFAULT_GAMES   20000
+#define DEFAULT_SEED    1
+#define BASE_10         10
+#define NS_PER_SEC      1e9
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     next_random
+// Inputs
+//     x
+//         The generator (xorshift64), never 0.
+// Outputs
+//     function result
+// Description
+//     Returns the next 64 random bits.
+// ---------------------------------------------------------------------
+static uint64_t next_random(uint64_t *x)
+{
+    *x ^= *x << 13;
+    *x ^= *x >> 7;
+    *x ^= *x << 17;
+    return *x;
+}//end next_random
+
+
+// ---------------------------------------------------------------------
+// Function
+//     play
+// Inputs
+//     t
+//         The table to play from.
+//     seed
+//         The seed for the dice.
+//     states
+//         Where to put the scorecard at the start of every turn, or
+//         NULL.
+// Outputs
+//     function result
+// Description
+//     This function plays a game for the most points, and returns the
+//     final total.
+// ---------------------------------------------------------------------
+static int play(const struct evtable_t *t, const uint64_t seed, int states[])
+{
+    struct solver_turn_t turn = { .state = -1 };
+    struct game_t        game;
+
+    game_new(&game, seed);
+    while (!game_over(&game)) {
+        if ((states != NULL) && (game.roll == 1) && (game.keep == 0)) {
+            states[game.turn - 1] = solver_state_of(&game);
+        }
+        game_step(&game, evtable_choose(t, &game, &turn), &game);
+    }
+
+    return game_total(&game);
+
+}//end play
+
+
+// ---------------------------------------------------------------------
+// Function
+//     lookup_ns
+// Inputs
+//     t
+//         The table.
+//     lookups
+//         How many to time.
+//     seed
+//         Where the random scorecards start.
+// Outputs
+//     function result
+// Description
+//     Returns the time one lookup takes, in ns. Each scorecard depends
+//     on the value before it, so lookups can't overlap.
+// ---------------------------------------------------------------------
+static double lookup_ns(const struct evtable_t *t, const unsigned long lookups,
+                        const uint64_t seed)
+{
+    struct timespec start;
+    uint64_t        x = seed | 1;
+    float           value = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned long i = 0; i < lookups; ++i) {
+        value = evtable_value(t, (next_random(&x) ^ (value > 1000)) %
+                                 SOLVER_STATES);
+    }
+
+    return timing_since(&start) * NS_PER_SEC / lookups;
+
+}//end lookup_ns
+
+
+// ---------------------------------------------------------------------
+// Function
+//     turn_us
+// Inputs
+//     t
+//         The table.
+//     states
+//         The scorecards to work out turns for.
+//     count
+//         How many there are.
+// Outputs
+//     function result
+// Description
+//     Returns the time working out one turn takes, in microseconds.
+// ---------------------------------------------------------------------
+static double turn_us(const struct evtable_t *t, const int states[],
+                      const size_t count)
+{
+    static struct solver_turn_t turn;
+    struct timespec             start;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < count; ++i) {
+        evtable_turn(t, states[i], &turn);
+    }
+
+    return timing_since(&start) * 1e6 / count;
+
+}//end turn_us
+
+
+// **************************************************************************
+// *********************************  MAIN **********************************
+// **************************************************************************
+int main(int argc, char *argv[])
+{
+    const char        *read_path = NULL;
+    const char        *write_path = NULL;
+    int                write_format = EVTABLE_FIXED16;
+    unsigned long      lookups = DEFAULT_LOOKUPS;
+    unsigned long      games = DEFAULT_GAMES;
+    uint64_t           seed = DEFAULT_SEED;
+    long               threads = sysconf(_SC_NPROCESSORS_ONLN);
+    struct evtable_t  *table[EVTABLE_FORMATS];
+    struct evtable_t  *loaded = NULL;
+    struct timespec    start;
+    float             *ev;
+    int               *states;
+    int               *totals;
+    double             error;
+    double             worst;
+    double             diff;
+    double             sum;
+    double             sum_squares;
+    unsigned long      changed;
+    int                opt;
+
+    while ((opt = getopt(argc, argv, "t:r:w:f:l:g:s:")) != -1) {
+        if (opt == 't') {
+            threads = atoi(optarg);
+        } else if (opt == 'r') {
+            read_path = optarg;
+        } else if (opt == 'w') {
+            write_path = optarg;
+        } else if (opt == 'f') {
+            for (write_format = 0; write_format < EVTABLE_FORMATS;
+                 ++write_format) {
+                if (strcmp(optarg, evtable_format_name(write_format)) == 0) {
+                    break;
+                }
+            }
+        } else if (opt == 'l') {
+            lookups = strtoul(optarg, NULL, BASE_10);
+        } else if (opt == 'g') {
+            games = strtoul(optarg, NULL, BASE_10);
+        } else if (opt == 's') {
+            seed = strtoull(optarg, NULL, BASE_10);
+        } else {
+            write_format = EVTABLE_FORMATS;
+            break;
+        }
+    }
+    if ((write_format == EVTABLE_FORMATS) || (threads < 1) ||
+        (lookups == 0) || (games == 0)) {
+        fprintf(stderr, "Syntax: %s [-t threads] [-r table_file] "
+                "[-w table_file [-f float|fixed16|half]] [-l lookups] "
+                "[-g games] [-s seed]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // The values to measure against, as solved
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    ev = solver_alloc(SOLVER_STATES * sizeof(float));
+    if ((read_path != NULL) && (ev != NULL)) {
+        loaded = evtable_load(read_path);
+        if (loaded == NULL) {
+            perror(read_path);
+            return EXIT_FAILURE;
+        }
+        for (int s = 0; s < SOLVER_STATES; ++s) {
+            ev[s] = evtable_value(loaded, s);
+        }
+        printf("Loaded a %s table from %s\n",
+               evtable_format_name(loaded->format), read_path);
+        evtable_free(loaded);
+    } else {
+        solver_free(ev);
+        ev = solver_solve(threads);
+    }
+    if (ev == NULL) {
+        perror("solver");
+        return EXIT_FAILURE;
+    }
+    printf("Table ready in %.2f s (%.3f expected from a fresh game)\n",
+           timing_since(&start), ev[0]);
+
+    for (int f = 0; f < EVTABLE_FORMATS; ++f) {
+        table[f] = evtable_make(ev, f);
+        if (table[f] == NULL) {
+            perror("evtable");
+            return EXIT_FAILURE;
+        }
+    }
+    if (write_path != NULL) {
+        if (evtable_save(table[write_format], write_path) != SUCCESS) {
+            perror(write_path);
+            return EXIT_FAILURE;
+        }
+        printf("Saved the %s table in %s\n",
+               evtable_format_name(write_format), write_path);
+    }
+
+    // Play the games from the solved table first, keeping where every
+    // turn starts for timing turns
+    states = malloc(games * MAX_TURNS * sizeof(int));
+    totals = malloc(games * sizeof(int));
+    if ((states == NULL) || (totals == NULL)) {
+        perror("games");
+        return EXIT_FAILURE;
+    }
+    for (unsigned long g = 0; g < games; ++g) {
+        totals[g] = play(table[EVTABLE_FLOAT], seed + g,
+                         states + g * MAX_TURNS);
+    }
+
+    printf("\n%-8s %8s %10s %10s %10s %10s %18s %8s\n", "format", "KB",
+           "max error", "avg error", "lookup ns", "turn us",
+           "points lost", "changed");
+    for (int f = 0; f < EVTABLE_FORMATS; ++f) {
+        worst = 0;
+        error = 0;
+        for (int s = 0; s < SOLVER_STATES; ++s) {
+            diff  = fabs(evtable_value(table[f], s) - ev[s]);
+            worst = (diff > worst) ? diff : worst;
+            error += diff / SOLVER_STATES;
+        }
+
+        // The same games, paired with the solved table's
+        sum         = 0;
+        sum_squares = 0;
+        changed     = 0;
+        for (unsigned long g = 0; g < games; ++g) {
+            diff = totals[g] - play(table[f], seed + g, NULL);
+            sum         += diff;
+            sum_squares += diff * diff;
+            changed     += (diff != 0);
+        }
+
+        printf("%-8s %8zu %10.5f %10.5f %10.2f %10.2f %8.4f +/- %5.4f "
+               "%8lu\n", evtable_format_name(f), evtable_bytes(table[f]) / 1024,
+               worst, error, lookup_ns(table[f], lookups, seed),
+               turn_us(table[f], states, games * MAX_TURNS), sum / games,
+               sqrt((sum_squares / games - (sum / games) * (sum / games)) /
+                    games), changed);
+    }
+    printf("(points lost per game against the float table over %lu "
+           "games)\n", games);
+
+    for (int f = 0; f < EVTABLE_FORMATS; ++f) {
+        evtable_free(table[f]);
+    }
+    free(states);
+    free(totals);
+    solver_free(ev);
+
+    return EXIT_SUCCESS;
+
+} // end main
+
+// end evbench.c
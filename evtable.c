@@ -0,0 +1,541 @@
+// ----------------------------------------------------------------------
+// File: evtable.c
+//
+// Name: Al Shaffer & Marshall Liu
+//
+// Description: This EVTABLE module holds the table the SOLVER module
+//     solves, for play and hints, in less memory. As solved it's 3 MB
+//     of floats, which doesn't stay in cache between one lookup and the
+//     next. Stored in 16 bits it's half that, either as counts of a
+//     fixed step (the largest value over 65535, so off by at most half
+//     a step, well under a hundredth of a point), or as half precision
+//     floats (off by at most 1/8 of a point, as with the YAHTZEE
+//     bonuses values pass 256, where the spacing is 0.25).
+//
+//     Every turn looks up only the rows of the scorecards one item
+//     fuller than its own, all SOLVER_UPPER upper totals of each, so
+//     the table is kept in rows that start on a cache line, and a turn
+//     decodes the rows it needs once up front.
+//
+//     Saved tables are a small header and the values as they are in
+//     memory, in the machine's byte order.
+// ----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <errno.h>
+#include "score.h"
+#include "rules.h"
+#include "game.h"
+#include "solver.h"
+#include "evtable.h"
+
+#define MAGIC         "YZEV"
+#define MAGIC_SIZE    4
+#define FIXED_MAX     65535
+#define HALF_BIAS     15
+#define FLOAT_BIAS    127
+#define HALF_EXP_MAX  31
+#define HALF_MANTISSA 10
+#define FLOAT_MANTISSA 23
+
+
+// **************************************************************************
+// ****************************  DEFINED TYPES   ****************************
+// **************************************************************************
+
+// The start of a saved table
+struct evtable_header_t {
+    char     magic[MAGIC_SIZE];
+    uint32_t format;
+    float    step;
+    uint32_t states;
+};
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     half_of
+// Inputs
+//     value
+//         A value from the table, which is never negative.
+// Outputs
+//     function result
+// Description
+//     Returns the value in half precision, rounded to nearest. Values
+//     too small for a normal half (under 2^-14) become 0, which is
+//     fine for a table of points.
+// ---------------------------------------------------------------------
+static uint16_t half_of(const float value)
+{
+    uint32_t bits;
+    int      exponent;
+    uint32_t mantissa;
+
+    memcpy(&bits, &value, sizeof(bits));
+    exponent = (int)((bits >> FLOAT_MANTISSA) & 0xFF) - FLOAT_BIAS + HALF_BIAS;
+    mantissa = bits & ((1u << FLOAT_MANTISSA) - 1);
+    if (exponent <= 0) {
+        return 0;
+    } else if (exponent >= HALF_EXP_MAX) {
+        return (HALF_EXP_MAX << HALF_MANTISSA) - 1;  // The largest half
+    }
+
+    // A carry out of the mantissa rounds up into the exponent
+    return ((exponent << HALF_MANTISSA) |
+            (mantissa >> (FLOAT_MANTISSA - HALF_MANTISSA))) +
+           ((mantissa >> (FLOAT_MANTISSA - HALF_MANTISSA - 1)) & 1);
+
+}//end half_of
+
+
+// ---------------------------------------------------------------------
+// Function
+//     float_of_half
+// Inputs
+//     half
+//         A value from half_of().
+// Outputs
+//     function result
+// Description
+//     Returns the value as a float.
+// ---------------------------------------------------------------------
+static inline float float_of_half(const uint16_t half)
+{
+    uint32_t bits = 0;
+    float    value;
+
+    if (half != 0) {
+        bits = ((uint32_t)((half >> HALF_MANTISSA) - HALF_BIAS + FLOAT_BIAS)
+                << FLOAT_MANTISSA) |
+               ((uint32_t)(half & ((1u << HALF_MANTISSA) - 1))
+                << (FLOAT_MANTISSA - HALF_MANTISSA));
+    }
+    memcpy(&value, &bits, sizeof(value));
+
+    return value;
+
+}//end float_of_half
+
+
+// ---------------------------------------------------------------------
+// Function
+//     value_size
+// Inputs
+//     format
+//         An EVTABLE_ format.
+// Outputs
+//     function result
+// Description
+//     Returns how many bytes each value takes.
+// ---------------------------------------------------------------------
+static size_t value_size(const int format)
+{
+    return (format == EVTABLE_FLOAT) ? sizeof(float) : sizeof(uint16_t);
+}//end value_size
+
+
+// ---------------------------------------------------------------------
+// Function
+//     new_table
+// Inputs
+//     format
+//         An EVTABLE_ format.
+//     step
+//         Points per count, for EVTABLE_FIXED16.
+// Outputs
+//     function result
+// Description
+//     This function makes a table with room for every value, returning
+//     NULL if there's no memory for it.
+// ---------------------------------------------------------------------
+static struct evtable_t *new_table(const int format, const float step)
+{
+    struct evtable_t *t = malloc(sizeof(*t));
+
+    if (t == NULL) {
+        return NULL;
+    }
+    t->format = format;
+    t->step   = step;
+    t->values = aligned_alloc(EVTABLE_ALIGN, SOLVER_STATES * value_size(format));
+    if (t->values == NULL) {
+        free(t);
+        return NULL;
+    }
+
+    return t;
+
+}//end new_table
+
+
+// ************************************************************************
+// *************************  EXTERNAL FUNCTIONS **************************
+// ************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     evtable_make
+// Inputs
+//     ev
+//         A table from solver_solve().
+//     format
+//         An EVTABLE_ format to keep it in.
+// Outputs
+//     function result
+// Description
+//     This function makes a copy of the table in the format (to be
+//     freed with evtable_free()), returning NULL if there's no memory
+//     for it or the format isn't one.
+// ---------------------------------------------------------------------
+struct evtable_t *evtable_make(const float ev[], const int format)
+{
+    struct evtable_t *t;
+    float             most = 0;
+    uint16_t         *values;
+
+    if ((format < 0) || (format >= EVTABLE_FORMATS)) {
+        errno = EINVAL;
+        return NULL;
+    }
+    for (int s = 0; s < SOLVER_STATES; ++s) {
+        most = (ev[s] > most) ? ev[s] : most;
+    }
+
+    t = new_table(format, (most > 0) ? most / FIXED_MAX : 1);
+    if (t == NULL) {
+        return NULL;
+    }
+    values = t->values;
+    for (int s = 0; s < SOLVER_STATES; ++s) {
+        if (format == EVTABLE_FLOAT) {
+            ((float *)t->values)[s] = ev[s];
+        } else if (format == EVTABLE_FIXED16) {
+            values[s] = (uint16_t)(ev[s] / t->step + 0.5f);
+        } else {
+            values[s] = half_of(ev[s]);
+        }
+    }
+
+    return t;
+
+}//end evtable_make
+
+
+// ---------------------------------------------------------------------
+// Function
+//     evtable_free
+// Inputs
+//     t
+//         A table, or NULL.
+// Outputs
+//     none
+// Description
+//     This function frees the table.
+// ---------------------------------------------------------------------
+void evtable_free(struct evtable_t *t)
+{
+    if (t != NULL) {
+        free(t->values);
+        free(t);
+    }
+
+}//end evtable_free
+
+
+// ---------------------------------------------------------------------
+// Function
+//     evtable_save
+// Inputs
+//     t
+//         The table.
+//     path
+//         The file to save it in.
+// Outputs
+//     function result
+// Description
+//     This function saves the table, returning SUCCESS or not.
+// ---------------------------------------------------------------------
+int evtable_save(const struct evtable_t *t, const char *path)
+{
+    struct evtable_header_t header = { MAGIC, t->format, t->step,
+                                       SOLVER_STATES };
+    FILE                   *out = fopen(path, "wb");
+    int                     result = SUCCESS;
+
+    if (out == NULL) {
+        return !SUCCESS;
+    }
+    if ((fwrite(&header, sizeof(header), 1, out) != 1) ||
+        (fwrite(t->values, evtable_bytes(t), 1, out) != 1)) {
+        result = !SUCCESS;
+    }
+    if (fclose(out) != 0) {
+        result = !SUCCESS;
+    }
+
+    return result;
+
+}//end evtable_save
+
+
+// ---------------------------------------------------------------------
+// Function
+//     evtable_load
+// Inputs
+//     path
+//         A file from evtable_save().
+// Outputs
+//     function result
+// Description
+//     This function loads a saved table (to be freed with
+//     evtable_free()), returning NULL (with errno set) if it can't.
+// ---------------------------------------------------------------------
+struct evtable_t *evtable_load(const char *path)
+{
+    struct evtable_header_t header;
+    struct evtable_t       *t = NULL;
+    FILE                   *in = fopen(path, "rb");
+
+    if (in == NULL) {
+        return NULL;
+    }
+    if ((fread(&header, sizeof(header), 1, in) != 1) ||
+        (memcmp(header.magic, MAGIC, MAGIC_SIZE) != 0) ||
+        (header.format >= EVTABLE_FORMATS) ||
+        (header.states != SOLVER_STATES) || !(header.step > 0)) {
+        errno = EINVAL;
+    } else if ((t = new_table(header.format, header.step)) != NULL) {
+        if (fread(t->values, evtable_bytes(t), 1, in) != 1) {
+            evtable_free(t);
+            t = NULL;
+            errno = EINVAL;
+        }
+    }
+    fclose(in);
+
+    return t;
+
+}//end evtable_load
+
+
+// ---------------------------------------------------------------------
+// Function
+//     evtable_bytes
+// Inputs
+//     t
+//         The table.
+// Outputs
+//     function result
+// Description
+//     Returns how many bytes the table's values take.
+// ---------------------------------------------------------------------
+size_t evtable_bytes(const struct evtable_t *t)
+{
+    return SOLVER_STATES * value_size(t->format);
+}//end evtable_bytes
+
+
+// ---------------------------------------------------------------------
+// Function
+//     evtable_format_name
+// Inputs
+//     format
+//         An EVTABLE_ format.
+// Outputs
+//     function result
+// Description
+//     Returns a name for the format.
+// ---------------------------------------------------------------------
+const char *evtable_format_name(const int format)
+{
+    static const char *names[EVTABLE_FORMATS] = { "float", "fixed16", "half" };
+
+    return ((format >= 0) && (format < EVTABLE_FORMATS)) ? names[format] : "?";
+
+}//end evtable_format_name
+
+
+// ---------------------------------------------------------------------
+// Function
+//     evtable_value
+// Inputs
+//     t
+//         The table.
+//     state
+//         A scorecard, from solver_state().
+// Outputs
+//     function result
+// Description
+//     Returns the scorecard's value: the points still to come from the
+//     start of a turn, with the best play.
+// ---------------------------------------------------------------------
+float evtable_value(const struct evtable_t *t, const int state)
+{
+    const uint16_t *values = t->values;
+
+    if (t->format == EVTABLE_FLOAT) {
+        return ((const float *)t->values)[state];
+    } else if (t->format == EVTABLE_FIXED16) {
+        return values[state] * t->step;
+    }
+
+    return float_of_half(values[state]);
+
+}//end evtable_value
+
+
+// ---------------------------------------------------------------------
+// Function
+//     evtable_row
+// Inputs
+//     t
+//         The table.
+//     card
+//         The card, from solver_card().
+//     row
+//         Where to put SOLVER_UPPER values.
+// Outputs
+//     none
+// Description
+//     This function decodes the values of the scorecards with this
+//     card, by upper total, as laid out in a float table.
+// ---------------------------------------------------------------------
+void evtable_row(const struct evtable_t *t, const unsigned int card,
+                 float row[])
+{
+    const uint16_t *values = (const uint16_t *)t->values + card * SOLVER_UPPER;
+
+    if (t->format == EVTABLE_FLOAT) {
+        memcpy(row, (const float *)t->values + card * SOLVER_UPPER,
+               SOLVER_UPPER * sizeof(float));
+    } else if (t->format == EVTABLE_FIXED16) {
+        for (int u = 0; u < SOLVER_UPPER; ++u) {
+            row[u] = values[u] * t->step;
+        }
+    } else {
+        for (int u = 0; u < SOLVER_UPPER; ++u) {
+            row[u] = float_of_half(values[u]);
+        }
+    }
+
+}//end evtable_row
+
+
+// ---------------------------------------------------------------------
+// Function
+//     evtable_rows
+// Inputs
+//     t
+//         The table.
+//     card
+//         The card at the start of a turn.
+//     rows
+//         Room to decode a row for each item, and SOLVER_ZERO_ROW.
+//     next
+//         Where to put the rows, as for solver_rows().
+// Outputs
+//     none
+// Description
+//     This function gets the rows a turn needs, decoding them unless
+//     the table is floats already.
+// ---------------------------------------------------------------------
+void evtable_rows(const struct evtable_t *t, const unsigned int card,
+                  float rows[][SOLVER_UPPER], const float *next[])
+{
+    unsigned int mask = solver_card_mask(card);
+
+    if (t->format == EVTABLE_FLOAT) {
+        solver_rows(t->values, card, next);
+        return;
+    }
+
+    for (int item = ACES; item <= CHANCE; ++item) {
+        if (!(mask & (1u << (item - ACES)))) {
+            evtable_row(t, solver_card_after(card, item, SCORE_YAHTZEE),
+                        rows[item]);
+            next[item] = rows[item];
+        }
+    }
+    if (!(mask & SOLVER_YAHTZEE_BIT)) {
+        evtable_row(t, solver_card_after(card, YAHTZEE, 0),
+                    rows[SOLVER_ZERO_ROW]);
+        next[SOLVER_ZERO_ROW] = rows[SOLVER_ZERO_ROW];
+    }
+
+}//end evtable_rows
+
+
+// ---------------------------------------------------------------------
+// Function
+//     evtable_turn
+// Inputs
+//     t
+//         The table.
+//     state
+//         The scorecard at the start of the turn.
+//     turn
+//         Where to put the values for the turn.
+// Outputs
+//     none
+// Description
+//     This function is solver_turn() from the table.
+// ---------------------------------------------------------------------
+void evtable_turn(const struct evtable_t *t, const int state,
+                  struct solver_turn_t *turn)
+{
+    float        rows[NUMBER_OF_CATEGORIES + 1][SOLVER_UPPER];
+    const float *next[NUMBER_OF_CATEGORIES + 1];
+
+    evtable_rows(t, state / SOLVER_UPPER, rows, next);
+    solver_turn_rows(next, state, turn);
+
+}//end evtable_turn
+
+
+// ---------------------------------------------------------------------
+// Function
+//     evtable_choose
+// Inputs
+//     t
+//         The table.
+//     game
+//         A game that isn't over.
+//     turn
+//         The values for the game's turn, as for solver_choose().
+// Outputs
+//     function result
+// Description
+//     This function is solver_choose() from the table. The rows are
+//     only decoded when a turn has to be worked out or scored.
+// ---------------------------------------------------------------------
+struct game_action_t evtable_choose(const struct evtable_t *t,
+                                    const struct game_t *game,
+                                    struct solver_turn_t *turn)
+{
+    struct game_action_t action = { GAME_SCORE, 0 };
+    int                  state = solver_state_of(game);
+    float                rows[NUMBER_OF_CATEGORIES + 1][SOLVER_UPPER];
+    const float         *next[NUMBER_OF_CATEGORIES + 1];
+
+    if (turn->state != state) {
+        evtable_turn(t, state, turn);
+    }
+    if (solver_keep_action(game, solver_best_keep(turn, game), &action)) {
+        return action;
+    }
+    evtable_rows(t, state / SOLVER_UPPER, rows, next);
+    action.arg = solver_best_item(next, state, solver_roll_of(game->dice));
+
+    return action;
+
+}//end evtable_choose
+
+// end evtable.c
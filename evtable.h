@@ -0,0 +1,51 @@
+// -------------------------------------------------------------------
+// File: evtable.h
+//
+// Name: Marshall Liu
+//
+// Description: This is the header file for the EVTABLE module, which
+//     keeps a solved table of expected values small enough to stay in
+//     cache, and saves it to a file.
+// -------------------------------------------------------------------
+
+#ifndef EVTABLE_H
+#define EVTABLE_H
+
+#include <stdint.h>
+#include "game.h"
+#include "solver.h"
+
+#define EVTABLE_FLOAT   0   // As solved, 32 bits
+#define EVTABLE_FIXED16 1   // 16-bit counts of a step
+#define EVTABLE_HALF    2   // IEEE 754 half precision
+#define EVTABLE_FORMATS 3
+
+#define EVTABLE_ALIGN   128 // A card's row of 16-bit values
+
+// A solved table, a row of SOLVER_UPPER values per card (see solver_card()).
+// Rows start on a cache line, so a turn touches one or two lines for
+// each item it could score in (four for EVTABLE_FLOAT).
+struct evtable_t {
+    int    format;     // EVTABLE_
+    float  step;       // Points per count, for EVTABLE_FIXED16
+    void  *values;     // SOLVER_STATES of them
+};
+
+extern struct evtable_t *evtable_make(const float ev[], const int format);
+extern void   evtable_free(struct evtable_t *t);
+extern int    evtable_save(const struct evtable_t *t, const char *path);
+extern struct evtable_t *evtable_load(const char *path);
+extern size_t evtable_bytes(const struct evtable_t *t);
+extern const char *evtable_format_name(const int format);
+extern float  evtable_value(const struct evtable_t *t, const int state);
+extern void   evtable_row(const struct evtable_t *t, const unsigned int card,
+                          float row[]);
+extern void   evtable_rows(const struct evtable_t *t, const unsigned int card,
+                           float rows[][SOLVER_UPPER], const float *next[]);
+extern void   evtable_turn(const struct evtable_t *t, const int state,
+                           struct solver_turn_t *turn);
+extern struct game_action_t evtable_choose(const struct evtable_t *t,
+                                           const struct game_t *game,
+                                           struct solver_turn_t *turn);
+
+#endif // EVTABLE_H
@@ -0,0 +1,494 @@
+// ----------------------------------------------------------------------
+// File: export.c
+//
+// Name: Al Shaffer & Marshall Liu
+//
+// Description: This EXPORT module appends finished games to a binary
+//     file laid out by column, for analytics jobs that load millions of
+//     games at a time. Games are gathered EXPORT_BLOCK_RECORDS at a time
+//     and written as one block, with every column's values together:
+//     one column per scorecard item, then the bonus, the upper and
+//     lower totals, the YAHTZEE bonuses, the grand total, and the seed.
+//
+//     A column is either a plain array of 1 to 8 byte values, which a
+//     reader can use right where it is, or (when packing is asked for)
+//     bit-packed at just the width the block needs. The seed column is
+//     packed as differences from one game to the next, since batches of
+//     games are usually played from consecutive seeds. Blocks are self
+//     contained, so a file can be appended to by later runs.
+// ----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "score.h"
+#include "rules.h"
+#include "game.h"
+#include "export.h"
+
+#define ALIGNMENT  8
+#define MAX_PACKED 56   // Wider values than this are stored plain
+
+_Static_assert(sizeof(struct export_block_t) % ALIGNMENT == 0,
+               "block data must stay aligned");
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     bits_for
+// Inputs
+//     value
+//         The largest value to be stored.
+// Outputs
+//     function result
+// Description
+//     Returns the number of bits needed to store the value.
+// ---------------------------------------------------------------------
+static int bits_for(const uint64_t value)
+{
+    return (value == 0) ? 0 : 64 - __builtin_clzll(value);
+}//end bits_for
+
+
+// ---------------------------------------------------------------------
+// Function
+//     zigzag
+// Inputs
+//     delta
+//         A difference that may be negative.
+// Outputs
+//     function result
+// Description
+//     Maps 0, -1, 1, -2, 2 ... to 0, 1, 2, 3, 4 ... so that small
+//     differences either way need few bits.
+// ---------------------------------------------------------------------
+static uint64_t zigzag(const int64_t delta)
+{
+    return ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63);
+}//end zigzag
+
+
+// ---------------------------------------------------------------------
+// Function
+//     delta_at
+// Inputs
+//     values
+//         A column of values.
+//     i
+//         Which value.
+// Outputs
+//     function result
+// Description
+//     Returns the zigzagged difference between the value and the one
+//     before it. The first value has no difference.
+// ---------------------------------------------------------------------
+static uint64_t delta_at(const uint64_t values[], const uint32_t i)
+{
+    return (i == 0) ? 0 : zigzag((int64_t)(values[i] - values[i - 1]));
+}//end delta_at
+
+
+// ---------------------------------------------------------------------
+// Function
+//     encode_column
+// Inputs
+//     out
+//         The file being written.
+//     column
+//         Which column to encode.
+//     desc
+//         Where to describe how the column was stored.
+//     data
+//         Where to put the column's data.
+// Outputs
+//     function result
+// Description
+//     This function stores one column of the gathered records, plain
+//     or bit-packed, and returns how many bytes it took (a multiple of
+//     ALIGNMENT).
+// ---------------------------------------------------------------------
+static size_t encode_column(struct export_t *out, const int column,
+                            struct export_column_t *desc,
+                            unsigned char *data)
+{
+    uint64_t *values = out->values[column];
+    uint64_t *words = (uint64_t *)data;
+    uint64_t  min = UINT64_MAX;
+    uint64_t  max = 0;
+    uint64_t  value;
+    size_t    bytes;
+    size_t    pos;
+    int       width;
+
+    memset(desc, 0, sizeof(*desc));
+    for (uint32_t i = 0; i < out->count; ++i) {
+        min = (values[i] < min) ? values[i] : min;
+        max = (values[i] > max) ? values[i] : max;
+    }
+
+    if (!out->packed) {
+        // A plain array just wide enough for the largest value
+        width = bits_for(max);
+        width = (width <= 8) ? 8 : (width <= 16) ? 16 :
+                (width <= 32) ? 32 : 64;
+        desc->encoding = EXPORT_PLAIN;
+        desc->width    = width;
+        for (uint32_t i = 0; i < out->count; ++i) {
+            memcpy(data + (size_t)i * (width / 8), &values[i], width / 8);
+        }
+        bytes = (size_t)out->count * (width / 8);
+        return (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    if (column == EXPORT_SEED) {
+        // Differences from the previous seed, zigzagged
+        desc->encoding = EXPORT_DELTA;
+        desc->first    = values[0];
+        min = UINT64_MAX;
+        max = 0;
+        for (uint32_t i = 0; i < out->count; ++i) {
+            value = delta_at(values, i);
+            min = (value < min) ? value : min;
+            max = (value > max) ? value : max;
+        }
+    } else {
+        desc->encoding = EXPORT_BITS;
+    }
+
+    width = bits_for(max - min);
+    if (width > MAX_PACKED) {
+        // Not worth packing; store it plain after all
+        out->packed = false;
+        bytes = encode_column(out, column, desc, data);
+        out->packed = true;
+        return bytes;
+    }
+    desc->base  = min;
+    desc->width = width;
+
+    // Pack the values into little-endian 64-bit words. One extra word
+    // is always left at the end so readers can safely look past it.
+    bytes = ((size_t)out->count * width + 63) / 64 * 8 + 8;
+    memset(data, 0, bytes);
+    for (uint32_t i = 0; (width > 0) && (i < out->count); ++i) {
+        if (desc->encoding == EXPORT_DELTA) {
+            value = delta_at(values, i);
+        } else {
+            value = values[i];
+        }
+        value -= min;
+        pos    = (size_t)i * width;
+        words[pos / 64] |= value << (pos % 64);
+        if ((pos % 64) + width > 64) {
+            words[pos / 64 + 1] |= value >> (64 - pos % 64);
+        }
+    }
+
+    return bytes;
+
+}//end encode_column
+
+
+// ---------------------------------------------------------------------
+// Function
+//     write_block
+// Inputs
+//     out
+//         The file being written.
+// Outputs
+//     function result
+// Description
+//     This function encodes the gathered records as one block and
+//     writes it, returning SUCCESS or not.
+// ---------------------------------------------------------------------
+static int write_block(struct export_t *out)
+{
+    struct export_block_t *block = (struct export_block_t *)out->buffer;
+    size_t                 bytes = sizeof(*block);
+    size_t                 start;
+
+    if (out->count == 0) {
+        return SUCCESS;
+    }
+
+    memset(block, 0, sizeof(*block));
+    block->magic = EXPORT_MAGIC;
+    block->count = out->count;
+    for (int c = 0; c < EXPORT_COLUMNS; ++c) {
+        start  = bytes;
+        bytes += encode_column(out, c, &block->columns[c],
+                               out->buffer + bytes);
+        block->columns[c].offset = start;
+    }
+    block->bytes = bytes;
+    out->count = 0;
+
+    if (fwrite(out->buffer, bytes, 1, out->file) != 1) {
+        return !SUCCESS;
+    }
+
+    return SUCCESS;
+
+}//end write_block
+
+
+// ************************************************************************
+// *************************  EXTERNAL FUNCTIONS **************************
+// ************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     export_open
+// Inputs
+//     path
+//         The file to append games to. It's created if need be.
+//     packed
+//         Whether to bit-pack the columns.
+// Outputs
+//     function result
+// Description
+//     This function gets a file ready for games to be appended to it,
+//     returning NULL (with errno set) if it can't be.
+// ---------------------------------------------------------------------
+struct export_t *export_open(const char *path, const bool packed)
+{
+    struct export_t *out = calloc(1, sizeof(*out));
+    size_t           bytes;
+
+    if (out == NULL) {
+        return NULL;
+    }
+    out->packed = packed;
+
+    // The biggest a block can be: every column plain 8-byte values
+    // plus the extra word after packed data
+    bytes = sizeof(struct export_block_t) +
+            EXPORT_COLUMNS * ((size_t)EXPORT_BLOCK_RECORDS + 1) * 8;
+    out->buffer = malloc(bytes);
+    for (int c = 0; c < EXPORT_COLUMNS; ++c) {
+        out->values[c] = malloc(EXPORT_BLOCK_RECORDS * sizeof(uint64_t));
+        if (out->values[c] == NULL) {
+            export_close(out);
+            return NULL;
+        }
+    }
+    out->file = fopen(path, "ab");
+    if ((out->buffer == NULL) || (out->file == NULL)) {
+        export_close(out);
+        return NULL;
+    }
+
+    return out;
+
+}//end export_open
+
+
+// ---------------------------------------------------------------------
+// Function
+//     export_append
+// Inputs
+//     out
+//         The file being written.
+//     game
+//         A finished game.
+// Outputs
+//     function result
+// Description
+//     This function adds the game's scorecard and seed to the file,
+//     writing out a block whenever one fills up. It returns SUCCESS or
+//     not.
+// ---------------------------------------------------------------------
+int export_append(struct export_t *out, const struct game_t *game)
+{
+    uint32_t i = out->count;
+    int      upper = game_upper(game);
+    int      total = game_total(game);
+
+    for (int item = ACES; item <= CHANCE; ++item) {
+        out->values[item - ACES][i] = game->score[item];
+    }
+    out->values[EXPORT_BONUS][i] = (upper >= BONUS_THRESHOLD) ?
+                                   SCORE_BONUS : 0;
+    out->values[EXPORT_UPPER][i] = upper;
+    out->values[EXPORT_YAHTZEE_BONUS][i] = game->bonus * SCORE_YAHTZEE_BONUS;
+    out->values[EXPORT_LOWER][i] = total - upper -
+                                   out->values[EXPORT_BONUS][i] -
+                                   out->values[EXPORT_YAHTZEE_BONUS][i];
+    out->values[EXPORT_TOTAL][i] = total;
+    out->values[EXPORT_SEED][i]  = game->seed;
+
+    if (++out->count == EXPORT_BLOCK_RECORDS) {
+        return write_block(out);
+    }
+
+    return SUCCESS;
+
+}//end export_append
+
+
+// ---------------------------------------------------------------------
+// Function
+//     export_close
+// Inputs
+//     out
+//         The file being written.
+// Outputs
+//     function result
+// Description
+//     This function writes out whatever games are still gathered, and
+//     closes the file. It returns SUCCESS or not.
+// ---------------------------------------------------------------------
+int export_close(struct export_t *out)
+{
+    int result = SUCCESS;
+
+    if (out->file != NULL) {
+        result = write_block(out);
+        if ((fclose(out->file) != 0) && (result == SUCCESS)) {
+            result = !SUCCESS;
+        }
+    }
+    for (int c = 0; c < EXPORT_COLUMNS; ++c) {
+        free(out->values[c]);
+    }
+    free(out->buffer);
+    free(out);
+
+    return result;
+
+}//end export_close
+
+
+// ---------------------------------------------------------------------
+// Function
+//     export_block_valid
+// Inputs
+//     block
+//         What should be the start of a block.
+//     available
+//         How many bytes there are from the start of the block to the
+//         end of the file.
+// Outputs
+//     function result
+// Description
+//     Returns true if this looks like a whole block that fits in the
+//     file, with every column inside it.
+// ---------------------------------------------------------------------
+bool export_block_valid(const struct export_block_t *block,
+                        const size_t available)
+{
+    const struct export_column_t *desc;
+    size_t                        bytes;
+    bool                          plain;
+
+    if ((available < sizeof(*block)) || (block->magic != EXPORT_MAGIC) ||
+        (block->bytes > available) || (block->bytes < sizeof(*block)) ||
+        (block->count > EXPORT_BLOCK_RECORDS)) {
+        return false;
+    }
+    for (int c = 0; c < EXPORT_COLUMNS; ++c) {
+        desc  = &block->columns[c];
+        bytes = ((size_t)block->count * desc->width + 7) / 8;
+        if (desc->encoding == EXPORT_PLAIN) {
+            plain = (desc->width == 8) || (desc->width == 16) ||
+                    (desc->width == 32) || (desc->width == 64);
+        } else {
+            plain = false;
+            bytes += ALIGNMENT;   // The extra word readers look past
+        }
+        if ((desc->offset % ALIGNMENT != 0) ||
+            (desc->offset + bytes > block->bytes) ||
+            ((desc->encoding == EXPORT_PLAIN) && !plain) ||
+            (desc->encoding > EXPORT_DELTA) || (desc->width > 64)) {
+            return false;
+        }
+    }
+
+    return true;
+
+}//end export_block_valid
+
+
+// ---------------------------------------------------------------------
+// Function
+//     export_decode
+// Inputs
+//     block
+//         A valid block.
+//     column
+//         Which column to decode.
+//     values
+//         Where to put the column's values, one per record.
+// Outputs
+//     none
+// Description
+//     This function turns one column of a block back into plain 64-bit
+//     values, whatever way it was stored.
+// ---------------------------------------------------------------------
+void export_decode(const struct export_block_t *block, const int column,
+                   uint64_t values[])
+{
+    const struct export_column_t *desc = &block->columns[column];
+    const unsigned char          *data =
+        (const unsigned char *)block + desc->offset;
+    const uint64_t               *words = (const uint64_t *)data;
+    const uint32_t                count = block->count;
+    const int                     width = desc->width;
+    const uint64_t                mask = (width == 64) ?
+                                         UINT64_MAX : (1ULL << width) - 1;
+    uint64_t                      value;
+    uint64_t                      previous;
+    int64_t                       delta;
+    size_t                        pos;
+
+    if (desc->encoding == EXPORT_PLAIN) {
+        switch (width) {
+        case 8:
+            for (uint32_t i = 0; i < count; ++i) {
+                values[i] = data[i];
+            }
+            break;
+        case 16:
+            for (uint32_t i = 0; i < count; ++i) {
+                values[i] = ((const uint16_t *)data)[i];
+            }
+            break;
+        case 32:
+            for (uint32_t i = 0; i < count; ++i) {
+                values[i] = ((const uint32_t *)data)[i];
+            }
+            break;
+        default:
+            memcpy(values, data, count * sizeof(uint64_t));
+            break;
+        }
+        return;
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+        pos   = (size_t)i * width;
+        value = words[pos / 64] >> (pos % 64);
+        if ((pos % 64) + width > 64) {
+            value |= words[pos / 64 + 1] << (64 - pos % 64);
+        }
+        values[i] = (width == 0) ? desc->base : (value & mask) + desc->base;
+    }
+
+    if (desc->encoding == EXPORT_DELTA) {
+        previous = desc->first;
+        for (uint32_t i = 0; i < count; ++i) {
+            delta = (int64_t)(values[i] >> 1) ^ -(int64_t)(values[i] & 1);
+            previous += delta;
+            values[i] = previous;
+        }
+    }
+
+}//end export_decode
+
+// end export.c
@@ -0,0 +1,78 @@
+// -------------------------------------------------------------------
+// File: export.h
+//
+// Name: Marshall Liu
+//
+// Description: This is the header file for the EXPORT module, which
+//     writes finished games to a columnar binary file and reads them
+//     back.
+// -------------------------------------------------------------------
+
+#ifndef EXPORT_H
+#define EXPORT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "rules.h"
+#include "game.h"
+
+#define EXPORT_MAGIC         0x32425A59u  // "YZB2", little-endian
+#define EXPORT_MAGIC_V1      0x31425A59u  // "YZB1", without the YAHTZEE
+                                          // bonus column
+#define EXPORT_BLOCK_RECORDS 65536
+
+// The columns, in the order they're stored. Columns 0 thru 12 are the
+// scorecard items ACES thru CHANCE.
+#define EXPORT_BONUS   NUMBER_OF_CATEGORIES
+#define EXPORT_UPPER   (NUMBER_OF_CATEGORIES + 1)  // Without the bonus
+#define EXPORT_LOWER   (NUMBER_OF_CATEGORIES + 2)  // The lower items only
+#define EXPORT_YAHTZEE_BONUS (NUMBER_OF_CATEGORIES + 3)
+#define EXPORT_TOTAL   (NUMBER_OF_CATEGORIES + 4)
+#define EXPORT_SEED    (NUMBER_OF_CATEGORIES + 5)
+#define EXPORT_COLUMNS (NUMBER_OF_CATEGORIES + 6)
+
+// Column encodings
+#define EXPORT_PLAIN   0  // An array of 1, 2, 4 or 8 byte values
+#define EXPORT_BITS    1  // (value - base) in width bits each
+#define EXPORT_DELTA   2  // (value - previous value) as EXPORT_BITS
+
+// How one column of a block is stored
+struct export_column_t {
+    uint64_t base;     // Subtracted from each value (EXPORT_BITS/DELTA)
+    uint64_t first;    // The first value of the block (EXPORT_DELTA)
+    uint32_t offset;   // Where the data starts, from the block header
+    uint8_t  encoding;
+    uint8_t  width;    // Bits per value
+    uint8_t  unused[2];
+};
+
+// Each block starts with this, followed by the column data. All of
+// a block's data is 8-byte aligned.
+struct export_block_t {
+    uint32_t               magic;
+    uint32_t               count;  // Records in the block
+    uint32_t               bytes;  // Size of the block, this included
+    uint32_t               unused;
+    struct export_column_t columns[EXPORT_COLUMNS];
+};
+
+// A file being written. Records are gathered a block at a time.
+struct export_t {
+    FILE     *file;
+    bool      packed;                               // Bit-pack columns
+    uint32_t  count;                                // Records gathered
+    uint64_t *values[EXPORT_COLUMNS];               // One per column
+    unsigned char *buffer;                          // An encoded block
+};
+
+extern struct export_t *export_open(const char *path, const bool packed);
+extern int  export_append(struct export_t *out, const struct game_t *game);
+extern int  export_close(struct export_t *out);
+extern bool export_block_valid(const struct export_block_t *block,
+                               const size_t available);
+extern void export_decode(const struct export_block_t *block,
+                          const int column, uint64_t values[]);
+
+#endif // EXPORT_H
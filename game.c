@@ -0,0 +1,363 @@
+// ----------------------------------------------------------------------
+// File: game.c
+//
+// Name: Al Shaffer & Marshall Liu
+//
+// Description: This GAME module is the turn structure of YAHTZEE as a
+//     step function. game_step() takes a game and one player action
+//     (keep, roll, score or quit) and produces the next game, along
+//     with what happened. It never reads input, draws anything or
+//     keeps any state of its own, so the terminal game, the game
+//     server, bots and replays all play by exactly the same rules.
+//     Since the dice generator is part of the game, replaying the same
+//     actions from the same seed gives the same game.
+//
+//     The Joker rule and YAHTZEE bonuses are played: every YAHTZEE
+//     after one scored 50 earns SCORE_YAHTZEE_BONUS, and a YAHTZEE
+//     after the YAHTZEE item is used goes where rules_allowed() says.
+// ----------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "score.h"
+#include "rules.h"
+#include "game.h"
+
+// Where each field is in game_packed_t.play
+#define DIE_BITS    3
+#define KEEP_SHIFT  (NUMBER_OF_DICE * DIE_BITS)
+#define ROLL_SHIFT  (KEEP_SHIFT + NUMBER_OF_DICE)
+#define TURN_SHIFT  (ROLL_SHIFT + 2)
+#define QUIT_SHIFT  (TURN_SHIFT + 4)
+#define BONUS_SHIFT (QUIT_SHIFT + 1)
+#define DIE_MASK    ((1u << DIE_BITS) - 1)
+#define KEEP_MASK   ((1u << NUMBER_OF_DICE) - 1)
+#define ROLL_MASK   0x3u
+#define TURN_MASK   0xFu
+#define BONUS_MASK  0xFu
+
+_Static_assert(sizeof(struct game_packed_t) <= 32,
+               "a packed game must fit in 32 bytes");
+_Static_assert(BONUS_SHIFT + 4 <= 32, "the play word is out of bits");
+_Static_assert(MAX_TURNS + 1 <= TURN_MASK, "turn doesn't fit");
+_Static_assert(MAX_ROLLS <= ROLL_MASK, "roll doesn't fit");
+_Static_assert(MAX_TURNS - 1 <= BONUS_MASK, "bonuses don't fit");
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     start_turn
+// Inputs
+//     game
+//         The game to start the next turn of.
+// Outputs
+//     none
+// Description
+//     This function "rolls" all the dice and marks them as rollable,
+//     which is the first roll of every turn.
+// ---------------------------------------------------------------------
+static void start_turn(struct game_t *game)
+{
+    game->keep = 0;
+    game->roll = 1;
+    rules_roll(game->dice, 0, &game->rng);
+
+}//end start_turn
+
+
+// ************************************************************************
+// *************************  EXTERNAL FUNCTIONS **************************
+// ************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     game_new
+// Inputs
+//     game
+//         The game to set up.
+//     seed
+//         The seed for the dice.
+// Outputs
+//     none
+// Description
+//     This function clears the scorecard and rolls the dice for the
+//     first turn.
+// ---------------------------------------------------------------------
+void game_new(struct game_t *game, const uint64_t seed)
+{
+    memset(game, 0, sizeof(*game));
+    game->seed = seed;
+    game->rng  = rules_seed(seed);
+    game->turn = 1;
+    start_turn(game);
+
+}//end game_new
+
+
+// ---------------------------------------------------------------------
+// Function
+//     game_step
+// Inputs
+//     game
+//         The game as it is now. It is not changed.
+//     action
+//         What the player wants to do.
+//     next
+//         Where to put the game after the action. It may be the same
+//         as game.
+// Outputs
+//     function result
+// Description
+//     This function applies one action. On success the result is the
+//     GAME_EVENT_ bits for what happened. If the action isn't allowed,
+//     the result is one of the (negative) GAME_ERROR_ codes and next is
+//     a copy of game.
+//
+//     Scoring an item the dice don't match puts a zero there, since
+//     it's assumed the player wants that for a strategic reason. A
+//     roll is refused once MAX_ROLLS have been taken; the player must
+//     then score. A Joker is refused anywhere the Joker rule doesn't
+//     allow, and earns a bonus (GAME_EVENT_BONUS) if the YAHTZEE item
+//     was scored 50.
+// ---------------------------------------------------------------------
+int game_step(const struct game_t *game, const struct game_action_t action,
+              struct game_t *next)
+{
+    int events = 0;
+
+    if (next != game) {
+        *next = *game;
+    }
+    if (game_over(game)) {
+        return GAME_ERROR_OVER;
+    }
+
+    switch (action.type) {
+    case GAME_KEEP:
+        if ((action.arg < 1) || (action.arg > NUMBER_OF_DICE)) {
+            return GAME_ERROR_BAD_DIE;
+        }
+        next->keep ^= 1u << (action.arg - 1);
+        events = GAME_EVENT_KEEP;
+        break;
+
+    case GAME_ROLL:
+        if (game->roll >= MAX_ROLLS) {
+            return GAME_ERROR_NO_ROLLS;
+        }
+        rules_roll(next->dice, next->keep, &next->rng);
+        ++next->roll;
+        events = GAME_EVENT_ROLLED;
+        break;
+
+    case GAME_SCORE:
+        if ((action.arg < ACES) || (action.arg > CHANCE)) {
+            return GAME_ERROR_BAD_ITEM;
+        } else if (game->used & (1u << action.arg)) {
+            return GAME_ERROR_USED;
+        } else if (!rules_allowed(game->dice, game->used, action.arg)) {
+            return GAME_ERROR_JOKER;
+        }
+        events = GAME_EVENT_SCORED;
+        if (rules_joker(game->dice, game->used) &&
+            (game->score[YAHTZEE] == SCORE_YAHTZEE)) {
+            ++next->bonus;
+            events |= GAME_EVENT_BONUS;
+        }
+        next->score[action.arg] = rules_card_score(game->dice, game->used,
+                                                   action.arg);
+        next->used |= 1u << action.arg;
+        ++next->turn;
+        if (next->turn > MAX_TURNS) {
+            events |= GAME_EVENT_OVER;
+        } else {
+            start_turn(next);
+            events |= GAME_EVENT_NEW_TURN;
+        }
+        break;
+
+    case GAME_QUIT:
+        next->quit = true;
+        events = GAME_EVENT_QUIT;
+        break;
+
+    default:
+        return GAME_ERROR_ACTION;
+    }
+
+    return events;
+
+}//end game_step
+
+
+// ---------------------------------------------------------------------
+// Function
+//     game_over
+// Inputs
+//     game
+//         The game to check.
+// Outputs
+//     function result
+// Description
+//     Returns true once every turn has been scored or the player quit.
+// ---------------------------------------------------------------------
+bool game_over(const struct game_t *game)
+{
+    return (game->turn > MAX_TURNS) || game->quit;
+}//end game_over
+
+
+// ---------------------------------------------------------------------
+// Function
+//     game_upper
+// Inputs
+//     game
+//         The game whose scorecard is to be added up.
+// Outputs
+//     function result
+// Description
+//     Returns the total of the upper section, not counting the bonus.
+// ---------------------------------------------------------------------
+int game_upper(const struct game_t *game)
+{
+    int upper = 0;
+
+    for (int i = ACES; i <= SIXES; ++i) {
+        upper += game->score[i];
+    }
+
+    return upper;
+
+}//end game_upper
+
+
+// ---------------------------------------------------------------------
+// Function
+//     game_total
+// Inputs
+//     game
+//         The game whose scorecard is to be added up.
+// Outputs
+//     function result
+// Description
+//     Returns the grand total of the scorecard, including the upper
+//     section bonus and any YAHTZEE bonuses.
+// ---------------------------------------------------------------------
+int game_total(const struct game_t *game)
+{
+    int upper = game_upper(game);
+    int lower = game->bonus * SCORE_YAHTZEE_BONUS;
+
+    for (int i = KIND3; i <= CHANCE; ++i) {
+        lower += game->score[i];
+    }
+    if (upper >= BONUS_THRESHOLD) {
+        upper += SCORE_BONUS;
+    }
+
+    return upper + lower;
+
+}//end game_total
+
+
+// ---------------------------------------------------------------------
+// Function
+//     game_error_text
+// Inputs
+//     error
+//         One of the GAME_ERROR_ codes.
+// Outputs
+//     function result
+// Description
+//     Returns a short description of why an action wasn't allowed.
+// ---------------------------------------------------------------------
+const char *game_error_text(const int error)
+{
+    switch (error) {
+    case GAME_ERROR_OVER:     return "game over";
+    case GAME_ERROR_BAD_DIE:  return "bad die";
+    case GAME_ERROR_NO_ROLLS: return "no rolls left";
+    case GAME_ERROR_BAD_ITEM: return "bad item";
+    case GAME_ERROR_USED:     return "item used";
+    case GAME_ERROR_JOKER:    return "joker rule";
+    default:                  return "bad request";
+    }
+
+}//end game_error_text
+
+
+// ---------------------------------------------------------------------
+// Function
+//     game_pack
+// Inputs
+//     game
+//         The game to pack.
+//     packed
+//         Where to put the packed game.
+// Outputs
+//     none
+// Description
+//     This function squeezes a game into a game_packed_t. Nothing is
+//     lost that's needed to keep playing; game_unpack() gives back the
+//     same game, except that the seed it started from is forgotten.
+// ---------------------------------------------------------------------
+void game_pack(const struct game_t *game, struct game_packed_t *packed)
+{
+    uint32_t play = 0;
+
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        play |= (uint32_t)game->dice[i] << (i * DIE_BITS);
+    }
+    play |= (uint32_t)game->keep << KEEP_SHIFT;
+    play |= (uint32_t)game->roll << ROLL_SHIFT;
+    play |= (uint32_t)game->turn << TURN_SHIFT;
+    play |= (uint32_t)game->quit << QUIT_SHIFT;
+    play |= (uint32_t)game->bonus << BONUS_SHIFT;
+
+    packed->rng   = game->rng;
+    packed->play  = play;
+    packed->used  = (uint16_t)(game->used >> ACES);
+    memcpy(packed->score, &game->score[ACES], NUMBER_OF_CATEGORIES);
+
+}//end game_pack
+
+
+// ---------------------------------------------------------------------
+// Function
+//     game_unpack
+// Inputs
+//     packed
+//         A game packed by game_pack().
+//     game
+//         Where to put the game.
+// Outputs
+//     none
+// Description
+//     This function turns a game_packed_t back into a game.
+// ---------------------------------------------------------------------
+void game_unpack(const struct game_packed_t *packed, struct game_t *game)
+{
+    uint32_t play = packed->play;
+
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        game->dice[i] = (play >> (i * DIE_BITS)) & DIE_MASK;
+    }
+    game->keep = (play >> KEEP_SHIFT) & KEEP_MASK;
+    game->roll = (play >> ROLL_SHIFT) & ROLL_MASK;
+    game->turn = (play >> TURN_SHIFT) & TURN_MASK;
+    game->quit = (play >> QUIT_SHIFT) & 1;
+    game->bonus = (play >> BONUS_SHIFT) & BONUS_MASK;
+    game->seed = 0;
+    game->rng  = packed->rng;
+    game->used = (unsigned int)packed->used << ACES;
+    game->score[0] = 0;
+    memcpy(&game->score[ACES], packed->score, NUMBER_OF_CATEGORIES);
+
+}//end game_unpack
+
+// end game.c
@@ -0,0 +1,85 @@
+// -------------------------------------------------------------------
+// File: game.h
+//
+// Name: Marshall Liu
+//
+// Description: This is the header file for the GAME module of the
+//     YAHTZEE game. A game is a plain value, and game_step() moves it
+//     forward by one player action without doing any input or output.
+// -------------------------------------------------------------------
+
+#ifndef GAME_H
+#define GAME_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rules.h"
+
+// Player actions
+#define GAME_KEEP  'K'   // arg is the die (1 thru NUMBER_OF_DICE)
+#define GAME_ROLL  'R'
+#define GAME_SCORE 'S'   // arg is the scorecard item
+#define GAME_QUIT  'Q'
+
+// Events, OR'ed together in a successful game_step() result
+#define GAME_EVENT_KEEP     0x01  // A die switched between keep and roll
+#define GAME_EVENT_ROLLED   0x02  // The dice that weren't kept were rolled
+#define GAME_EVENT_SCORED   0x04  // The dice went on the scorecard
+#define GAME_EVENT_NEW_TURN 0x08  // All the dice were rolled for a new turn
+#define GAME_EVENT_OVER     0x10  // The last turn was scored
+#define GAME_EVENT_QUIT     0x20  // The player quit
+#define GAME_EVENT_BONUS    0x40  // The score earned a YAHTZEE bonus
+
+// Errors, returned by game_step() when the action isn't allowed
+#define GAME_ERROR_OVER     -1
+#define GAME_ERROR_BAD_DIE  -2
+#define GAME_ERROR_NO_ROLLS -3
+#define GAME_ERROR_BAD_ITEM -4
+#define GAME_ERROR_USED     -5
+#define GAME_ERROR_ACTION   -6
+#define GAME_ERROR_JOKER    -7    // The Joker rule says to score elsewhere
+
+// Everything there is to know about one game in progress
+struct game_t {
+    uint64_t      seed;                             // What rng started at
+    uint64_t      rng;                              // Dice generator
+    unsigned char dice[NUMBER_OF_DICE];
+    unsigned char keep;                             // Bit mask of dice
+    unsigned char turn;                             // 1 thru MAX_TURNS
+    unsigned char roll;                             // 1 thru MAX_ROLLS
+    bool          quit;
+    unsigned int  used;                             // Bit mask of items
+    unsigned char score[NUMBER_OF_CATEGORIES + 1];  // row 0 is not used
+    unsigned char bonus;                            // YAHTZEE bonuses
+};
+
+// A game packed into 27 bytes, for keeping many idle games in memory.
+// The dice are 3 bits each, followed by the keep mask, roll, turn,
+// quit flag and YAHTZEE bonuses; see game_pack().
+struct game_packed_t {
+    uint64_t rng;
+    uint32_t play;                          // Dice, keep, ..., bonuses
+    uint16_t used;                          // Bit (item - 1) per item
+    uint8_t  score[NUMBER_OF_CATEGORIES];   // Item 1 is score[0]
+} __attribute__((packed));
+
+// One thing a player can do
+struct game_action_t {
+    int type;   // GAME_KEEP, GAME_ROLL, GAME_SCORE or GAME_QUIT
+    int arg;
+};
+
+extern void game_new(struct game_t *game, const uint64_t seed);
+extern int  game_step(const struct game_t *game,
+                      const struct game_action_t action,
+                      struct game_t *next);
+extern bool game_over(const struct game_t *game);
+extern int  game_upper(const struct game_t *game);
+extern int  game_total(const struct game_t *game);
+extern const char *game_error_text(const int error);
+extern void game_pack(const struct game_t *game,
+                      struct game_packed_t *packed);
+extern void game_unpack(const struct game_packed_t *packed,
+                        struct game_t *game);
+
+#endif // GAME_H
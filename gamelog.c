@@ -0,0 +1,169 @@
+// ----------------------------------------------------------------------
+// File: gamelog.c
+//
+// Name: Al Shaffer & Marshall Liu
+//
+// Description: This GAMELOG module keeps games as lines of text, one
+//     line per game, so that how a game was played can be looked at
+//     afterward. A line is the player's name, the seed, and then every
+//     action in the order it was taken:
+//
+//         alice 1234 K1 K3 R K2 R S12 R S5 ...
+//
+//     K<die> switches a die between keep and roll, R rolls, S<item>
+//     scores the dice in the item, and Q quits. Since a game is all in
+//     its seed and its actions, replaying the line through game_step()
+//     shows the dice at every decision, and what was kept and scored.
+// ----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include "score.h"
+#include "rules.h"
+#include "game.h"
+#include "gamelog.h"
+
+#define BASE_10 10
+
+
+// **************************************************************************
+// *************************** EXTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     gamelog_write
+// Inputs
+//     file
+//         Where to write the line.
+//     player
+//         Who played, without spaces.
+//     seed
+//         The seed the game was started from.
+//     actions
+//         Every action taken, in order.
+//     count
+//         The number of actions.
+// Outputs
+//     function result
+// Description
+//     This function writes one game as a line, returning SUCCESS or
+//     !SUCCESS if it couldn't be written.
+// ---------------------------------------------------------------------
+int gamelog_write(FILE *file, const char *player, const uint64_t seed,
+                  const struct game_action_t actions[], const int count)
+{
+    fprintf(file, "%s %" PRIu64, player, seed);
+    for (int i = 0; i < count; ++i) {
+        if ((actions[i].type == GAME_KEEP) || (actions[i].type == GAME_SCORE)) {
+            fprintf(file, " %c%i", actions[i].type, actions[i].arg);
+        } else {
+            fprintf(file, " %c", actions[i].type);
+        }
+    }
+    fputc('\n', file);
+
+    return ferror(file) ? !SUCCESS : SUCCESS;
+
+}//end gamelog_write
+
+
+// ---------------------------------------------------------------------
+// Function
+//     gamelog_split
+// Inputs
+//     line
+//         A line of a log, which is changed.
+// Outputs
+//     function result
+// Description
+//     This function ends the line's player name where it ends, so the
+//     line starts with just the name, and returns the rest of the line
+//     (the seed and the actions) for gamelog_replay(). The result is
+//     NULL if there isn't a name of at most GAMELOG_MAX_PLAYER
+//     characters followed by something.
+// ---------------------------------------------------------------------
+char *gamelog_split(char *line)
+{
+    size_t len = strcspn(line, " \t\r\n");
+
+    if ((len == 0) || (len > GAMELOG_MAX_PLAYER) ||
+        ((line[len] != ' ') && (line[len] != '\t'))) {
+        return NULL;
+    }
+    line[len] = '\0';
+
+    return line + len + 1;
+
+}//end gamelog_split
+
+
+// ---------------------------------------------------------------------
+// Function
+//     gamelog_replay
+// Inputs
+//     play
+//         The seed and the actions of a game, from gamelog_split().
+//     fn
+//         Called before each action is taken, or NULL.
+//     context
+//         Passed to fn.
+//     game
+//         Where to put the game as it was after the last action.
+// Outputs
+//     function result
+// Description
+//     This function plays the game again, returning SUCCESS, or
+//     !SUCCESS if the line can't be read or an action isn't allowed.
+//     A game that was replayed may not be over; the caller checks
+//     game_over().
+// ---------------------------------------------------------------------
+int gamelog_replay(const char *play, gamelog_fn_t fn, void *context,
+                   struct game_t *game)
+{
+    struct game_action_t action;
+    uint64_t             seed;
+    char                *end;
+    int                  count = 0;
+
+    seed = strtoull(play, &end, BASE_10);
+    if (end == play) {
+        return !SUCCESS;
+    }
+    game_new(game, seed);
+
+    for (play = end; *play != '\0'; ++play) {
+        if (isspace((unsigned char)*play)) {
+            continue;
+        }
+        if (++count > GAMELOG_MAX_ACTIONS) {
+            return !SUCCESS;
+        }
+
+        action.type = toupper((unsigned char)*play);
+        action.arg  = 0;
+        if ((action.type == GAME_KEEP) || (action.type == GAME_SCORE)) {
+            action.arg = strtol(play + 1, &end, BASE_10);
+            if (end == play + 1) {
+                return !SUCCESS;
+            }
+            play = end - 1;
+        }
+
+        if (fn != NULL) {
+            fn(game, action, context);
+        }
+        if (game_step(game, action, game) < 0) {
+            return !SUCCESS;
+        }
+    }
+
+    return SUCCESS;
+
+}//end gamelog_replay
+
+// end gamelog.c
@@ -0,0 +1,33 @@
+// -------------------------------------------------------------------
+// File: gamelog.h
+//
+// Name: Marshall Liu
+//
+// Description: This is the header file for the GAMELOG module, which
+//     writes every action of a game as a line of text, and replays the
+//     lines to look at each decision that was made.
+// -------------------------------------------------------------------
+
+#ifndef GAMELOG_H
+#define GAMELOG_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "game.h"
+
+#define GAMELOG_MAX_ACTIONS 1024   // In one game
+#define GAMELOG_MAX_PLAYER  64     // Characters in a player's name
+
+// Called by gamelog_replay() before each action is taken
+typedef void (*gamelog_fn_t)(const struct game_t *game,
+                             const struct game_action_t action,
+                             void *context);
+
+extern int  gamelog_write(FILE *file, const char *player, const uint64_t seed,
+                          const struct game_action_t actions[],
+                          const int count);
+extern char *gamelog_split(char *line);
+extern int  gamelog_replay(const char *play, gamelog_fn_t fn, void *context,
+                           struct game_t *game);
+
+#endif // GAMELOG_H
@@ -0,0 +1,535 @@
+// ----------------------------------------------------------------------
+// File: hint.c
+//
+// Name: Al Shaffer & Marshall Liu
+//
+// Description: This HINT module works out the best play for hints while
+//     the player is still looking at the dice, so a hint is there as
+//     soon as it's asked for, even without a solved table (when the
+//     values come from a MEMO cache, and a turn can take seconds).
+//
+//     A worker thread, at idle priority so it never holds up the
+//     screen or the keyboard, is told the scorecard each time the dice
+//     are rolled. It works out that turn first, and then the turns the
+//     scorecard is most likely to lead to: each item the dice on the
+//     table could be scored in, best first. The last HINT_SLOTS turns
+//     are kept, by scorecard.
+//
+//     The worker, and the table or cache it works from, lasts for the
+//     whole process, so later games start with the cache already
+//     warm; hint_reset() only forgets the last game.
+//
+//     A new scorecard cancels whatever the worker was doing for the old
+//     one, unless it's the new one, and so does a hint for a turn it
+//     hasn't got to yet. A cancelled job keeps nothing (the MEMO cache
+//     only keeps values it finished), so the cache is always right.
+// ----------------------------------------------------------------------
+
+#define _GNU_SOURCE   // for SCHED_IDLE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sched.h>
+#include "score.h"
+#include "rules.h"
+#include "game.h"
+#include "solver.h"
+#include "evtable.h"
+#include "memo.h"
+#include "hint.h"
+
+#define FULL_MASK (SOLVER_MASKS - 1)
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     find_slot
+// Inputs
+//     h
+//         The hints, locked.
+//     state
+//         The scorecard at the start of a turn.
+// Outputs
+//     function result
+// Description
+//     Returns the turn kept for the scorecard, or NULL if there isn't
+//     one.
+// ---------------------------------------------------------------------
+static struct hint_entry_t *find_slot(struct hint_t *h, const int state)
+{
+    for (int i = 0; i < HINT_SLOTS; ++i) {
+        if (h->slots[i].state == state) {
+            return &h->slots[i];
+        }
+    }
+
+    return NULL;
+
+}//end find_slot
+
+
+// ---------------------------------------------------------------------
+// Function
+//     cancelled
+// Inputs
+//     h
+//         The hints.
+// Outputs
+//     function result
+// Description
+//     Returns whether the worker's job was cancelled, without the lock.
+// ---------------------------------------------------------------------
+static bool cancelled(const struct hint_t *h)
+{
+    return __atomic_load_n(&h->cancel, __ATOMIC_RELAXED) != 0;
+}//end cancelled
+
+
+// ---------------------------------------------------------------------
+// Function
+//     set_cancel
+// Inputs
+//     h
+//         The hints, locked.
+//     cancel
+//         Whether to cancel the worker's job.
+// Outputs
+//     none
+// Description
+//     This function cancels the worker's job, or clears the cancel.
+// ---------------------------------------------------------------------
+static void set_cancel(struct hint_t *h, const int cancel)
+{
+    __atomic_store_n(&h->cancel, cancel, __ATOMIC_RELAXED);
+}//end set_cancel
+
+
+// ---------------------------------------------------------------------
+// Function
+//     set_up
+// Inputs
+//     h
+//         The hints.
+// Outputs
+//     none
+// Description
+//     This function loads the table, or if there isn't one, makes the
+//     MEMO cache, and tells anyone waiting whether it could.
+// ---------------------------------------------------------------------
+static void set_up(struct hint_t *h)
+{
+    if (h->table_path != NULL) {
+        h->table = evtable_load(h->table_path);
+    }
+    if (h->table == NULL) {
+        h->memo = memo_new(h->memo_bytes);
+        if (h->memo != NULL) {
+            h->memo->cancel = &h->cancel;
+        }
+    }
+    solver_dice();
+
+    pthread_mutex_lock(&h->lock);
+    h->ready  = (h->table != NULL) || (h->memo != NULL);
+    h->failed = !h->ready;
+    pthread_cond_broadcast(&h->done);
+    pthread_mutex_unlock(&h->lock);
+
+}//end set_up
+
+
+// ---------------------------------------------------------------------
+// Function
+//     work_out
+// Inputs
+//     h
+//         The hints, unlocked.
+//     state
+//         The scorecard at the start of a turn.
+//     turn
+//         Whether to work out the turn, in h->scratch.
+//     roll
+//         The dice on the table, to rank the next scorecards by, or -1.
+//     next
+//         Where to put the next scorecards, best first.
+//     count
+//         Where to put how many there are.
+// Outputs
+//     function result
+// Description
+//     This function is the worker's job. It returns false if the job
+//     was cancelled, when nothing it worked out can be trusted.
+// ---------------------------------------------------------------------
+static bool work_out(struct hint_t *h, const int state, const bool turn,
+                     const int roll, int next[], int *count)
+{
+    struct hint_entry_t *e = &h->scratch;
+    unsigned int         card = state / SOLVER_UPPER;
+    int                  upper = state % SOLVER_UPPER;
+    float                rows[NUMBER_OF_CATEGORIES + 1][SOLVER_UPPER];
+    const float         *after[NUMBER_OF_CATEGORIES + 1];
+    float                value[HINT_QUEUE];
+    float                v;
+    unsigned int         items;
+    int                  item;
+    int                  score;
+    int                  s;
+    int                  i;
+
+    if (h->table != NULL) {
+        evtable_rows(h->table, card, rows, after);
+    } else {
+        memo_rows(h->memo, state, rows, after);
+    }
+    if (cancelled(h)) {
+        return false;
+    }
+
+    if (turn) {
+        solver_turn_rows(after, state, &e->turn);
+        for (int r = 0; r < SOLVER_ROLLS; ++r) {
+            e->best_item[r] = solver_best_item(after, state, r);
+        }
+        e->state = state;
+    }
+
+    // Rank where the dice on the table would leave the scorecard
+    *count = 0;
+    for (items = (roll >= 0) ? solver_items(state, roll) : 0; items != 0;
+         items &= items - 1) {
+        item  = __builtin_ctz(items) + ACES;
+        score = solver_item_score(state, roll, item);
+        s     = solver_state(solver_card_after(card, item, score),
+                             solver_upper_after(upper, item, score));
+        if (solver_card_mask(s / SOLVER_UPPER) == FULL_MASK) {
+            continue;
+        }
+        v = solver_item_value(after, state, roll, item);
+        for (i = *count; (i > 0) && (value[i - 1] < v); --i) {
+            value[i] = value[i - 1];
+            next[i]  = next[i - 1];
+        }
+        value[i] = v;
+        next[i]  = s;
+        ++*count;
+    }
+
+    return true;
+
+}//end work_out
+
+
+// ---------------------------------------------------------------------
+// Function
+//     publish
+// Inputs
+//     h
+//         The hints, locked.
+//     turn
+//         Whether h->scratch has a new turn to keep.
+//     rank
+//         Whether the next scorecards are for the game's scorecard.
+//     next
+//         The next scorecards, best first.
+//     count
+//         How many there are.
+// Outputs
+//     none
+// Description
+//     This function keeps what the worker's job worked out, in place
+//     of the oldest turn kept, and queues the next scorecards that
+//     aren't kept or queued already.
+// ---------------------------------------------------------------------
+static void publish(struct hint_t *h, const bool turn, const bool rank,
+                   const int next[], const int count)
+{
+    bool queued;
+
+    if (turn) {
+        h->slots[h->hand] = h->scratch;
+        h->hand = (h->hand + 1) % HINT_SLOTS;
+        ++h->worked;
+    }
+
+    for (int i = 0; rank && (i < count); ++i) {
+        queued = (find_slot(h, next[i]) != NULL);
+        for (int q = 0; q < h->queued; ++q) {
+            queued = queued || (h->queue[q] == next[i]);
+        }
+        if (!queued && (h->queued < HINT_QUEUE)) {
+            h->queue[h->queued++] = next[i];
+        }
+    }
+
+}//end publish
+
+
+// ---------------------------------------------------------------------
+// Function
+//     worker_loop
+// Inputs
+//     arg
+//         The hints.
+// Outputs
+//     function result
+// Description
+//     This function is the worker: it takes jobs off the queue until
+//     it's stopped.
+// ---------------------------------------------------------------------
+static void *worker_loop(void *arg)
+{
+    struct hint_t     *h = arg;
+    struct sched_param param = { 0 };
+    int                next[HINT_QUEUE];
+    int                count;
+    int                state;
+    int                roll;
+    bool               turn;
+    bool               ok;
+
+    pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+    set_up(h);
+
+    pthread_mutex_lock(&h->lock);
+    while (!h->stop && !h->failed) {
+        if (h->queued == 0) {
+            pthread_cond_wait(&h->wake, &h->lock);
+            continue;
+        }
+        state = h->queue[0];
+        --h->queued;
+        memmove(h->queue, h->queue + 1, h->queued * sizeof(h->queue[0]));
+        turn = (find_slot(h, state) == NULL);
+        roll = (state == h->ahead) ? h->roll : -1;
+        if (!turn && (roll < 0)) {
+            continue;
+        }
+        h->current = state;
+        pthread_mutex_unlock(&h->lock);
+
+        ok = work_out(h, state, turn, roll, next, &count);
+
+        pthread_mutex_lock(&h->lock);
+        if (ok && !cancelled(h)) {
+            publish(h, turn, (state == h->ahead) && (roll == h->roll), next,
+                    count);
+        }
+        h->current = -1;
+        set_cancel(h, 0);
+        pthread_cond_broadcast(&h->done);
+    }
+    pthread_mutex_unlock(&h->lock);
+
+    return NULL;
+
+}//end worker_loop
+
+
+// **************************************************************************
+// *************************** EXTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     hint_start
+// Inputs
+//     table_path
+//         The solved table to load, or NULL.
+//     memo_bytes
+//         How big a MEMO cache to work values out in, without a table.
+// Outputs
+//     function result
+// Description
+//     This function starts the worker, which loads the table (or makes
+//     the cache) in the background, and returns the hints to be
+//     stopped with hint_stop(), or NULL if it couldn't start.
+// ---------------------------------------------------------------------
+struct hint_t *hint_start(const char *table_path, const size_t memo_bytes)
+{
+    struct hint_t *h = calloc(1, sizeof(*h));
+
+    if (h == NULL) {
+        return NULL;
+    }
+    h->table_path = table_path;
+    h->memo_bytes = memo_bytes;
+    h->current    = -1;
+    h->ahead      = -1;
+    for (int i = 0; i < HINT_SLOTS; ++i) {
+        h->slots[i].state = -1;
+    }
+    pthread_mutex_init(&h->lock, NULL);
+    pthread_cond_init(&h->wake, NULL);
+    pthread_cond_init(&h->done, NULL);
+    if (pthread_create(&h->thread, NULL, worker_loop, h) != 0) {
+        free(h);
+        return NULL;
+    }
+
+    return h;
+
+}//end hint_start
+
+
+// ---------------------------------------------------------------------
+// Function
+//     hint_reset
+// Inputs
+//     h
+//         The hints.
+// Outputs
+//     none
+// Description
+//     This function is for a new game: it cancels whatever the worker
+//     is doing, empties its queue and forgets the turns kept. The
+//     table or MEMO cache is kept.
+// ---------------------------------------------------------------------
+void hint_reset(struct hint_t *h)
+{
+    pthread_mutex_lock(&h->lock);
+    if (h->current >= 0) {
+        set_cancel(h, 1);
+    }
+    h->ahead  = -1;
+    h->queued = 0;
+    for (int i = 0; i < HINT_SLOTS; ++i) {
+        h->slots[i].state = -1;
+    }
+    pthread_mutex_unlock(&h->lock);
+
+}//end hint_reset
+
+
+// ---------------------------------------------------------------------
+// Function
+//     hint_ahead
+// Inputs
+//     h
+//         The hints.
+//     game
+//         A game that isn't over, whose dice were just rolled.
+// Outputs
+//     none
+// Description
+//     This function tells the worker where the game is, so it works out
+//     the game's turn and the turns likely to come after it. It doesn't
+//     wait for anything.
+// ---------------------------------------------------------------------
+void hint_ahead(struct hint_t *h, const struct game_t *game)
+{
+    int state = solver_state_of(game);
+
+    pthread_mutex_lock(&h->lock);
+    if ((state != h->ahead) && (h->current >= 0) && (h->current != state)) {
+        set_cancel(h, 1);
+    }
+    h->ahead    = state;
+    h->roll     = solver_roll_of(game->dice);
+    h->queue[0] = state;
+    h->queued   = 1;
+    pthread_cond_signal(&h->wake);
+    pthread_mutex_unlock(&h->lock);
+
+}//end hint_ahead
+
+
+// ---------------------------------------------------------------------
+// Function
+//     hint_turn
+// Inputs
+//     h
+//         The hints.
+//     game
+//         A game that isn't over.
+//     turn
+//         Where to put the values for the game's turn.
+// Outputs
+//     function result
+// Description
+//     This function gets the game's turn, waiting for the worker if it
+//     hasn't worked it out yet, and returns the best item to score the
+//     dice in, or -1 if there's no memory for hints.
+// ---------------------------------------------------------------------
+int hint_turn(struct hint_t *h, const struct game_t *game,
+              struct solver_turn_t *turn)
+{
+    int                  state = solver_state_of(game);
+    int                  best = -1;
+    struct hint_entry_t *e;
+
+    pthread_mutex_lock(&h->lock);
+    e = find_slot(h, state);
+    if (e != NULL) {
+        ++h->hits;
+    } else {
+        ++h->waits;
+    }
+    while ((e == NULL) && !h->failed) {
+        if (h->current != state) {
+            if (h->current >= 0) {
+                set_cancel(h, 1);
+            }
+            h->queue[0] = state;
+            h->queued   = 1;
+            pthread_cond_signal(&h->wake);
+        }
+        pthread_cond_wait(&h->done, &h->lock);
+        e = find_slot(h, state);
+    }
+    if (e != NULL) {
+        *turn = e->turn;
+        best  = e->best_item[solver_roll_of(game->dice)];
+    }
+    pthread_mutex_unlock(&h->lock);
+
+    return best;
+
+}//end hint_turn
+
+
+// ---------------------------------------------------------------------
+// Function
+//     hint_stop
+// Inputs
+//     h
+//         From hint_start(), or NULL.
+// Outputs
+//     none
+// Description
+//     This function cancels whatever the worker is doing, waits for it
+//     to stop, and frees the hints.
+// ---------------------------------------------------------------------
+void hint_stop(struct hint_t *h)
+{
+    if (h == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&h->lock);
+    h->stop = true;
+    set_cancel(h, 1);
+    pthread_cond_signal(&h->wake);
+    pthread_mutex_unlock(&h->lock);
+    pthread_join(h->thread, NULL);
+
+    if (h->table != NULL) {
+        evtable_free(h->table);
+    }
+    if (h->memo != NULL) {
+        memo_free(h->memo);
+    }
+    pthread_cond_destroy(&h->done);
+    pthread_cond_destroy(&h->wake);
+    pthread_mutex_destroy(&h->lock);
+    free(h);
+
+}//end hint_stop
+
+// end hint.c
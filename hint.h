@@ -0,0 +1,69 @@
+// -------------------------------------------------------------------
+// File: hint.h
+//
+// Name: Marshall Liu
+//
+// Description: This is the header file for the HINT module, which
+//     works out the best play for hints in a background thread, ahead
+//     of being asked, and keeps the last few turns it worked out.
+// -------------------------------------------------------------------
+
+#ifndef HINT_H
+#define HINT_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "score.h"
+#include "game.h"
+#include "solver.h"
+#include "evtable.h"
+#include "memo.h"
+
+#define HINT_SLOTS  16   // Turns kept, the current one and what's likely next
+#define HINT_QUEUE  (1 + NUMBER_OF_CATEGORIES)
+
+// A turn worked out for hints
+struct hint_entry_t {
+    int                  state;                   // -1 if empty
+    unsigned char        best_item[SOLVER_ROLLS]; // After the last roll
+    struct solver_turn_t turn;
+};
+
+// The worker and what it has worked out. Everything from ready on is
+// shared with the worker, under lock.
+struct hint_t {
+    pthread_t           thread;
+    pthread_mutex_t     lock;
+    pthread_cond_t      wake;        // There's work, or it's time to stop
+    pthread_cond_t      done;        // A job finished, or the worker gave up
+    const char         *table_path;  // Or NULL for the memo
+    size_t              memo_bytes;
+    struct evtable_t   *table;       // Only the worker uses these two
+    struct memo_t      *memo;
+    bool                ready;       // Table or memo set up
+    bool                failed;      // Neither could be
+    bool                stop;
+    int                 cancel;      // Give up the job being worked on
+    int                 current;     // The job's scorecard, or -1
+    int                 ahead;       // The game's scorecard
+    int                 roll;        // And its dice (solver_roll_of())
+    int                 queue[HINT_QUEUE];  // Scorecards to work out
+    int                 queued;
+    int                 hand;        // Next slot to reuse
+    struct hint_entry_t slots[HINT_SLOTS];
+    struct hint_entry_t scratch;     // The worker's, for the job
+    unsigned long       worked;      // Turns worked out
+    unsigned long       hits;        // Hints that didn't have to wait
+    unsigned long       waits;
+};
+
+extern struct hint_t *hint_start(const char *table_path,
+                                 const size_t memo_bytes);
+extern void hint_reset(struct hint_t *h);
+extern void hint_ahead(struct hint_t *h, const struct game_t *game);
+extern int  hint_turn(struct hint_t *h, const struct game_t *game,
+                      struct solver_turn_t *turn);
+extern void hint_stop(struct hint_t *h);
+
+#endif // HINT_H
@@ -0,0 +1,576 @@
+// ----------------------------------------------------------------------
+// File: learn.c
+//
+// Name: Al Shaffer & Marshall Liu
+//
+// Description: This LEARN module plays for the most points without a
+//     solved table, from a linear model of what a scorecard is worth
+//     at the start of a turn. The turn itself is still played right:
+//     the model only stands in for the table's rows of the scorecards
+//     after the turn, and the SOLVER module's turn pieces do the rest,
+//     so the model only has to rank scorecards, not dice.
+//
+//     A scorecard's features are which items are open, each pair of
+//     open items (an open CHANCE is worth more with hard items still
+//     open, say), how many items are open, how many turns could earn a
+//     YAHTZEE bonus, and, while the upper bonus is still to be made,
+//     the points it still needs (and their square) for each open item
+//     and the upper total for each number of upper items open. That's
+//     about 500 weights, 2 KB of floats.
+//
+//     The weights are fitted by least squares to what the scorecards
+//     games reach are worth (the trainer, train.c, says worth by what).
+//     The sums the fit needs add up game by game, so games can be
+//     played in as many threads as there are, each with its own sums,
+//     and the sums merged before one small fit.
+//
+//     Saved models are a small header and the weights, in the
+//     machine's byte order.
+// ----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <errno.h>
+#include <math.h>
+#include "score.h"
+#include "rules.h"
+#include "game.h"
+#include "solver.h"
+#include "learn.h"
+
+#define MAGIC      "YZLM"
+#define MAGIC_SIZE 4
+
+
+// **************************************************************************
+// ****************************  DEFINED TYPES   ****************************
+// **************************************************************************
+
+// The start of a saved model
+struct learn_header_t {
+    char     magic[MAGIC_SIZE];
+    uint32_t features;
+};
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     pair_of
+// Inputs
+//     i, j
+//         Two items (bit item - 1), i < j.
+// Outputs
+//     function result
+// Description
+//     Returns the number of the pair, less than LEARN_PAIRS.
+// ---------------------------------------------------------------------
+static inline int pair_of(const int i, const int j)
+{
+    return i * (2 * NUMBER_OF_CATEGORIES - i - 1) / 2 + (j - i - 1);
+}//end pair_of
+
+
+// ---------------------------------------------------------------------
+// Function
+//     upper_feature
+// Inputs
+//     state
+//         A scorecard.
+// Outputs
+//     function result
+// Description
+//     Returns the scorecard's upper total feature, or -1 if it has
+//     none (the bonus is made, or every upper item is used).
+// ---------------------------------------------------------------------
+static inline int upper_feature(const int state)
+{
+    unsigned int mask = solver_card_mask(state / SOLVER_UPPER);
+    int          upper = state % SOLVER_UPPER;
+    int          uppers = NUMBER_OF_SIDES -
+                          __builtin_popcount(mask & SOLVER_UPPER_BITS);
+
+    if ((uppers == 0) || (upper >= BONUS_THRESHOLD)) {
+        return -1;
+    }
+
+    return LEARN_UPPER + (uppers - 1) * BONUS_THRESHOLD + upper;
+
+}//end upper_feature
+
+
+// ---------------------------------------------------------------------
+// Function
+//     learn_row
+// Inputs
+//     m
+//         The model.
+//     card
+//         A card.
+//     row
+//         Where to put SOLVER_UPPER values.
+// Outputs
+//     none
+// Description
+//     This function fills in the model's values of the scorecards
+//     with this card, by upper total. Only the upper total features
+//     change along a row, so the rest is summed once, and the points
+//     still needed for the bonus come in as a quadratic.
+// ---------------------------------------------------------------------
+static void learn_row(const struct learn_t *m, const unsigned int card,
+                      float row[])
+{
+    unsigned int open = ~solver_card_mask(card) & (SOLVER_MASKS - 1);
+    float        base = learn_value(m, card * SOLVER_UPPER + BONUS_THRESHOLD);
+    float        linear = 0;
+    float        square = 0;
+    float        need;
+    int          feature;
+
+    for (int i = 0; i < NUMBER_OF_CATEGORIES; ++i) {
+        if (open & (1u << i)) {
+            linear += m->weight[LEARN_NEED + 2 * i];
+            square += m->weight[LEARN_NEED + 2 * i + 1];
+        }
+    }
+    for (int u = 0; u < SOLVER_UPPER; ++u) {
+        feature = upper_feature(card * SOLVER_UPPER + u);
+        need    = (float)(BONUS_THRESHOLD - u) / BONUS_THRESHOLD;
+        row[u]  = base + ((feature >= 0) ? m->weight[feature] +
+                                           (linear + square * need) * need
+                                         : 0);
+    }
+
+}//end learn_row
+
+
+// ************************************************************************
+// *************************  EXTERNAL FUNCTIONS **************************
+// ************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     learn_features
+// Inputs
+//     state
+//         A scorecard.
+//     index
+//         Where to put the features it has, up to LEARN_MAX_ACTIVE.
+//     value
+//         Where to put their values.
+// Outputs
+//     function result
+// Description
+//     Returns how many features the scorecard has. The full scorecard
+//     has none, so the model's value of it is always 0.
+// ---------------------------------------------------------------------
+int learn_features(const int state, unsigned short index[], float value[])
+{
+    unsigned int card = state / SOLVER_UPPER;
+    unsigned int open = ~solver_card_mask(card) & (SOLVER_MASKS - 1);
+    int          count = __builtin_popcount(open);
+    int          upper = upper_feature(state);
+    float        need = 0;
+    int          n = 0;
+
+    if (open == 0) {
+        return 0;
+    } else if (upper >= 0) {
+        need = (float)(BONUS_THRESHOLD - state % SOLVER_UPPER) /
+               BONUS_THRESHOLD;
+    }
+
+    index[n] = LEARN_BIAS;
+    value[n++] = 1;
+    index[n] = LEARN_COUNT + count - 1;
+    value[n++] = 1;
+    for (int i = 0; i < NUMBER_OF_CATEGORIES; ++i) {
+        if (!(open & (1u << i))) {
+            continue;
+        }
+        index[n] = LEARN_OPEN + i;
+        value[n++] = 1;
+        if (need > 0) {
+            index[n] = LEARN_NEED + 2 * i;
+            value[n++] = need;
+            index[n] = LEARN_NEED + 2 * i + 1;
+            value[n++] = need * need;
+        }
+        for (int j = i + 1; j < NUMBER_OF_CATEGORIES; ++j) {
+            if (open & (1u << j)) {
+                index[n] = LEARN_PAIR + pair_of(i, j);
+                value[n++] = 1;
+            }
+        }
+    }
+
+    // Every turn left could be a bonus once YAHTZEE is scored 50; all
+    // but one if it's still open
+    if (card >= SOLVER_MASKS) {
+        index[n] = LEARN_JOKER;
+        value[n++] = count;
+    } else if (open & SOLVER_YAHTZEE_BIT) {
+        index[n] = LEARN_JOKER + 1;
+        value[n++] = count - 1;
+    }
+    if (upper >= 0) {
+        index[n] = upper;
+        value[n++] = 1;
+    }
+
+    return n;
+
+}//end learn_features
+
+
+// ---------------------------------------------------------------------
+// Function
+//     learn_value
+// Inputs
+//     m
+//         The model.
+//     state
+//         A scorecard.
+// Outputs
+//     function result
+// Description
+//     Returns the model's value of the scorecard: the points still to
+//     come from the start of a turn.
+// ---------------------------------------------------------------------
+float learn_value(const struct learn_t *m, const int state)
+{
+    unsigned short index[LEARN_MAX_ACTIVE];
+    float          value[LEARN_MAX_ACTIVE];
+    int            n = learn_features(state, index, value);
+    float          sum = 0;
+
+    for (int i = 0; i < n; ++i) {
+        sum += m->weight[index[i]] * value[i];
+    }
+
+    return sum;
+
+}//end learn_value
+
+
+// ---------------------------------------------------------------------
+// Function
+//     learn_rows
+// Inputs
+//     m
+//         The model.
+//     card
+//         The card at the start of a turn.
+//     rows
+//         Room for a row for each item, and SOLVER_ZERO_ROW.
+//     next
+//         Where to put the rows, as for solver_rows().
+// Outputs
+//     none
+// Description
+//     This function fills in the rows a turn needs from the model.
+// ---------------------------------------------------------------------
+void learn_rows(const struct learn_t *m, const unsigned int card,
+                float rows[][SOLVER_UPPER], const float *next[])
+{
+    unsigned int mask = solver_card_mask(card);
+
+    for (int item = ACES; item <= CHANCE; ++item) {
+        if (!(mask & (1u << (item - ACES)))) {
+            learn_row(m, solver_card_after(card, item, SCORE_YAHTZEE),
+                      rows[item]);
+            next[item] = rows[item];
+        }
+    }
+    if (!(mask & SOLVER_YAHTZEE_BIT)) {
+        learn_row(m, solver_card_after(card, YAHTZEE, 0),
+                  rows[SOLVER_ZERO_ROW]);
+        next[SOLVER_ZERO_ROW] = rows[SOLVER_ZERO_ROW];
+    }
+
+}//end learn_rows
+
+
+// ---------------------------------------------------------------------
+// Function
+//     learn_turn
+// Inputs
+//     m
+//         The model.
+//     state
+//         The scorecard at the start of the turn.
+//     turn
+//         Where to put the values for the turn.
+// Outputs
+//     none
+// Description
+//     This function is solver_turn() from the model.
+// ---------------------------------------------------------------------
+void learn_turn(const struct learn_t *m, const int state,
+                struct solver_turn_t *turn)
+{
+    float        rows[NUMBER_OF_CATEGORIES + 1][SOLVER_UPPER];
+    const float *next[NUMBER_OF_CATEGORIES + 1];
+
+    learn_rows(m, state / SOLVER_UPPER, rows, next);
+    solver_turn_rows(next, state, turn);
+
+}//end learn_turn
+
+
+// ---------------------------------------------------------------------
+// Function
+//     learn_choose
+// Inputs
+//     m
+//         The model.
+//     game
+//         A game that isn't over.
+//     turn
+//         The values for the game's turn, as for solver_choose().
+// Outputs
+//     function result
+// Description
+//     This function is solver_choose() from the model.
+// ---------------------------------------------------------------------
+struct game_action_t learn_choose(const struct learn_t *m,
+                                  const struct game_t *game,
+                                  struct solver_turn_t *turn)
+{
+    struct game_action_t action = { GAME_SCORE, 0 };
+    int                  state = solver_state_of(game);
+    float                rows[NUMBER_OF_CATEGORIES + 1][SOLVER_UPPER];
+    const float         *next[NUMBER_OF_CATEGORIES + 1];
+
+    if (turn->state != state) {
+        learn_turn(m, state, turn);
+    }
+    if (solver_keep_action(game, solver_best_keep(turn, game), &action)) {
+        return action;
+    }
+    learn_rows(m, state / SOLVER_UPPER, rows, next);
+    action.arg = solver_best_item(next, state, solver_roll_of(game->dice));
+
+    return action;
+
+}//end learn_choose
+
+
+// ---------------------------------------------------------------------
+// Function
+//     learn_add
+// Inputs
+//     sums
+//         The sums so far.
+//     state
+//         A scorecard a game was at, at the start of a turn.
+//     target
+//         What it's worth.
+// Outputs
+//     none
+// Description
+//     This function adds one scorecard to the sums for the fit.
+// ---------------------------------------------------------------------
+void learn_add(struct learn_sums_t *sums, const int state, const float target)
+{
+    unsigned short index[LEARN_MAX_ACTIVE];
+    float          value[LEARN_MAX_ACTIVE];
+    int            n = learn_features(state, index, value);
+    int            lo;
+    int            hi;
+
+    for (int a = 0; a < n; ++a) {
+        sums->xty[index[a]] += (double)value[a] * target;
+        for (int b = a; b < n; ++b) {
+            lo = (index[a] < index[b]) ? index[a] : index[b];
+            hi = index[a] ^ index[b] ^ lo;
+            sums->xtx[lo][hi] += (double)value[a] * value[b];
+        }
+    }
+    ++sums->samples;
+
+}//end learn_add
+
+
+// ---------------------------------------------------------------------
+// Function
+//     learn_merge
+// Inputs
+//     into
+//         Sums to add to.
+//     from
+//         Sums from other games.
+// Outputs
+//     none
+// Description
+//     This function adds one set of sums into another.
+// ---------------------------------------------------------------------
+void learn_merge(struct learn_sums_t *into, const struct learn_sums_t *from)
+{
+    for (int a = 0; a < LEARN_FEATURES; ++a) {
+        for (int b = a; b < LEARN_FEATURES; ++b) {
+            into->xtx[a][b] += from->xtx[a][b];
+        }
+        into->xty[a] += from->xty[a];
+    }
+    into->samples += from->samples;
+
+}//end learn_merge
+
+
+// ---------------------------------------------------------------------
+// Function
+//     learn_fit
+// Inputs
+//     sums
+//         The sums from the games played.
+//     ridge
+//         How much to pull the weights toward 0, per scorecard added.
+//         Features no game had end up 0.
+// Outputs
+//     m
+//         The fitted weights.
+//     function result
+// Description
+//     This function fits the weights by ridge regression, solving the
+//     normal equations by Cholesky factoring. It returns SUCCESS, or
+//     not if there's no memory or nothing to fit.
+// ---------------------------------------------------------------------
+int learn_fit(const struct learn_sums_t *sums, const double ridge,
+              struct learn_t *m)
+{
+    double (*a)[LEARN_FEATURES] = malloc(sizeof(double[LEARN_FEATURES]
+                                                      [LEARN_FEATURES]));
+    double  b[LEARN_FEATURES];
+    double  n = sums->samples;
+    double  sum;
+
+    if ((a == NULL) || (sums->samples == 0) || !(ridge > 0)) {
+        free(a);
+        return !SUCCESS;
+    }
+
+    // A = X'X / n + ridge I, lower triangle
+    for (int i = 0; i < LEARN_FEATURES; ++i) {
+        for (int j = 0; j <= i; ++j) {
+            a[i][j] = sums->xtx[j][i] / n;
+        }
+        a[i][i] += ridge;
+        b[i] = sums->xty[i] / n;
+    }
+
+    // A = L L'
+    for (int j = 0; j < LEARN_FEATURES; ++j) {
+        sum = a[j][j];
+        for (int k = 0; k < j; ++k) {
+            sum -= a[j][k] * a[j][k];
+        }
+        a[j][j] = sqrt(sum);
+        for (int i = j + 1; i < LEARN_FEATURES; ++i) {
+            sum = a[i][j];
+            for (int k = 0; k < j; ++k) {
+                sum -= a[i][k] * a[j][k];
+            }
+            a[i][j] = sum / a[j][j];
+        }
+    }
+
+    // L y = b, then L' w = y
+    for (int i = 0; i < LEARN_FEATURES; ++i) {
+        for (int k = 0; k < i; ++k) {
+            b[i] -= a[i][k] * b[k];
+        }
+        b[i] /= a[i][i];
+    }
+    for (int i = LEARN_FEATURES - 1; i >= 0; --i) {
+        for (int k = i + 1; k < LEARN_FEATURES; ++k) {
+            b[i] -= a[k][i] * b[k];
+        }
+        b[i] /= a[i][i];
+        m->weight[i] = b[i];
+    }
+    free(a);
+
+    return SUCCESS;
+
+}//end learn_fit
+
+
+// ---------------------------------------------------------------------
+// Function
+//     learn_save
+// Inputs
+//     m
+//         The model.
+//     path
+//         The file to save it in.
+// Outputs
+//     function result
+// Description
+//     This function saves the model, returning SUCCESS or not.
+// ---------------------------------------------------------------------
+int learn_save(const struct learn_t *m, const char *path)
+{
+    struct learn_header_t header = { MAGIC, LEARN_FEATURES };
+    FILE                 *out = fopen(path, "wb");
+    int                   result = SUCCESS;
+
+    if (out == NULL) {
+        return !SUCCESS;
+    }
+    if ((fwrite(&header, sizeof(header), 1, out) != 1) ||
+        (fwrite(m->weight, sizeof(m->weight), 1, out) != 1)) {
+        result = !SUCCESS;
+    }
+    if (fclose(out) != 0) {
+        result = !SUCCESS;
+    }
+
+    return result;
+
+}//end learn_save
+
+
+// ---------------------------------------------------------------------
+// Function
+//     learn_load
+// Inputs
+//     m
+//         Where to put the model.
+//     path
+//         A file from learn_save().
+// Outputs
+//     function result
+// Description
+//     This function loads a saved model, returning SUCCESS, or not
+//     (with errno set) if it can't.
+// ---------------------------------------------------------------------
+int learn_load(struct learn_t *m, const char *path)
+{
+    struct learn_header_t header;
+    FILE                 *in = fopen(path, "rb");
+    int                   result = SUCCESS;
+
+    if (in == NULL) {
+        return !SUCCESS;
+    }
+    if ((fread(&header, sizeof(header), 1, in) != 1) ||
+        (memcmp(header.magic, MAGIC, MAGIC_SIZE) != 0) ||
+        (header.features != LEARN_FEATURES) ||
+        (fread(m->weight, sizeof(m->weight), 1, in) != 1)) {
+        errno = EINVAL;
+        result = !SUCCESS;
+    }
+    fclose(in);
+
+    return result;
+
+}//end learn_load
+
+// end learn.c
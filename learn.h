@@ -0,0 +1,67 @@
+// -------------------------------------------------------------------
+// File: learn.h
+//
+// Name: Marshall Liu
+//
+// Description: This is the header file for the LEARN module, which
+//     plays from a small linear model of scorecard values, learned by
+//     self-play, instead of from a solved table.
+// -------------------------------------------------------------------
+
+#ifndef LEARN_H
+#define LEARN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "game.h"
+#include "solver.h"
+
+// Where each kind of feature starts in the model's weights
+#define LEARN_BIAS      0
+#define LEARN_OPEN      (LEARN_BIAS + 1)                    // By item
+#define LEARN_COUNT     (LEARN_OPEN + NUMBER_OF_CATEGORIES)  // By items open
+#define LEARN_PAIR      (LEARN_COUNT + NUMBER_OF_CATEGORIES) // By two items
+#define LEARN_PAIRS     (NUMBER_OF_CATEGORIES * (NUMBER_OF_CATEGORIES - 1) / 2)
+#define LEARN_JOKER     (LEARN_PAIR + LEARN_PAIRS)   // Turns a bonus could come
+#define LEARN_NEED      (LEARN_JOKER + 2)            // By item, and squared
+#define LEARN_UPPER     (LEARN_NEED + 2 * NUMBER_OF_CATEGORIES) // By upper
+                                                     // items open and total
+#define LEARN_FEATURES  (LEARN_UPPER + NUMBER_OF_SIDES * BONUS_THRESHOLD)
+#define LEARN_MAX_ACTIVE (3 * NUMBER_OF_CATEGORIES + LEARN_PAIRS + 5) // At once
+
+// A scorecard's value, the points still to come from the start of a
+// turn, as a weighted sum of the scorecard's features. The whole model
+// is a few KB, so it stays in cache while it plays.
+struct learn_t {
+    float weight[LEARN_FEATURES];
+};
+
+// What some games have taught: the sums for a least squares fit of the
+// weights to the points that were still to come. Only the upper
+// triangle of xtx is kept.
+struct learn_sums_t {
+    double        xtx[LEARN_FEATURES][LEARN_FEATURES];
+    double        xty[LEARN_FEATURES];
+    unsigned long samples;
+};
+
+extern int   learn_features(const int state, unsigned short index[],
+                            float value[]);
+extern float learn_value(const struct learn_t *m, const int state);
+extern void  learn_rows(const struct learn_t *m, const unsigned int card,
+                        float rows[][SOLVER_UPPER], const float *next[]);
+extern void  learn_turn(const struct learn_t *m, const int state,
+                        struct solver_turn_t *turn);
+extern struct game_action_t learn_choose(const struct learn_t *m,
+                                         const struct game_t *game,
+                                         struct solver_turn_t *turn);
+extern void  learn_add(struct learn_sums_t *sums, const int state,
+                       const float target);
+extern void  learn_merge(struct learn_sums_t *into,
+                         const struct learn_sums_t *from);
+extern int   learn_fit(const struct learn_sums_t *sums, const double ridge,
+                       struct learn_t *m);
+extern int   learn_save(const struct learn_t *m, const char *path);
+extern int   learn_load(struct learn_t *m, const char *path);
+
+#endif // LEARN_H
@@ -0,0 +1,358 @@
+// ----------------------------------------------------------------------
+// File: loadgen.c
+//
+// Name: Al Shaffer & Marshall Liu
+//
+// Description: This is a load generator for the YAHTZEE game server.
+//     It opens many connections at once and plays complete games on
+//     each of them, always with one request in flight per connection.
+//     Every game rolls twice per turn and then scores the next unused
+//     line of the scorecard. When all the games are done it reports
+//     how many sessions per second were played, and the latency of
+//     each request (from sending it to getting its reply).
+//
+// Syntax: ./yahtzee_loadgen [-s socket_path] [-c connections] [-g games]
+// ----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include "score.h"
+#include "rules.h"
+
+#define DEFAULT_SOCKET      "/tmp/yahtzee.sock"
+#define DEFAULT_CONNECTIONS 100
+#define DEFAULT_GAMES       10     // Games per connection
+#define MAX_EVENTS          256
+#define IN_SIZE             256
+#define MAX_REQUEST         32
+#define LATENCY_BUCKETS     100000 // One per microsecond up to 100 ms
+#define USEC_PER_SEC        1000000.0
+#define NSEC_PER_USEC       1000
+
+
+// **************************************************************************
+// ****************************  DEFINED TYPES   ****************************
+// **************************************************************************
+
+// One simulated player
+struct client_t {
+    int          fd;
+    unsigned int games_left;
+    unsigned int turn;        // 1 thru MAX_TURNS
+    unsigned int roll;        // 1 thru MAX_ROLLS
+    uint64_t     sent_at;     // When the request in flight was sent (ns)
+    size_t       in_len;
+    char         in[IN_SIZE];
+};
+
+
+// **************************************************************************
+// **************************** GLOBAL VARIABLES ****************************
+// **************************************************************************
+
+static unsigned int Latency[LATENCY_BUCKETS + 1]; // last is "or more"
+static unsigned long long Requests;
+static unsigned long long Games;
+static unsigned long long Errors;
+static uint64_t           Seed;
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}//end now_ns
+
+
+// ---------------------------------------------------------------------
+// Function
+//     client_send
+// Inputs
+//     c
+//         The player sending the request.
+//     request
+//         The request line, including the trailing '\n'.
+// Outputs
+//     function result
+// Description
+//     This function sends one request and notes the time it was sent.
+//     Requests are tiny, so a short write is treated as a failure. The
+//     result is false if the request couldn't be sent.
+// ---------------------------------------------------------------------
+static bool client_send(struct client_t *c, const char *request)
+{
+    size_t  len = strlen(request);
+    ssize_t sent;
+
+    c->sent_at = now_ns();
+    do {
+        sent = send(c->fd, request, len, MSG_NOSIGNAL);
+    } while ((sent < 0) && (errno == EINTR));
+
+    return (sent == (ssize_t)len);
+
+}//end client_send
+
+
+// ---------------------------------------------------------------------
+// Function
+//     client_start
+// Inputs
+//     c
+//         The player starting a game.
+// Outputs
+//     function result
+// Description
+//     This function asks for a new game, each with a different seed.
+//     The result is false if the request couldn't be sent.
+// ---------------------------------------------------------------------
+static bool client_start(struct client_t *c)
+{
+    char request[MAX_REQUEST];
+
+    c->turn = 1;
+    c->roll = 1;
+    snprintf(request, sizeof(request), "N %llu\n",
+             (unsigned long long)Seed++);
+
+    return client_send(c, request);
+
+}//end client_start
+
+
+// ---------------------------------------------------------------------
+// Function
+//     client_next
+// Inputs
+//     c
+//         The player whose request was just answered.
+// Outputs
+//     function result
+// Description
+//     This function decides on and sends the player's next request.
+//     The result is false once the player has no more games to play.
+// ---------------------------------------------------------------------
+static bool client_next(struct client_t *c)
+{
+    char request[MAX_REQUEST];
+
+    if (c->turn > MAX_TURNS) {
+        // The last game just ended
+        ++Games;
+        if (--c->games_left == 0) {
+            client_send(c, "Q\n");
+            return false;
+        }
+        return client_start(c);
+    } else if (c->roll < MAX_ROLLS) {
+        ++c->roll;
+        snprintf(request, sizeof(request), "R\n");
+    } else {
+        snprintf(request, sizeof(request), "S %u\n", c->turn);
+        ++c->turn;
+        c->roll = 1;
+    }
+
+    return client_send(c, request);
+
+}//end client_next
+
+
+// ---------------------------------------------------------------------
+// Function
+//     client_connect
+// Inputs
+//     path
+//         Where the server's Unix-domain socket is.
+// Outputs
+//     function result
+// Description
+//     This function opens a connection to the server, returning the
+//     socket or -1 if the server can't be reached.
+// ---------------------------------------------------------------------
+static int client_connect(const char *path)
+{
+    struct sockaddr_un addr;
+    int                fd;
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+
+}//end client_connect
+
+
+// ---------------------------------------------------------------------
+// Function
+//     percentile
+// Inputs
+//     fraction
+//         Which percentile, as a fraction (0.99 for p99).
+// Outputs
+//     function result
+// Description
+//     This function returns the request latency in microseconds that
+//     the given fraction of requests came in under.
+// ---------------------------------------------------------------------
+static unsigned int percentile(const double fraction)
+{
+    unsigned long long target = (unsigned long long)(Requests * fraction);
+    unsigned long long seen = 0;
+
+    for (unsigned int i = 0; i <= LATENCY_BUCKETS; ++i) {
+        seen += Latency[i];
+        if (seen > target) {
+            return i;
+        }
+    }
+
+    return LATENCY_BUCKETS;
+
+}//end percentile
+
+
+// **************************************************************************
+// *********************************  MAIN **********************************
+// **************************************************************************
+int main(int argc, char *argv[])
+{
+    const char        *path = DEFAULT_SOCKET;
+    int                connections = DEFAULT_CONNECTIONS;
+    int                games = DEFAULT_GAMES;
+    int                active = 0;
+    int                epfd;
+    int                count;
+    int                opt;
+    struct client_t   *clients;
+    struct client_t   *c;
+    struct epoll_event ev;
+    struct epoll_event events[MAX_EVENTS];
+    uint64_t           start;
+    uint64_t           usec;
+    double             seconds;
+    ssize_t            got;
+    char              *newline;
+
+    while ((opt = getopt(argc, argv, "s:c:g:")) != -1) {
+        if (opt == 's') {
+            path = optarg;
+        } else if (opt == 'c') {
+            connections = atoi(optarg);
+        } else if (opt == 'g') {
+            games = atoi(optarg);
+        } else {
+            fprintf(stderr, "Syntax: %s [-s socket_path] [-c connections] "
+                    "[-g games]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if ((connections < 1) || (games < 1)) {
+        fprintf(stderr, "Error: connections and games must be positive\n");
+        return EXIT_FAILURE;
+    }
+
+    clients = calloc(connections, sizeof(*clients));
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if ((clients == NULL) || (epfd < 0)) {
+        perror("setup");
+        return EXIT_FAILURE;
+    }
+
+    // Connect everyone and start their first game
+    start = now_ns();
+    for (int i = 0; i < connections; ++i) {
+        c = &clients[i];
+        c->fd = client_connect(path);
+        if (c->fd < 0) {
+            perror(path);
+            return EXIT_FAILURE;
+        }
+        c->games_left = games;
+        ev.events   = EPOLLIN;
+        ev.data.ptr = c;
+        epoll_ctl(epfd, EPOLL_CTL_ADD, c->fd, &ev);
+        if (client_start(c)) {
+            ++active;
+        }
+    }
+
+    // Answer each reply with the next request until all games are done
+    while (active > 0) {
+        count = epoll_wait(epfd, events, MAX_EVENTS, -1);
+        for (int i = 0; i < count; ++i) {
+            c = events[i].data.ptr;
+            got = recv(c->fd, c->in + c->in_len, IN_SIZE - c->in_len, 0);
+            if (got <= 0) {
+                if ((got < 0) && (errno == EINTR)) {
+                    continue;
+                }
+                close(c->fd);
+                --active;
+                ++Errors;
+                continue;
+            }
+            c->in_len += got;
+
+            newline = memchr(c->in, '\n', c->in_len);
+            if (newline == NULL) {
+                continue;
+            }
+
+            usec = (now_ns() - c->sent_at) / NSEC_PER_USEC;
+            ++Latency[(usec < LATENCY_BUCKETS) ? usec : LATENCY_BUCKETS];
+            ++Requests;
+            if (strncmp(c->in, "ERR", 3) == 0) {
+                ++Errors;
+            }
+            c->in_len = 0;
+
+            if (!client_next(c)) {
+                close(c->fd);
+                --active;
+            }
+        }
+    }
+    seconds = (now_ns() - start) / (USEC_PER_SEC * NSEC_PER_USEC);
+
+    printf("%llu games, %llu requests, %llu errors in %.3f s\n",
+           Games, Requests, Errors, seconds);
+    printf("%.0f sessions/sec, %.0f requests/sec\n",
+           Games / seconds, Requests / seconds);
+    printf("latency p50 %u us, p99 %u us, p99.9 %u us\n",
+           percentile(0.50), percentile(0.99), percentile(0.999));
+
+    free(clients);
+    close(epfd);
+
+    return (Errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+} // end main
+
+// end loadgen.c
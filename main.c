@@ -4,12 +4,24 @@
 // Name: Al Shaffer & Marshall Liu
 //
 // Description: This is the main program for a simple Yahtzee game.
+//     With -x, a finished game (one that wasn't quit) is also appended
+//     to a columnar binary file for analytics; -p bit-packs it. With
+//     -l, the game's every action is appended to a text log, under the
+//     player's name (-n, or the login name), for yahtzee_regret to
+//     look at how it was played.
 //
-// Syntax: ./yahtzee [any other user inputs are ignored]
+// Syntax: ./yahtzee [-x export_file [-p]] [-l log_file [-n player]]
 // ----------------------------------------------------------------------
 
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
 #include "play.h"
+#include "game.h"
+#include "export.h"
+#include "gamelog.h"
 #include "screen.h"
 #include "score.h"
 
@@ -17,8 +29,42 @@
 // **************************************************************************
 // *********************************  MAIN **********************************
 // **************************************************************************
-int main(void)
+int main(int argc, char *argv[])
 {
+    const char      *export_path = NULL;
+    const char      *log_path = NULL;
+    const char      *player = getenv("USER");
+    bool             packed = false;
+    struct export_t *out;
+    const struct game_action_t *actions;
+    FILE            *log;
+    int              count;
+    int              opt;
+
+    while ((opt = getopt(argc, argv, "x:pl:n:")) != -1) {
+        if (opt == 'x') {
+            export_path = optarg;
+        } else if (opt == 'p') {
+            packed = true;
+        } else if (opt == 'l') {
+            log_path = optarg;
+        } else if (opt == 'n') {
+            player = optarg;
+        } else {
+            fprintf(stderr, "Syntax: %s [-x export_file [-p]] "
+                    "[-l log_file [-n player]]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if ((player == NULL) || (player[0] == '\0')) {
+        player = "player";
+    }
+    if ((strlen(player) > GAMELOG_MAX_PLAYER) ||
+        (strpbrk(player, " \t\r\n") != NULL)) {
+        fprintf(stderr, "Error: the player's name must be one word of at "
+                "most %i characters\n", GAMELOG_MAX_PLAYER);
+        return EXIT_FAILURE;
+    }
 
     // Initialize the screen module
     screen_init();
@@ -35,6 +81,30 @@ int main(void)
     // Display the final score sheet
     score_display_final();
 
+    // Save the game if it was played to the end
+    if ((export_path != NULL) && !play_game()->quit) {
+        out = export_open(export_path, packed);
+        if ((out == NULL) ||
+            (export_append(out, play_game()) != SUCCESS) ||
+            (export_close(out) != SUCCESS)) {
+            perror(export_path);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Log how it was played, if it was played to the end
+    count = play_actions(&actions);
+    if ((log_path != NULL) && !play_game()->quit && (count >= 0)) {
+        log = fopen(log_path, "a");
+        if ((log == NULL) ||
+            (gamelog_write(log, player, play_game()->seed, actions,
+                           count) != SUCCESS) ||
+            (fclose(log) != 0)) {
+            perror(log_path);
+            return EXIT_FAILURE;
+        }
+    }
+
     return EXIT_SUCCESS;
 
 } // end main
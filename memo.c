@@ -0,0 +1,791 @@
+// ----------------------------------------------------------------------
+// File: memo.c
+//
+// Name: Al Shaffer & Marshall Liu
+//
+// Description: This MEMO module gives hints for the most points
+//     without a solved table. A scorecard's value comes from the values
+//     of the scorecards one item fuller that its turn can reach, so
+//     values are worked out only as a game needs them, each from the
+//     ones after it, and kept in a cache.
+//
+//     The cache is a hash table of buckets of MEMO_WAYS entries, one
+//     cache line each. A value is only ever kept in its own bucket, so
+//     a full bucket evicts one of its own entries, picked by a clock:
+//     the bucket's hand sweeps its entries, giving each one used since
+//     the last sweep another chance.
+//
+//     When a turn needs values that aren't in the cache, they're filled
+//     in bottom up, without recursion: every scorecard the turn can
+//     lead to, a layer of cards at a time (the cards with the same
+//     number of items used), from the full card back to the layer
+//     after the turn's. Each layer is worked out from the one after
+//     it, which is held in one of two layer buffers outside the cache,
+//     so a value evicted during a fill is never needed again by it,
+//     and a fill takes the same time however small the cache is. Every
+//     value worked out is kept in the cache as well, so that later
+//     turns find theirs there; with too small a cache a later turn
+//     has to fill again from its own scorecard, which is quicker the
+//     fuller the scorecard. The first hint of a game fills every
+//     scorecard a game can reach (524,350 of them). At under 3/4 full
+//     that takes 131,072 buckets, 8.5 MB, so with the 1.4 MB of layer
+//     buffers a 10 MB cache keeps all but the few that overflow their
+//     buckets. The cache never grows past that.
+//
+//     Working values out can be given up part way, from another thread,
+//     with memo->cancel. A value is only kept once everything it came
+//     from was worked out before the cancel, so the cache stays right.
+// ----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "score.h"
+#include "rules.h"
+#include "game.h"
+#include "solver.h"
+#include "memo.h"
+
+#define USED_BIT    0x80000000u     // In a key, used since the hand passed
+#define STATE_BITS  0x7FFFFFFFu
+#define HASH_FACTOR 0x9E3779B1u     // 2^32 / golden ratio
+#define FULL_MASK   (SOLVER_MASKS - 1)
+#define UPPER_SCORES (NUMBER_OF_DICE + 1)   // 0 thru 5 of a face
+#define MOST_LOAD    3                      // Grow the cache until every
+#define MOST_LOAD_OF 4                      // scorecard fills under 3/4
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     bucket_of
+// Inputs
+//     memo
+//         The cache.
+//     state
+//         A scorecard.
+// Outputs
+//     function result
+// Description
+//     Returns the number of the scorecard's bucket.
+// ---------------------------------------------------------------------
+static unsigned int bucket_of(const struct memo_t *memo, const int state)
+{
+    uint32_t hash = (uint32_t)state * HASH_FACTOR;
+
+    return (hash ^ (hash >> 16)) & (memo->buckets - 1);
+
+}//end bucket_of
+
+
+// ---------------------------------------------------------------------
+// Function
+//     find
+// Inputs
+//     memo
+//         The cache.
+//     state
+//         A scorecard.
+//     value
+//         Where to put its value.
+// Outputs
+//     function result
+// Description
+//     This function looks the scorecard up, returning false if it
+//     isn't in the cache.
+// ---------------------------------------------------------------------
+static bool find(struct memo_t *memo, const int state, float *value)
+{
+    struct memo_bucket_t *b = &memo->bucket[bucket_of(memo, state)];
+
+    for (int w = 0; w < MEMO_WAYS; ++w) {
+        if ((b->key[w] & STATE_BITS) == (uint32_t)state + 1) {
+            b->key[w] |= USED_BIT;
+            *value = b->value[w];
+            return true;
+        }
+    }
+
+    return false;
+
+}//end find
+
+
+// ---------------------------------------------------------------------
+// Function
+//     insert
+// Inputs
+//     memo
+//         The cache.
+//     state
+//         A scorecard that isn't in the cache.
+//     value
+//         Its value.
+// Outputs
+//     none
+// Description
+//     This function puts the value in the cache, in an empty entry of
+//     its bucket if there is one, or else in place of the first entry
+//     the clock hand finds that hasn't been used since it last passed.
+// ---------------------------------------------------------------------
+static void insert(struct memo_t *memo, const int state, const float value)
+{
+    unsigned int          n = bucket_of(memo, state);
+    struct memo_bucket_t *b = &memo->bucket[n];
+    int                   w;
+
+    for (w = 0; w < MEMO_WAYS; ++w) {
+        if (b->key[w] == 0) {
+            break;
+        }
+    }
+    if (w == MEMO_WAYS) {
+        while (b->key[memo->hand[n]] & USED_BIT) {
+            b->key[memo->hand[n]] &= ~USED_BIT;
+            memo->hand[n] = (memo->hand[n] + 1) % MEMO_WAYS;
+        }
+        w = memo->hand[n];
+        memo->hand[n] = (memo->hand[n] + 1) % MEMO_WAYS;
+        ++memo->evictions;
+    }
+    b->key[w]   = ((uint32_t)state + 1) | USED_BIT;
+    b->value[w] = value;
+
+}//end insert
+
+
+// ---------------------------------------------------------------------
+// Function
+//     cancelled
+// Inputs
+//     memo
+//         The cache.
+// Outputs
+//     function result
+// Description
+//     Returns whether working out values has been given up on.
+// ---------------------------------------------------------------------
+static bool cancelled(const struct memo_t *memo)
+{
+    return (memo->cancel != NULL) &&
+           __atomic_load_n(memo->cancel, __ATOMIC_RELAXED);
+}//end cancelled
+
+
+// ---------------------------------------------------------------------
+// Function
+//     layer_cards
+// Inputs
+//     none
+// Outputs
+//     function result
+// Description
+//     Returns the most cards any layer has, for the size of a layer
+//     buffer.
+// ---------------------------------------------------------------------
+static unsigned int layer_cards(void)
+{
+    unsigned int cards[NUMBER_OF_CATEGORIES + 1] = { 0 };
+    unsigned int most = 0;
+
+    for (unsigned int card = 0; card < SOLVER_CARDS; ++card) {
+        ++cards[__builtin_popcount(solver_card_mask(card))];
+    }
+    for (int used = 0; used <= NUMBER_OF_CATEGORIES; ++used) {
+        if (cards[used] > most) {
+            most = cards[used];
+        }
+    }
+
+    return most;
+
+}//end layer_cards
+
+
+// ---------------------------------------------------------------------
+// Function
+//     reachable_states
+// Inputs
+//     none
+// Outputs
+//     function result
+// Description
+//     Returns how many scorecards a game can reach that have a value
+//     to keep, all but the full ones.
+// ---------------------------------------------------------------------
+static unsigned int reachable_states(void)
+{
+    unsigned int mask;
+    unsigned int count = 0;
+
+    for (unsigned int card = 0; card < SOLVER_CARDS; ++card) {
+        mask = solver_card_mask(card);
+        if (mask == FULL_MASK) {
+            continue;
+        } else if ((mask & SOLVER_UPPER_BITS) == SOLVER_UPPER_BITS) {
+            ++count;
+            continue;
+        }
+        for (int u = 0; u < SOLVER_UPPER; ++u) {
+            count += solver_reachable(mask, u);
+        }
+    }
+
+    return count;
+
+}//end reachable_states
+
+
+// ---------------------------------------------------------------------
+// Function
+//     fixed_bytes
+// Inputs
+//     none
+// Outputs
+//     function result
+// Description
+//     Returns the memory a cache takes besides its buckets: the two
+//     layer buffers and the cards' rows in them.
+// ---------------------------------------------------------------------
+static size_t fixed_bytes(void)
+{
+    return 2 * layer_cards() * SOLVER_UPPER * sizeof(float) +
+           SOLVER_CARDS * sizeof(unsigned short);
+}//end fixed_bytes
+
+
+// ---------------------------------------------------------------------
+// Function
+//     reachable_cards
+// Inputs
+//     card
+//         The card at the start of a turn.
+//     mask
+//         Items used, including all of the card's.
+//     cards
+//         Where to put the cards.
+// Outputs
+//     function result
+// Description
+//     This function finds the cards with the mask that the card can
+//     lead to, and returns how many there are (1 or 2). With YAHTZEE
+//     used only since the card, it could have been scored 50 or 0.
+// ---------------------------------------------------------------------
+static int reachable_cards(const unsigned int card, const unsigned int mask,
+                           unsigned int cards[])
+{
+    if (!(mask & SOLVER_YAHTZEE_BIT)) {
+        cards[0] = mask;
+        return 1;
+    } else if (solver_card_mask(card) & SOLVER_YAHTZEE_BIT) {
+        cards[0] = solver_card(mask, card >= SOLVER_MASKS);
+        return 1;
+    }
+    cards[0] = solver_card(mask, false);
+    cards[1] = solver_card(mask, true);
+
+    return 2;
+
+}//end reachable_cards
+
+
+// ---------------------------------------------------------------------
+// Function
+//     fill_card
+// Inputs
+//     memo
+//         The cache, filling.
+//     card
+//         A card the turn being filled for can lead to.
+//     upper
+//         That turn's upper total; the card's can't be lower.
+//     out
+//         Where to put the card's values, by upper total.
+//     after
+//         The layer after the card's, filled.
+// Outputs
+//     none
+// Description
+//     This function works out the card's values at every upper total
+//     it can have, taking them from the cache where they're already
+//     there, and keeping the rest in it.
+// ---------------------------------------------------------------------
+static void fill_card(struct memo_t *memo, const unsigned int card,
+                      const int upper, float out[], const float after[])
+{
+    unsigned int mask = solver_card_mask(card);
+    const float *next[NUMBER_OF_CATEGORIES + 1];
+    int          first = upper;
+    int          last = SOLVER_UPPER - 1;
+    int          s;
+
+    if (mask == FULL_MASK) {
+        out[0] = 0;
+        return;
+    }
+    for (int item = ACES; item <= CHANCE; ++item) {
+        if (!(mask & (1u << (item - ACES)))) {
+            next[item] = after + memo->slot[solver_card_after(card, item,
+                                            SCORE_YAHTZEE)] * SOLVER_UPPER;
+        }
+    }
+    if (!(mask & SOLVER_YAHTZEE_BIT)) {
+        next[SOLVER_ZERO_ROW] = after + memo->slot[solver_card_after(card,
+                                        YAHTZEE, 0)] * SOLVER_UPPER;
+    }
+
+    // Once every upper item is used, the upper total doesn't matter
+    if ((mask & SOLVER_UPPER_BITS) == SOLVER_UPPER_BITS) {
+        first = last = 0;
+    }
+    for (int u = first; u <= last; ++u) {
+        s = solver_state(card, u);
+        if ((last > 0) && !solver_reachable(mask, u)) {
+            continue;
+        } else if (find(memo, s, &out[u])) {
+            ++memo->hits;
+            continue;
+        }
+        solver_turn_rows(next, s, &memo->turn);
+        out[u] = memo->turn.keep[0][0];
+        insert(memo, s, out[u]);
+        ++memo->misses;
+    }
+
+}//end fill_card
+
+
+// ---------------------------------------------------------------------
+// Function
+//     fill
+// Inputs
+//     memo
+//         The cache.
+//     state
+//         The scorecard at the start of a turn.
+// Outputs
+//     function result
+// Description
+//     This function works out the values of every scorecard the turn
+//     can lead to, a layer at a time from the full card back, and
+//     leaves the layer after the turn's in memo->layer. It returns
+//     false if it was cancelled, when no layer can be trusted.
+// ---------------------------------------------------------------------
+static bool fill(struct memo_t *memo, const int state)
+{
+    unsigned int card = state / SOLVER_UPPER;
+    unsigned int mask = solver_card_mask(card);
+    unsigned int open = FULL_MASK & ~mask;
+    int          used = __builtin_popcount(mask);
+    unsigned int cards[2];
+    unsigned int sub;
+    float       *out;
+    int          count;
+    int          n;
+
+    memo->filled = -1;
+    for (int layer = NUMBER_OF_CATEGORIES; layer > used; --layer) {
+        out = memo->layer[layer & 1];
+        n   = 0;
+
+        // Every way to use layer - used more of the open items
+        for (sub = open; ; sub = (sub - 1) & open) {
+            if (__builtin_popcount(sub) == layer - used) {
+                count = reachable_cards(card, mask | sub, cards);
+                for (int c = 0; c < count; ++c) {
+                    if (cancelled(memo)) {
+                        return false;
+                    }
+                    memo->slot[cards[c]] = n;
+                    fill_card(memo, cards[c], state % SOLVER_UPPER,
+                              out + n * SOLVER_UPPER,
+                              memo->layer[(layer + 1) & 1]);
+                    ++n;
+                }
+            }
+            if (sub == 0) {
+                break;
+            }
+        }
+    }
+    memo->filled = state;
+
+    return true;
+
+}//end fill
+
+
+// ---------------------------------------------------------------------
+// Function
+//     next_value
+// Inputs
+//     memo
+//         The cache.
+//     state
+//         The scorecard at the start of a turn.
+//     next
+//         A scorecard the turn can reach.
+//     missing
+//         Set if the value isn't to be had.
+// Outputs
+//     function result
+// Description
+//     Returns the next scorecard's value, from the layer filled for
+//     the turn if there is one, or else from the cache.
+// ---------------------------------------------------------------------
+static float next_value(struct memo_t *memo, const int state, const int next,
+                        bool *missing)
+{
+    unsigned int card = next / SOLVER_UPPER;
+    unsigned int mask = solver_card_mask(card);
+    const float *after = memo->layer[__builtin_popcount(mask) & 1];
+    float        value;
+
+    if (mask == FULL_MASK) {
+        return 0;
+    } else if (memo->filled == state) {
+        return after[memo->slot[card] * SOLVER_UPPER + next % SOLVER_UPPER];
+    } else if (find(memo, next, &value)) {
+        ++memo->hits;
+        return value;
+    }
+    *missing = true;
+
+    return 0;
+
+}//end next_value
+
+
+// ---------------------------------------------------------------------
+// Function
+//     collect_rows
+// Inputs
+//     memo
+//         The cache.
+//     state
+//         The scorecard at the start of a turn.
+//     rows
+//         Room for a row of values for each item.
+//     next
+//         Where to put the rows, as for solver_rows().
+//     missing
+//         Set if any of the values aren't to be had (they're 0).
+// Outputs
+//     none
+// Description
+//     This function fills in the values a turn needs: for each item
+//     not used yet, the scorecards with it used that the turn can
+//     reach. Only those entries of the rows are filled in.
+// ---------------------------------------------------------------------
+static void collect_rows(struct memo_t *memo, const int state,
+                         float rows[][SOLVER_UPPER], const float *next[],
+                         bool *missing)
+{
+    unsigned int card = state / SOLVER_UPPER;
+    unsigned int mask = solver_card_mask(card);
+    int          upper = state % SOLVER_UPPER;
+    unsigned int after;
+    int          scores;
+    int          s;
+
+    for (int item = ACES; item <= CHANCE; ++item) {
+        if (mask & (1u << (item - ACES))) {
+            continue;
+        }
+
+        // Only the upper items move the upper total
+        after  = solver_card_after(card, item, SCORE_YAHTZEE);
+        scores = (item <= SIXES) ? UPPER_SCORES : 1;
+        for (int k = 0; k < scores; ++k) {
+            s = solver_state(after, solver_upper_after(upper, item, k * item));
+            rows[item][s - (int)(after * SOLVER_UPPER)] =
+                next_value(memo, state, s, missing);
+        }
+        next[item] = rows[item];
+    }
+
+    // YAHTZEE scored 0 leads to a card of its own
+    if (!(mask & SOLVER_YAHTZEE_BIT)) {
+        after = solver_card_after(card, YAHTZEE, 0);
+        s     = solver_state(after, upper);
+        rows[SOLVER_ZERO_ROW][s - (int)(after * SOLVER_UPPER)] =
+            next_value(memo, state, s, missing);
+        next[SOLVER_ZERO_ROW] = rows[SOLVER_ZERO_ROW];
+    }
+
+}//end collect_rows
+
+
+// ---------------------------------------------------------------------
+// Function
+//     next_rows
+// Inputs
+//     memo
+//         The cache.
+//     state
+//         The scorecard at the start of a turn.
+//     rows
+//         Room for a row of values for each item.
+//     next
+//         Where to put the rows, as for solver_rows().
+// Outputs
+//     none
+// Description
+//     This function is collect_rows(), filling in the values after the
+//     turn first if the cache doesn't have them all. If the fill is
+//     cancelled, the values that weren't in the cache come back as 0.
+// ---------------------------------------------------------------------
+static void next_rows(struct memo_t *memo, const int state,
+                      float rows[][SOLVER_UPPER], const float *next[])
+{
+    bool missing = false;
+
+    collect_rows(memo, state, rows, next, &missing);
+    if (missing && !cancelled(memo) && fill(memo, state)) {
+        collect_rows(memo, state, rows, next, &missing);
+    }
+
+}//end next_rows
+
+
+// ************************************************************************
+// *************************  EXTERNAL FUNCTIONS **************************
+// ************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     memo_new
+// Inputs
+//     bytes
+//         The most memory the cache may take.
+// Outputs
+//     function result
+// Description
+//     This function makes an empty cache (to be freed with
+//     memo_free()), as big as fits in the memory given, after the
+//     layer buffers, but at least one bucket. It grows no bigger than
+//     it takes to hold every scorecard a game reaches at under
+//     MOST_LOAD / MOST_LOAD_OF full. It returns NULL if there's no
+//     memory for it.
+// ---------------------------------------------------------------------
+struct memo_t *memo_new(const size_t bytes)
+{
+    struct memo_t *memo = calloc(1, sizeof(*memo));
+    size_t         per_bucket = sizeof(struct memo_bucket_t) + 1;
+    size_t         layer_bytes = layer_cards() * SOLVER_UPPER * sizeof(float);
+    size_t         states = reachable_states();
+
+    if (memo == NULL) {
+        return NULL;
+    }
+    memo->buckets = 1;
+    while ((fixed_bytes() + memo->buckets * 2 * per_bucket <= bytes) &&
+           (memo->buckets * MEMO_WAYS * MOST_LOAD <
+            states * MOST_LOAD_OF)) {
+        memo->buckets *= 2;
+    }
+    memo->turn.state = -1;
+    memo->filled     = -1;
+    memo->bucket = aligned_alloc(sizeof(struct memo_bucket_t),
+                                 memo->buckets * sizeof(struct memo_bucket_t));
+    memo->hand     = calloc(memo->buckets, 1);
+    memo->layer[0] = malloc(layer_bytes);
+    memo->layer[1] = malloc(layer_bytes);
+    memo->slot     = calloc(SOLVER_CARDS, sizeof(unsigned short));
+    if ((memo->bucket == NULL) || (memo->hand == NULL) ||
+        (memo->layer[0] == NULL) || (memo->layer[1] == NULL) ||
+        (memo->slot == NULL)) {
+        memo_free(memo);
+        return NULL;
+    }
+    memset(memo->bucket, 0, memo->buckets * sizeof(struct memo_bucket_t));
+
+    return memo;
+
+}//end memo_new
+
+
+// ---------------------------------------------------------------------
+// Function
+//     memo_free
+// Inputs
+//     memo
+//         A cache, or NULL.
+// Outputs
+//     none
+// Description
+//     This function frees the cache.
+// ---------------------------------------------------------------------
+void memo_free(struct memo_t *memo)
+{
+    if (memo != NULL) {
+        free(memo->bucket);
+        free(memo->hand);
+        free(memo->layer[0]);
+        free(memo->layer[1]);
+        free(memo->slot);
+        free(memo);
+    }
+
+}//end memo_free
+
+
+// ---------------------------------------------------------------------
+// Function
+//     memo_bytes
+// Inputs
+//     memo
+//         The cache.
+// Outputs
+//     function result
+// Description
+//     Returns how much memory the cache takes, its entries and the
+//     layer buffers.
+// ---------------------------------------------------------------------
+size_t memo_bytes(const struct memo_t *memo)
+{
+    return fixed_bytes() + memo->buckets * (sizeof(struct memo_bucket_t) + 1);
+}//end memo_bytes
+
+
+// ---------------------------------------------------------------------
+// Function
+//     memo_value
+// Inputs
+//     memo
+//         The cache.
+//     state
+//         A scorecard a game can reach, from solver_state().
+// Outputs
+//     function result
+// Description
+//     Returns the scorecard's value, the points still to come from the
+//     start of a turn with the best play, working it out (and filling
+//     in the values it needs) if it isn't in the cache. Once it's been
+//     cancelled, values that aren't in the cache come back as 0, and
+//     nothing more is kept.
+// ---------------------------------------------------------------------
+float memo_value(struct memo_t *memo, const int state)
+{
+    float        rows[NUMBER_OF_CATEGORIES + 1][SOLVER_UPPER];
+    const float *next[NUMBER_OF_CATEGORIES + 1];
+    float        value;
+
+    if (solver_card_mask(state / SOLVER_UPPER) == FULL_MASK) {
+        return 0;
+    } else if (find(memo, state, &value)) {
+        ++memo->hits;
+        return value;
+    } else if (cancelled(memo)) {
+        return 0;
+    }
+
+    // The turn is only used once every value after it is known
+    next_rows(memo, state, rows, next);
+    if (cancelled(memo)) {
+        return 0;
+    }
+    solver_turn_rows(next, state, &memo->turn);
+    value = memo->turn.keep[0][0];
+    insert(memo, state, value);
+    ++memo->misses;
+
+    return value;
+
+}//end memo_value
+
+
+// ---------------------------------------------------------------------
+// Function
+//     memo_rows
+// Inputs
+//     memo
+//         The cache.
+//     state
+//         The scorecard at the start of a turn.
+//     rows
+//         Room for a row of values for each item.
+//     next
+//         Where to put the rows, as for solver_rows().
+// Outputs
+//     none
+// Description
+//     This function is evtable_rows(), with the values from the cache.
+//     Only the entries of the rows the turn can reach are filled in.
+// ---------------------------------------------------------------------
+void memo_rows(struct memo_t *memo, const int state,
+               float rows[][SOLVER_UPPER], const float *next[])
+{
+    next_rows(memo, state, rows, next);
+}//end memo_rows
+
+
+// ---------------------------------------------------------------------
+// Function
+//     memo_turn
+// Inputs
+//     memo
+//         The cache.
+//     state
+//         The scorecard at the start of the turn.
+//     turn
+//         Where to put the values for the turn.
+// Outputs
+//     none
+// Description
+//     This function is solver_turn(), with the values from the cache.
+// ---------------------------------------------------------------------
+void memo_turn(struct memo_t *memo, const int state,
+               struct solver_turn_t *turn)
+{
+    float        rows[NUMBER_OF_CATEGORIES + 1][SOLVER_UPPER];
+    const float *next[NUMBER_OF_CATEGORIES + 1];
+
+    next_rows(memo, state, rows, next);
+    solver_turn_rows(next, state, turn);
+
+}//end memo_turn
+
+
+// ---------------------------------------------------------------------
+// Function
+//     memo_choose
+// Inputs
+//     memo
+//         The cache.
+//     game
+//         A game that isn't over.
+//     turn
+//         The values for the game's turn, as for solver_choose().
+// Outputs
+//     function result
+// Description
+//     This function is solver_choose(), with the values from the cache.
+// ---------------------------------------------------------------------
+struct game_action_t memo_choose(struct memo_t *memo, const struct game_t *game,
+                                 struct solver_turn_t *turn)
+{
+    struct game_action_t action = { GAME_SCORE, 0 };
+    int                  state = solver_state_of(game);
+    float                rows[NUMBER_OF_CATEGORIES + 1][SOLVER_UPPER];
+    const float         *next[NUMBER_OF_CATEGORIES + 1];
+
+    if (turn->state != state) {
+        memo_turn(memo, state, turn);
+    }
+    if (solver_keep_action(game, solver_best_keep(turn, game), &action)) {
+        return action;
+    }
+    next_rows(memo, state, rows, next);
+    action.arg = solver_best_item(next, state, solver_roll_of(game->dice));
+
+    return action;
+
+}//end memo_choose
+
+// end memo.c
@@ -0,0 +1,58 @@
+// -------------------------------------------------------------------
+// File: memo.h
+//
+// Name: Marshall Liu
+//
+// Description: This is the header file for the MEMO module, which
+//     works out scorecard values as they're needed, in a cache of
+//     bounded size, instead of solving the whole table up front.
+// -------------------------------------------------------------------
+
+#ifndef MEMO_H
+#define MEMO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "game.h"
+#include "solver.h"
+
+#define MEMO_WAYS 8     // Entries per bucket, a cache line of them
+
+// One cache line of cached values
+struct memo_bucket_t {
+    uint32_t key[MEMO_WAYS];     // State + 1 (0 if empty), and a used bit
+    float    value[MEMO_WAYS];
+};
+
+// A cache of scorecard values, keyed on the items used and the upper
+// total (the state from solver_state())
+struct memo_t {
+    struct memo_bucket_t *bucket;
+    unsigned char        *hand;       // Clock hand, by bucket
+    unsigned int          buckets;    // A power of 2
+    struct solver_turn_t  turn;       // Scratch for working out values
+    float                *layer[2];   // A layer of cards' values, and the
+                                      // one after it, while filling
+    unsigned short       *slot;       // Each card's row in its layer
+    int                   filled;     // The scorecard whose next values
+                                      // are in a layer, or -1
+    uint64_t              hits;
+    uint64_t              misses;     // Values worked out
+    uint64_t              evictions;
+    const int            *cancel;     // Stop working values out while
+                                      // it's set, or NULL
+};
+
+extern struct memo_t *memo_new(const size_t bytes);
+extern void   memo_free(struct memo_t *memo);
+extern size_t memo_bytes(const struct memo_t *memo);
+extern float  memo_value(struct memo_t *memo, const int state);
+extern void   memo_rows(struct memo_t *memo, const int state,
+                        float rows[][SOLVER_UPPER], const float *next[]);
+extern void   memo_turn(struct memo_t *memo, const int state,
+                        struct solver_turn_t *turn);
+extern struct game_action_t memo_choose(struct memo_t *memo,
+                                        const struct game_t *game,
+                                        struct solver_turn_t *turn);
+
+#endif // MEMO_H
@@ -3,11 +3,14 @@
 //
 // Name: Al Shaffer & Marshall Liu
 //
-// Description: This PLAY module defines the rules of game of YAHTZEE,
-//     and interacts with the user to roll dice and select where to put
-//     a score. The one glaring shortcoming (other than the user
-//     interface) is the inability to support the "Joker Rule" where a
-//     user can get more than one Yahtzee in a game.
+// Description: This PLAY module interacts with the user to roll dice
+//     and select where to put a score. The rules themselves are in the
+//     GAME module; this module turns key presses into game actions and
+//     shows the result, including YAHTZEE bonuses and any item the
+//     Joker rule won't let a YAHTZEE be scored in. Every action that
+//     was taken is kept, so the game can be written to a log. Hints
+//     come from the HINT module, which works them out in the
+//     background as the dice are rolled.
 // ----------------------------------------------------------------------
 
 #include <stdio.h>
@@ -21,6 +24,11 @@
 #include <unistd.h>
 #include "screen.h"
 #include "score.h"
+#include "rules.h"
+#include "game.h"
+#include "solver.h"
+#include "gamelog.h"
+#include "hint.h"
 #include "play.h"
 
 #define MAX_INPUT       80
@@ -29,50 +37,81 @@
 #define CHOOSE_DICE_COL 1
 #define MENU_ROW        15
 #define MENU_COL        1
-
-#define NUMBER_OF_DICE       5
-#define NUMBER_OF_SIDES      6
-#define MAX_ROLLS            3
-#define MAX_TURNS            13
-#define MAX_FULLHOUSE_MATCH  3
-#define MIN_FULLHOUSE_MATCH  2
-#define MIN_3KIND_MATCH      3
-#define MIN_4KIND_MATCH      4
-#define MAX_SMSTRAIGHT_MATCH 2
-#define MAX_LGSTRAIGHT_MATCH 1
+#define MAX_HINT        80
+#define TABLE_VARIABLE  "YAHTZEE_TABLE"
+#define MEMO_VARIABLE   "YAHTZEE_MEMO_KB"
+#define MEMO_KB         10240   // Room for every scorecard a game reaches
+#define BYTES_PER_KB    1024
 
 // Menu selections
 #define CHOOSE 'C'
 #define ROLL   'R'
 #define SCORE  'S'
 #define QUIT   'Q'
+#define HINT   'H'
 #define RETURN 'R'
 
 
 // **************************************************************************
-// ****************************  DEFINED TYPES   ****************************
+// **************************** GLOBAL VARIABLES ****************************
 // **************************************************************************
 
-// The structure for tracking a single die
-struct die_t {
-    unsigned char value;     // The value facing up
-    bool          keep;      // Whether to keep or roll
-};
+static struct game_t Game;    // The dice, turn and roll being played
+static uint64_t      Seed;    // The seed for the dice
+static bool          Seeded;  // Whether Seed was picked by the caller
 
+static struct game_action_t Actions[GAMELOG_MAX_ACTIONS]; // Taken so far
+static int                  Num_actions;     // -1 if they didn't fit
 
-// **************************************************************************
-// **************************** GLOBAL VARIABLES ****************************
-// **************************************************************************
-
-static struct die_t Dice[NUMBER_OF_DICE]; // All the dice
-static unsigned int Num_turns;            // # of turns user has taken
-static unsigned int Num_rolls;            // # of rolls the user has taken
+static struct hint_t       *Hints;           // Worked out in the background,
+                                             // for every game
+static struct solver_turn_t Hint_turn = { .state = -1 };
+static char                 Hint[MAX_HINT];  // Shown until the next action
 
 
 // **************************************************************************
 // *************************** INTERNAL FUNCTIONS ***************************
 // **************************************************************************
 
+// ---------------------------------------------------------------------
+// Function
+//     play_action
+// Inputs
+//     type
+//         The GAME_ action the user asked for.
+//     arg
+//         The die or scorecard item the action is about (if any).
+// Outputs
+//     function result
+// Description
+//     This function applies the user's action to the game, returning
+//     what game_step() returned. Actions that were allowed are kept,
+//     for the game's log, and fresh dice are passed on for hints.
+// ---------------------------------------------------------------------
+static int play_action(const int type, const int arg)
+{
+    struct game_action_t action = { type, arg };
+    int                  result;
+
+    Hint[0] = '\0';
+    result = game_step(&Game, action, &Game);
+    if ((result >= 0) && (Num_actions >= 0)) {
+        if (Num_actions < GAMELOG_MAX_ACTIONS) {
+            Actions[Num_actions++] = action;
+        } else {
+            Num_actions = -1;
+        }
+    }
+    if ((result >= 0) && (result & (GAME_EVENT_ROLLED | GAME_EVENT_NEW_TURN)) &&
+        !game_over(&Game) && (Hints != NULL)) {
+        hint_ahead(Hints, &Game);
+    }
+
+    return result;
+
+}//end play_action
+
+
 // ---------------------------------------------------------------------
 // Function
 //     show_dice
@@ -93,16 +132,16 @@ static void show_dice()
     // First show the selected dice (if any) not to be rolled
     screen_text_color(BLACK_TEXT);
     for (i = 0; i < NUMBER_OF_DICE; ++i) {
-        if (Dice[i].keep) {
-            printf("%i ", Dice[i].value);
+        if (Game.keep & (1u << i)) {
+            printf("%i ", Game.dice[i]);
         }
     }
 
     // Now show the dice that will be rolled (if any)
     screen_text_color(WHITE_TEXT);
     for (i = 0; i < NUMBER_OF_DICE; ++i) {
-        if (!(Dice[i].keep)) {
-            printf("%i ", Dice[i].value);
+        if (!(Game.keep & (1u << i))) {
+            printf("%i ", Game.dice[i]);
         }
     }
     fflush(stdout);
@@ -123,132 +162,66 @@ static void show_dice()
 static void display_menu(void)
 {
     screen_cursor(MENU_ROW, MENU_COL);
-    printf("Turn %u out of %u\n", Num_turns, MAX_TURNS);
-    printf("Roll %u out of %u\n\n", Num_rolls, MAX_ROLLS);
+    printf("Turn %u out of %u\n", Game.turn, MAX_TURNS);
+    printf("Roll %u out of %u\n\n", Game.roll, MAX_ROLLS);
     printf("Menu: %c = Choose the dice to keep or roll\n", CHOOSE);
     printf("      %c = Roll the dice\n", ROLL);
     printf("      %c = Enter a score\n", SCORE);
+    printf("      %c = Hint\n", HINT);
     printf("      %c = Quit\n", QUIT);
-
-}//end display_menu
-
-
-// ---------------------------------------------------------------------
-// Function
-//     how_many_of
-// Inputs
-//     die
-//         This is the die value to be searched for.
-// Outputs
-//     function result
-// Description
-//     The function counts the number of die that have the input die
-//     "face up", and returns the number found. For example, if the
-//     current dice are "3 4 5 5 1", and the input is 5, this function
-//     will return 2.
-// ---------------------------------------------------------------------
-static int how_many_of(const int die)
-{
-    int count = 0;
-
-    for (int i=0; i < NUMBER_OF_DICE; ++i) {
-        if (Dice[i].value == die) {
-            ++count;
-        }
+    if (Hint[0] != '\0') {
+        printf("\n%s\n", Hint);
     }
 
-    return count;
-
-}//end how_many_of
+}//end display_menu
 
 
 // ---------------------------------------------------------------------
 // Function
-//     total_of_dice
+//     make_hint
 // Inputs
 //     none
 // Outputs
-//     Function result
+//     none
 // Description
-//     This function looks at all the "face up" values of each die and
-//     returns their current total.
+//     This function gets the best play for the most points from the
+//     HINT worker, and puts it in Hint for the menu to show. It's
+//     usually worked out already; if not, this waits for it.
 // ---------------------------------------------------------------------
-static int total_of_dice(void)
+static void make_hint(void)
 {
-    int score = 0;
+    int          item = -1;
+    int          keep;
+    unsigned int dice;
+    int          used;
 
-    for (int i=0; i < NUMBER_OF_DICE; ++i) {
-        score += Dice[i].value;
+    if (Hints != NULL) {
+        item = hint_turn(Hints, &Game, &Hint_turn);
     }
-
-    return score;
-
-}//end total_of_dice
-
-
-// ---------------------------------------------------------------------
-// Function
-//     max_dice_matching
-// Inputs
-//     none
-// Outputs
-//     function result
-// Description
-//     This function determines the highest number of matching die. For
-//     example, if the dice were "4 2 1 4 4", the result would be 3.
-// ---------------------------------------------------------------------
-static int max_dice_matching(void)
-{
-    int count;
-    int max = 0;
-
-    // We'll look at each value and see how many of each we've got
-    for (int i=ACES; i <= NUMBER_OF_SIDES; ++i) {
-        count = 0;
-        for (int j=0; j < NUMBER_OF_DICE; ++j) {
-            if (Dice[j].value == i) {
-                ++count;
-            }
-        }
-        if (count > max) {
-            max = count;
-        }
+    if (item < 0) {
+        snprintf(Hint, sizeof(Hint), "Hint: no memory for hints");
+        return;
     }
 
-    return max;
-
-}//end max_dice_matching
-
+    keep = solver_best_keep(&Hint_turn, &Game);
+    if (keep == SOLVER_FIRST_ROLL + solver_roll_of(Game.dice)) {
+        snprintf(Hint, sizeof(Hint), "Hint: score item %i", item);
+        return;
+    }
 
-// ---------------------------------------------------------------------
-// Function
-//     is_full_house
-// Inputs
-//     none
-// Outputs
-//     function result
-// Description
-//     This function determins whether the current dice values represent
-//     a full house (or not), returning true or false.
-// ---------------------------------------------------------------------
-static bool is_full_house(void)
-{
-    bool result = false;
-
-    // If we have a 3-of-a-kind, then verify other dice are 2-of-a-kind
-    if (max_dice_matching() == MAX_FULLHOUSE_MATCH) {
-        // Is there a two-of-a-kind?
-        for (int number=1; number <= NUMBER_OF_SIDES; ++number) {
-            if (how_many_of(number) == MIN_FULLHOUSE_MATCH) {
-                result = true;
-                break;
-            }
+    dice = solver_keep_dice(Game.dice, keep);
+    used = snprintf(Hint, sizeof(Hint), "Hint: %s", dice ? "keep" : "roll all");
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        if (dice & (1u << i)) {
+            used += snprintf(Hint + used, sizeof(Hint) - used, " %i",
+                             Game.dice[i]);
         }
     }
+    if (dice) {
+        snprintf(Hint + used, sizeof(Hint) - used, " and roll");
+    }
 
-    return result;
-
-}//end is_full_house
+}//end make_hint
 
 
 // ---------------------------------------------------------------------
@@ -268,8 +241,7 @@ static bool is_full_house(void)
 static void assign_score(void)
 {
     int  item;
-    int  score;
-    int  result = SUCCESS;
+    int  result;
     char input[MAX_INPUT];
     char *last_char = NULL;
 
@@ -282,11 +254,23 @@ static void assign_score(void)
             score_display();
             printf("\nDice: ");
             show_dice();
+            if (Hint[0] != '\0') {
+                printf("\n\n%s", Hint);
+            }
 
             // Prompt the user to pick an item in the score card
-            printf("\n\nSelect the item number to place your score: ");
+            printf("\n\nSelect the item number to place your score "
+                   "(%c for a hint): ", HINT);
             fflush(stdout);
-            fgets(input, MAX_INPUT, stdin);
+            if (fgets(input, MAX_INPUT, stdin) == NULL) {
+                // There's no more input, so there's no more game
+                play_action(GAME_QUIT, 0);
+                return;
+            }
+            if (toupper(input[0]) == HINT) {
+                make_hint();
+                input[0] = '\n';
+            }
         } while (input[0] == '\n');
 
         // get rid of the trailing '\n'
@@ -306,77 +290,17 @@ static void assign_score(void)
         // isn't a Full House, then it's assumed the user wants to put
         // a zero in that spot for a strategic reason. A potential
         // future enhancemet would be to prompt "Are you sure?".
-        score = 0;
-        if ((item >= ACES) && (item <= SIXES)) {
-            for (int i=0; i < NUMBER_OF_DICE; ++i) {
-                // The item is in the upper section.
-                // Add up the die with that number (if any)
-                score = how_many_of(item) * item;
-            }
-        } else if (item == KIND3) {
-            if (max_dice_matching() >= MIN_3KIND_MATCH) {
-                score = total_of_dice();
+        // Try to set the score and leave the loop, or say why not.
+        result = play_action(GAME_SCORE, item);
+        if (result >= 0) {
+            score_set(item, Game.score[item]);
+            if (result & GAME_EVENT_BONUS) {
+                score_set(YAHTZEE_BONUS, SCORE_YAHTZEE_BONUS);
             }
-        } else if (item == KIND4) {
-            if (max_dice_matching() >= MIN_4KIND_MATCH) {
-                score = total_of_dice();
-            }
-        } else if ((item == FULL_HOUSE) && (is_full_house())) {
-            score = SCORE_FULL_HOUSE;
-        } else if (item == STRAIGHT_SM) {
-            if (max_dice_matching() > MAX_SMSTRAIGHT_MATCH) {
-                // A small straight can't have more than two dice matching
-                ; // do nothing; score is already zero
-            } else if ((how_many_of(THREES) == 0) ||
-                       (how_many_of(FOURS) == 0)) {
-                // A small straight always has at least a 3 and 4
-                ; // do nothing; score is already zero
-            } else if ((how_many_of(ACES) > 0) &&
-                       (how_many_of(TWOS) > 0)) {
-                // A straight with 1, 2, 3, 4
-                score = SCORE_STRAIGHT_SM;
-            } else if ((how_many_of(TWOS) > 0) &&
-                       (how_many_of(FIVES) > 0)) {
-                // A straight with 2, 3, 4, 5
-                score = SCORE_STRAIGHT_SM;
-            } else if ((how_many_of(THREES) > 0) &&
-                       (how_many_of(SIXES) > 0)) {
-                // A straight with 3, 4, 5, 6
-                score = SCORE_STRAIGHT_SM;
-            }
-        } else if (item == STRAIGHT_LG) {
-            // Verify we have a large straight
-            if (max_dice_matching() > MAX_LGSTRAIGHT_MATCH) {
-                // A large straight has no duplicates
-                ; // do nothing; the score is already zero
-            } else if ((how_many_of(TWOS) == 0) ||
-                       (how_many_of(THREES) == 0) ||
-                       (how_many_of(FOURS) == 0)) {
-                // A large straight always has 2, 3, 4
-                ; // do nothing; the score is already zero
-            } else if ((how_many_of(ACES) == 1) &&
-                       (how_many_of(FIVES) == 1)) {
-                // A large straight of 1, 2, 3, 4, 5
-                score = SCORE_STRAIGHT_LG;
-            } else if ((how_many_of(TWOS) == 1) &&
-                       (how_many_of(SIXES) == 1)) {
-                // A large straight of 2, 3, 4, 5, 6
-                score = SCORE_STRAIGHT_LG;
-            }
-        } else if (item == YAHTZEE) {
-            if (max_dice_matching() == NUMBER_OF_DICE) {
-                score = SCORE_YAHTZEE;
-            }
-        } else if (item == CHANCE) {
-            score = total_of_dice();
-        }
-
-        // Try to set the score and leave the loop.
-        // Future enhancement: show the reason the request failed.
-        result = score_set(item, score);
-        if (result == SUCCESS) {
             break;
         }
+        snprintf(Hint, sizeof(Hint), "Can't score item %i: %s", item,
+                 game_error_text(result));
     }
 
 }//end assign_score
@@ -396,8 +320,7 @@ static void assign_score(void)
 // ---------------------------------------------------------------------
 static void choose_dice(void)
 {
-    int die;
-    char ch;
+    int  ch;
     bool done = false;
 
     while (!done) {
@@ -407,10 +330,10 @@ static void choose_dice(void)
         printf("Die #   Keep   Roll\n");
         printf("-----   ----   ----\n");
         for (int i = 0; i < NUMBER_OF_DICE; ++i) {
-            if (Dice[i].keep) {
-                printf("    %i   %i\n", i+1, Dice[i].value);
+            if (Game.keep & (1u << i)) {
+                printf("    %i   %i\n", i+1, Game.dice[i]);
             } else {
-                printf("    %i          %i\n", i+1, Dice[i].value);
+                printf("    %i          %i\n", i+1, Game.dice[i]);
             }
         }
 
@@ -418,13 +341,9 @@ static void choose_dice(void)
         printf("\n\nEnter the die # to change (1 thru 5), or 'R' to return: ");
         ch = getc(stdin);
         if (isdigit(ch)) {
-            die = ch - '1';
-
-            // Switch whether to keep or roll
-            if ((die >= 0) && (die < NUMBER_OF_DICE)) {
-                Dice[die].keep = !(Dice[die].keep);
-            }
-        } else if (toupper(ch) == RETURN) {
+            // Switch whether to keep or roll (bad die #'s are ignored)
+            play_action(GAME_KEEP, ch - '0');
+        } else if ((toupper(ch) == RETURN) || (ch == EOF)) {
             done = true;
         }
     }
@@ -432,80 +351,116 @@ static void choose_dice(void)
 }//end choose_dice
 
 
+// ************************************************************************
+// *************************  EXTERNAL FUNCTIONS **************************
+// ************************************************************************
+
 // ---------------------------------------------------------------------
 // Function
-//     roll_dice
+//     play_seed
 // Inputs
-//     none
+//     seed
+//         The seed for the dice.
 // Outputs
 //     none
 // Description
-//     This function "rolls the dice" selected by the user by assigning
-//     random values to those dice the user didn't keep.
+//     This function makes the next play_yahtzee() roll the dice from
+//     the given seed, instead of one picked from the time and process
+//     id, so the same keystrokes always play the same game.
 // ---------------------------------------------------------------------
-static void roll_dice(void)
+void play_seed(const uint64_t seed)
 {
-    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
-        if (Dice[i].keep == false) {
-            Dice[i].value = (random() % NUMBER_OF_SIDES) + 1;
-        }
-    }
-
-}//end roll_dice
+    Seed   = seed;
+    Seeded = true;
+}//end play_seed
 
 
 // ---------------------------------------------------------------------
 // Function
-//     init_dice
+//     play_game
 // Inputs
 //     none
 // Outputs
-//     none
+//     function result
 // Description
-//     This function initializes the dice by "rolling" all the dice and
-//     marking them as rollable. This is typically done as the first roll
-//     of a turn.
+//     Returns the game being played, or the last one once it's over.
 // ---------------------------------------------------------------------
-static void init_dice(void)
+const struct game_t *play_game(void)
 {
-    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
-        Dice[i].value = (random() % NUMBER_OF_SIDES) + 1;
-        Dice[i].keep  = false;
-    }
+    return &Game;
+}//end play_game
 
-}//end init_dice
 
+// ---------------------------------------------------------------------
+// Function
+//     play_actions
+// Inputs
+//     actions
+//         Where to put the actions.
+// Outputs
+//     function result
+// Description
+//     Gives the actions taken in the game, in order, for gamelog_write().
+//     The result is how many there are, or -1 if there were more than
+//     GAMELOG_MAX_ACTIONS.
+// ---------------------------------------------------------------------
+int play_actions(const struct game_action_t **actions)
+{
+    *actions = Actions;
+    return Num_actions;
+}//end play_actions
 
-// ************************************************************************
-// *************************  EXTERNAL FUNCTIONS **************************
-// ************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     play_yahtzee
+// Inputs
+//     none
+// Outputs
+//     none
+// Description
+//     This function plays one game with the user, from the first roll
+//     until every turn is scored, the user quits, or input runs out.
+//     Hints are worked out from the table named by YAHTZEE_TABLE or,
+//     without one, in a cache of YAHTZEE_MEMO_KB (MEMO_KB by default),
+//     by a worker started with the first game and kept for the rest.
+// ---------------------------------------------------------------------
 void play_yahtzee(void)
 {
-    char ch = '\n';
-
-    // Initialize globals
-    Num_turns = 1;
-    Num_rolls = 1;
+    const char *kb = getenv(MEMO_VARIABLE);
+    int         ch = '\n';
 
-    // initialize the PRNG and the dice
-    srandom(time(NULL)*getpid());
-    init_dice();
+    // Initialize the game and roll the dice for the first turn
+    if (!Seeded) {
+        Seed = time(NULL)*getpid();
+    }
+    game_new(&Game, Seed);
+    Seeded      = false;
+    Num_actions = 0;
+    if (Hints == NULL) {
+        Hints = hint_start(getenv(TABLE_VARIABLE),
+                           (kb != NULL) ? strtoul(kb, NULL, BASE_10) *
+                                          BYTES_PER_KB
+                                        : MEMO_KB * BYTES_PER_KB);
+    }
+    Hint_turn.state = -1;
+    if (Hints != NULL) {
+        hint_reset(Hints);
+        hint_ahead(Hints, &Game);
+    }
 
     // This loop continues until the user has taken all their turns or
     // the user quits the game.
     while (true) {
         // Is the game over?
-        if (Num_turns > MAX_TURNS) {
+        if (game_over(&Game)) {
             break;
         }
 
-        if (Num_rolls == MAX_ROLLS) {
+        if (Game.roll == MAX_ROLLS) {
             // The user has used all the rolls for the turn and
             // is forced to enter a score.
             assign_score();
-            Num_rolls = 1;
-            ++Num_turns;
-            init_dice();
         } else {
             while (ch == '\n') {
                 // Display the score and the dice
@@ -520,19 +475,18 @@ void play_yahtzee(void)
                 ch = getc(stdin);
             }
 
-            // Do what the user asked
-            if (toupper(ch) == QUIT) {
-                break;
+            // Do what the user asked. Running out of input is the
+            // same as quitting.
+            if ((toupper(ch) == QUIT) || (ch == EOF)) {
+                play_action(GAME_QUIT, 0);
             } else if (toupper(ch) == CHOOSE) {
                 choose_dice();
             } else if (toupper(ch) == ROLL) {
-                roll_dice();
-                ++Num_rolls;
+                play_action(GAME_ROLL, 0);
             } else if (toupper(ch) == SCORE) {
                 assign_score();
-                Num_rolls = 1;
-                ++Num_turns;
-                init_dice();
+            } else if (toupper(ch) == HINT) {
+                make_hint();
             } else {
                 // Bad selection. Do nothing and loop back to prompt again
                 ;
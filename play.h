@@ -10,6 +10,12 @@
 #ifndef PLAY_H
 #define PLAY_H
 
-extern void play_yahtzee(void);
+#include <stdint.h>
+#include "game.h"
+
+extern void     play_seed(const uint64_t seed);
+extern void     play_yahtzee(void);
+extern const struct game_t *play_game(void);
+extern int      play_actions(const struct game_action_t **actions);
 
 #endif // PLAY_H
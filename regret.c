@@ -0,0 +1,774 @@
+// ----------------------------------------------------------------------
+// File: regret.c
+//
+// Name: Al Shaffer & Marshall Liu
+//
+// Description: This is a driver that looks back over logged games (see
+//     the GAMELOG module; ./yahtzee -l writes them) and works out how
+//     many points each decision gave up against the solved table: what
+//     the best play was worth, less what the play that was made was
+//     worth, both in points still to come. Keeps are looked at when the
+//     dice are rolled, and scores when the dice are scored, including
+//     scoring early instead of rolling again. The losses are added up
+//     for each player, by the item that was scored or by keep, so it
+//     can say where a player loses the most ("2.10 points a game on
+//     Full house").
+//
+//     What a player loses adds up to what they can expect to finish
+//     short of the table's start value, so that's printed next to what
+//     they really averaged, as a check.
+//
+//     Logs are read a batch of games (-b) at a time. First the games
+//     are split over the threads, which replay them and note each
+//     decision. Then the decisions are sorted by scorecard and split
+//     over the threads again, at scorecard boundaries, so each turn is
+//     worked out once for all the decisions made from it in the batch,
+//     however many games they came from. The bigger the batch, the
+//     more games share each turn.
+//
+//     With -g, instead of reading logs, the given number of games are
+//     played and logged to stdout, by the BOT module as "bot" and by
+//     the table as "table", turn about, to have something to look at.
+//
+// Syntax: ./yahtzee_regret [-t threads] [-r table_file] [-b batch_games]
+//                          [log_file ...]
+//         ./yahtzee_regret [-r table_file] -g games [-s seed]
+// ----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "score.h"
+#include "rules.h"
+#include "game.h"
+#include "solver.h"
+#include "evtable.h"
+#include "gamelog.h"
+#include "bot.h"
+#include "timing.h"
+
+#define DEFAULT_BATCH   200000
+#define DEFAULT_SEED    1
+#define MAX_THREADS     256
+#define MAX_PLAYERS     4096
+#define PLAYER_SLOTS    (2 * MAX_PLAYERS)   // A power of 2
+#define KEEPS           0        // Row of the losses for keeps; items are
+                                 // ACES thru CHANCE
+#define MISTAKE         0.01     // Points a decision must lose to count
+#define FIRST_DECISIONS 4096
+#define BASE_10         10
+#define NS_PER_SEC      1e9
+#define SECONDS_PER_HOUR 3600
+#define FNV_OFFSET      2166136261u
+#define FNV_PRIME       16777619u
+
+
+// **************************************************************************
+// ****************************  DEFINED TYPES   ****************************
+// **************************************************************************
+
+// One decision made in a game
+struct decision_t {
+    int32_t  state;    // The scorecard the turn started from
+    uint16_t roll;     // The dice, from solver_roll_of()
+    uint16_t choice;   // The keep, or the item scored
+    uint16_t player;
+    uint8_t  rolls;    // Rolls taken so far this turn
+    uint8_t  scored;   // Whether the dice were scored, not rolled
+};
+
+// What one player's decisions added up to
+struct stats_t {
+    unsigned long games;
+    double        points;                              // Final totals
+    double        lost[NUMBER_OF_CATEGORIES + 1];      // By KEEPS or item
+    unsigned long made[NUMBER_OF_CATEGORIES + 1];      // Decisions
+    unsigned long mistakes[NUMBER_OF_CATEGORIES + 1];  // Losing MISTAKE
+};
+
+// One thread's share of a batch
+struct analyzer_t {
+    pthread_t          thread;
+    size_t             first;       // The games to replay
+    size_t             last;
+    struct decision_t *decisions;   // Noted while replaying
+    size_t             count;
+    size_t             size;
+    size_t             from;        // The sorted decisions to look at
+    size_t             to;
+    unsigned long      bad;         // Games that couldn't be replayed
+    unsigned long      turns;       // Worked out
+    struct stats_t    *stats;       // By player
+};
+
+// Where a game being replayed is noting its decisions
+struct replay_t {
+    struct analyzer_t *a;
+    uint16_t           player;
+};
+
+
+// **************************************************************************
+// **************************** GLOBAL VARIABLES ****************************
+// **************************************************************************
+
+static struct evtable_t *Table;
+
+static char    **Lines;                      // The batch's games, as read
+static size_t   *Line_sizes;                 // Room in each line
+static char    **Plays;                      // Each line after the name
+static uint16_t *Line_players;               // Each line's player
+
+static char    *Players[MAX_PLAYERS];        // Names
+static int      Num_players;
+static int32_t  Player_slots[PLAYER_SLOTS];  // Hashed; -1 if empty
+
+static struct decision_t *Sorted;            // The batch's decisions
+static size_t             Sorted_size;
+static uint32_t          *Starts;            // By state, into Sorted
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     player_of
+// Inputs
+//     name
+//         A player's name.
+// Outputs
+//     function result
+// Description
+//     This function returns the player's number, giving them the next
+//     one the first time they're seen, or -1 if there are already
+//     MAX_PLAYERS players.
+// ---------------------------------------------------------------------
+static int player_of(const char *name)
+{
+    uint32_t hash = FNV_OFFSET;
+    uint32_t slot;
+
+    for (const char *c = name; *c != '\0'; ++c) {
+        hash = (hash ^ (unsigned char)*c) * FNV_PRIME;
+    }
+
+    for (slot = hash % PLAYER_SLOTS; Player_slots[slot] >= 0;
+         slot = (slot + 1) % PLAYER_SLOTS) {
+        if (strcmp(Players[Player_slots[slot]], name) == 0) {
+            return Player_slots[slot];
+        }
+    }
+    if (Num_players == MAX_PLAYERS) {
+        return -1;
+    }
+
+    Players[Num_players] = strdup(name);
+    if (Players[Num_players] == NULL) {
+        perror("players");
+        exit(EXIT_FAILURE);
+    }
+    Player_slots[slot] = Num_players;
+
+    return Num_players++;
+
+}//end player_of
+
+
+// ---------------------------------------------------------------------
+// Function
+//     note_decision
+// Inputs
+//     game
+//         The game before the action.
+//     action
+//         What the player did.
+//     context
+//         The replay_t.
+// Outputs
+//     none
+// Description
+//     This function is called by gamelog_replay() before each action.
+//     Rolling after the first roll of a turn is a keep decision, and
+//     scoring is a score decision; each is noted for the analyzer.
+// ---------------------------------------------------------------------
+static void note_decision(const struct game_t *game,
+                          const struct game_action_t action, void *context)
+{
+    struct replay_t   *replay = context;
+    struct analyzer_t *a = replay->a;
+    struct decision_t *d;
+
+    if (game_over(game) ||
+        !(((action.type == GAME_ROLL) && (game->roll < MAX_ROLLS)) ||
+          ((action.type == GAME_SCORE) && (action.arg >= ACES) &&
+           (action.arg <= CHANCE)))) {
+        return;
+    }
+
+    if (a->count == a->size) {
+        a->size      = (a->size == 0) ? FIRST_DECISIONS : a->size * 2;
+        a->decisions = realloc(a->decisions, a->size * sizeof(*d));
+        if (a->decisions == NULL) {
+            perror("decisions");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    d = &a->decisions[a->count++];
+    d->state  = solver_state_of(game);
+    d->roll   = solver_roll_of(game->dice);
+    d->player = replay->player;
+    d->rolls  = game->roll;
+    d->scored = (action.type == GAME_SCORE);
+    d->choice = d->scored ? action.arg
+                          : solver_keep_of(game->dice, game->keep);
+
+}//end note_decision
+
+
+// ---------------------------------------------------------------------
+// Function
+//     replay_games
+// Inputs
+//     arg
+//         The analyzer_t.
+// Outputs
+//     function result
+// Description
+//     This is the thread that replays the analyzer's share of the
+//     batch. A game that can't be replayed, or wasn't played to the
+//     end, is counted as bad and its decisions are left out.
+// ---------------------------------------------------------------------
+static void *replay_games(void *arg)
+{
+    struct analyzer_t *a = arg;
+    struct replay_t    replay = { a, 0 };
+    struct game_t      game;
+    size_t             count;
+
+    a->count = 0;
+    for (size_t i = a->first; i < a->last; ++i) {
+        replay.player = Line_players[i];
+        count = a->count;
+        if ((gamelog_replay(Plays[i], note_decision, &replay,
+                            &game) != SUCCESS) ||
+            !game_over(&game) || game.quit) {
+            a->count = count;
+            ++a->bad;
+            continue;
+        }
+        ++a->stats[replay.player].games;
+        a->stats[replay.player].points += game_total(&game);
+    }
+
+    return NULL;
+
+}//end replay_games
+
+
+// ---------------------------------------------------------------------
+// Function
+//     best_item_value
+// Inputs
+//     next
+//         The rows of the scorecards after this one.
+//     state
+//         The scorecard.
+//     r
+//         The roll being scored.
+// Outputs
+//     function result
+// Description
+//     Returns what the roll is worth scored in the best item it can
+//     be, for a decision after the last roll, when there's no turn
+//     worked out.
+// ---------------------------------------------------------------------
+static float best_item_value(const float *next[], const int state,
+                             const int r)
+{
+    unsigned int items = solver_items(state, r);
+    float        best = 0;
+    float        value;
+
+    for (int item = ACES; item <= CHANCE; ++item) {
+        if (items & (1u << (item - ACES))) {
+            value = solver_item_value(next, state, r, item);
+            if (value > best) {
+                best = value;
+            }
+        }
+    }
+
+    return best;
+
+}//end best_item_value
+
+
+// ---------------------------------------------------------------------
+// Function
+//     weigh_decisions
+// Inputs
+//     arg
+//         The analyzer_t.
+// Outputs
+//     function result
+// Description
+//     This is the thread that works out what the analyzer's share of
+//     the sorted decisions lost. The rows of a scorecard are decoded,
+//     and its turn is worked out, once for each scorecard in the share.
+// ---------------------------------------------------------------------
+static void *weigh_decisions(void *arg)
+{
+    struct analyzer_t       *a = arg;
+    float                    rows[NUMBER_OF_CATEGORIES + 1][SOLVER_UPPER];
+    const float             *next[NUMBER_OF_CATEGORIES + 1];
+    struct solver_turn_t     turn = { .state = -1 };
+    const struct decision_t *d;
+    struct stats_t          *s;
+    int                      state = -1;
+    int                      row;
+    float                    best;
+    float                    value;
+
+    for (size_t i = a->from; i < a->to; ++i) {
+        d = &Sorted[i];
+        if (d->state != state) {
+            state = d->state;
+            evtable_rows(Table, state / SOLVER_UPPER, rows, next);
+        }
+        if ((d->rolls < MAX_ROLLS) && (turn.state != state)) {
+            solver_turn_rows(next, state, &turn);
+            ++a->turns;
+        }
+
+        if (d->scored) {
+            row   = d->choice;
+            value = solver_item_value(next, state, d->roll, d->choice);
+            best  = (d->rolls < MAX_ROLLS) ? turn.roll[d->rolls - 1][d->roll]
+                                           : best_item_value(next, state,
+                                                             d->roll);
+        } else {
+            row   = KEEPS;
+            value = turn.keep[d->rolls][d->choice];
+            best  = turn.roll[d->rolls - 1][d->roll];
+        }
+
+        s = &a->stats[d->player];
+        ++s->made[row];
+        if (best - value > 0) {
+            s->lost[row] += best - value;
+            if (best - value >= MISTAKE) {
+                ++s->mistakes[row];
+            }
+        }
+    }
+
+    return NULL;
+
+}//end weigh_decisions
+
+
+// ---------------------------------------------------------------------
+// Function
+//     sort_decisions
+// Inputs
+//     analyzers
+//         The threads, with the decisions they noted.
+//     threads
+//         How many there are.
+// Outputs
+//     function result
+// Description
+//     This function puts every decision of the batch in Sorted, in
+//     order of scorecard, by counting how many there are of each. The
+//     result is how many there are.
+// ---------------------------------------------------------------------
+static size_t sort_decisions(const struct analyzer_t analyzers[],
+                             const int threads)
+{
+    size_t   total = 0;
+    uint32_t start = 0;
+    uint32_t count;
+
+    for (int t = 0; t < threads; ++t) {
+        total += analyzers[t].count;
+    }
+    if (total > Sorted_size) {
+        Sorted_size = total;
+        Sorted      = realloc(Sorted, total * sizeof(*Sorted));
+        if (Sorted == NULL) {
+            perror("decisions");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    memset(Starts, 0, SOLVER_STATES * sizeof(*Starts));
+    for (int t = 0; t < threads; ++t) {
+        for (size_t i = 0; i < analyzers[t].count; ++i) {
+            ++Starts[analyzers[t].decisions[i].state];
+        }
+    }
+    for (int state = 0; state < SOLVER_STATES; ++state) {
+        count         = Starts[state];
+        Starts[state] = start;
+        start        += count;
+    }
+    for (int t = 0; t < threads; ++t) {
+        for (size_t i = 0; i < analyzers[t].count; ++i) {
+            Sorted[Starts[analyzers[t].decisions[i].state]++] =
+                analyzers[t].decisions[i];
+        }
+    }
+
+    return total;
+
+}//end sort_decisions
+
+
+// ---------------------------------------------------------------------
+// Function
+//     analyze_batch
+// Inputs
+//     analyzers
+//         The threads.
+//     threads
+//         How many there are.
+//     games
+//         The games in the batch.
+// Outputs
+//     function result
+// Description
+//     This function replays the batch's games and weighs their
+//     decisions, adding to each thread's stats. The result is how many
+//     decisions there were.
+// ---------------------------------------------------------------------
+static size_t analyze_batch(struct analyzer_t analyzers[], const int threads,
+                            const size_t games)
+{
+    size_t total;
+    size_t from = 0;
+    size_t to;
+
+    for (int t = 0; t < threads; ++t) {
+        analyzers[t].first = games * t / threads;
+        analyzers[t].last  = games * (t + 1) / threads;
+        pthread_create(&analyzers[t].thread, NULL, replay_games,
+                       &analyzers[t]);
+    }
+    for (int t = 0; t < threads; ++t) {
+        pthread_join(analyzers[t].thread, NULL);
+    }
+
+    total = sort_decisions(analyzers, threads);
+
+    // Split the sorted decisions evenly, but never inside a scorecard
+    for (int t = 0; t < threads; ++t) {
+        to = (t == threads - 1) ? total : total * (t + 1) / threads;
+        if (to < from) {
+            to = from;
+        }
+        while ((to > from) && (to < total) &&
+               (Sorted[to].state == Sorted[to - 1].state)) {
+            ++to;
+        }
+        analyzers[t].from = from;
+        analyzers[t].to   = to;
+        from = to;
+        pthread_create(&analyzers[t].thread, NULL, weigh_decisions,
+                       &analyzers[t]);
+    }
+    for (int t = 0; t < threads; ++t) {
+        pthread_join(analyzers[t].thread, NULL);
+    }
+
+    return total;
+
+}//end analyze_batch
+
+
+// ---------------------------------------------------------------------
+// Function
+//     read_batch
+// Inputs
+//     file
+//         A log.
+//     batch
+//         The most games to read.
+//     bad
+//         Where to count the lines that aren't games.
+// Outputs
+//     function result
+// Description
+//     This function reads the next games of the log into the batch,
+//     returning how many it read. Lines that don't start with a
+//     player's name, or whose player doesn't fit, are counted as bad.
+// ---------------------------------------------------------------------
+static size_t read_batch(FILE *file, const size_t batch, unsigned long *bad)
+{
+    size_t games = 0;
+    int    player;
+
+    while ((games < batch) &&
+           (getline(&Lines[games], &Line_sizes[games], file) >= 0)) {
+        if (Lines[games][strspn(Lines[games], " \t\r\n")] == '\0') {
+            continue;
+        }
+        Plays[games] = gamelog_split(Lines[games]);
+        player = (Plays[games] != NULL) ? player_of(Lines[games]) : -1;
+        if (player < 0) {
+            ++*bad;
+            continue;
+        }
+        Line_players[games++] = player;
+    }
+
+    return games;
+
+}//end read_batch
+
+
+// ---------------------------------------------------------------------
+// Function
+//     write_games
+// Inputs
+//     games
+//         How many games to play.
+//     seed
+//         The first game's seed; the rest follow it.
+// Outputs
+//     function result
+// Description
+//     This function plays the games, the bot and the table taking
+//     turns, and logs them to stdout. It returns SUCCESS, or !SUCCESS
+//     if they couldn't be written.
+// ---------------------------------------------------------------------
+static int write_games(const unsigned long games, const uint64_t seed)
+{
+    static struct game_action_t actions[GAMELOG_MAX_ACTIONS];
+    struct solver_turn_t        turn = { .state = -1 };
+    struct game_t               game;
+    int                         count;
+
+    for (unsigned long i = 0; i < games; ++i) {
+        game_new(&game, seed + i);
+        for (count = 0; !game_over(&game) && (count < GAMELOG_MAX_ACTIONS);
+             ++count) {
+            actions[count] = (i % 2 == 0) ? bot_choose(&game)
+                                          : evtable_choose(Table, &game,
+                                                           &turn);
+            game_step(&game, actions[count], &game);
+        }
+        if (gamelog_write(stdout, (i % 2 == 0) ? "bot" : "table", seed + i,
+                          actions, count) != SUCCESS) {
+            return !SUCCESS;
+        }
+    }
+
+    return SUCCESS;
+
+}//end write_games
+
+
+// ---------------------------------------------------------------------
+// Function
+//     report
+// Inputs
+//     all
+//         The merged stats, by player.
+//     start
+//         What the table expects from a fresh game.
+// Outputs
+//     none
+// Description
+//     This function prints where each player lost points, per game.
+// ---------------------------------------------------------------------
+static void report(const struct stats_t all[], const float start)
+{
+    static const char *names[NUMBER_OF_CATEGORIES + 1] = {
+        "Keeps", "Aces", "Twos", "Threes", "Fours", "Fives", "Sixes",
+        "3 of a kind", "4 of a kind", "Full house", "Small straight",
+        "Large straight", "Yahtzee", "Chance"
+    };
+    const struct stats_t *s;
+    double                lost;
+    int                   worst;
+
+    for (int p = 0; p < Num_players; ++p) {
+        s = &all[p];
+        if (s->games == 0) {
+            continue;
+        }
+
+        lost  = 0;
+        worst = ACES;
+        for (int row = KEEPS; row <= CHANCE; ++row) {
+            lost += s->lost[row];
+            if ((row != KEEPS) && (s->lost[row] > s->lost[worst])) {
+                worst = row;
+            }
+        }
+
+        printf("\n%s: %lu games averaging %.2f (%.2f expected: the "
+               "table's %.2f, less %.2f lost a game)\n", Players[p],
+               s->games, s->points / s->games, start - lost / s->games,
+               start, lost / s->games);
+        printf("    %-16s %12s %9s %11s\n", "Decision", "Made",
+               "Mistakes", "Lost/game");
+        for (int row = KEEPS; row <= CHANCE; ++row) {
+            printf("    %-16s %12lu %8.2f%% %11.3f\n", names[row],
+                   s->made[row],
+                   (s->made[row] > 0) ? 100.0 * s->mistakes[row] /
+                                        s->made[row] : 0.0,
+                   s->lost[row] / s->games);
+        }
+        if (s->lost[worst] >= MISTAKE * s->games) {
+            printf("    Scoring loses the most on %s: %.2f points a game\n",
+                   names[worst], s->lost[worst] / s->games);
+        }
+    }
+
+}//end report
+
+
+// **************************************************************************
+// *********************************  MAIN **********************************
+// **************************************************************************
+int main(int argc, char *argv[])
+{
+    static struct analyzer_t analyzers[MAX_THREADS];
+    const char              *table_file = NULL;
+    struct stats_t          *all;
+    struct timespec          start;
+    FILE                    *file;
+    float                   *ev;
+    size_t                   batch = DEFAULT_BATCH;
+    size_t                   read;
+    unsigned long            write = 0;
+    uint64_t                 seed = DEFAULT_SEED;
+    long                     threads = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned long            games = 0;
+    unsigned long            decisions = 0;
+    unsigned long            turns = 0;
+    unsigned long            bad = 0;
+    double                   seconds;
+    int                      opt;
+
+    while ((opt = getopt(argc, argv, "t:r:b:g:s:")) != -1) {
+        if (opt == 't') {
+            threads = atoi(optarg);
+        } else if (opt == 'r') {
+            table_file = optarg;
+        } else if (opt == 'b') {
+            batch = strtoul(optarg, NULL, BASE_10);
+        } else if (opt == 'g') {
+            write = strtoul(optarg, NULL, BASE_10);
+        } else if (opt == 's') {
+            seed = strtoull(optarg, NULL, BASE_10);
+        } else {
+            threads = 0;
+            break;
+        }
+    }
+    if ((threads < 1) || (threads > MAX_THREADS) || (batch == 0)) {
+        fprintf(stderr, "Syntax: %s [-t threads] [-r table_file] "
+                "[-b batch_games] [log_file ...]\n"
+                "        %s [-r table_file] -g games [-s seed]\n",
+                argv[0], argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (table_file != NULL) {
+        Table = evtable_load(table_file);
+        if (Table == NULL) {
+            return EXIT_FAILURE;
+        }
+    } else {
+        fprintf(stderr, "Solving with %li thread(s)...\n", threads);
+        ev = solver_solve(threads);
+        Table = (ev != NULL) ? evtable_make(ev, EVTABLE_FLOAT) : NULL;
+        solver_free(ev);
+        if (Table == NULL) {
+            fprintf(stderr, "Error: out of memory\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (write > 0) {
+        if (write_games(write, seed) != SUCCESS) {
+            perror("stdout");
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    Lines        = calloc(batch, sizeof(*Lines));
+    Line_sizes   = calloc(batch, sizeof(*Line_sizes));
+    Plays        = calloc(batch, sizeof(*Plays));
+    Line_players = calloc(batch, sizeof(*Line_players));
+    Starts       = calloc(SOLVER_STATES, sizeof(*Starts));
+    all          = calloc(MAX_PLAYERS, sizeof(*all));
+    for (int t = 0; t < threads; ++t) {
+        analyzers[t].stats = calloc(MAX_PLAYERS, sizeof(*all));
+        if (analyzers[t].stats == NULL) {
+            all = NULL;
+        }
+    }
+    if ((Lines == NULL) || (Line_sizes == NULL) || (Plays == NULL) ||
+        (Line_players == NULL) || (Starts == NULL) || (all == NULL)) {
+        fprintf(stderr, "Error: out of memory\n");
+        return EXIT_FAILURE;
+    }
+    memset(Player_slots, -1, sizeof(Player_slots));
+
+    // Read each log (stdin without any) a batch at a time
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int f = optind; (f < argc) || (f == optind); ++f) {
+        file = (f < argc) ? fopen(argv[f], "r") : stdin;
+        if (file == NULL) {
+            perror(argv[f]);
+            return EXIT_FAILURE;
+        }
+        while ((read = read_batch(file, batch, &bad)) > 0) {
+            decisions += analyze_batch(analyzers, threads, read);
+        }
+        if (file != stdin) {
+            fclose(file);
+        }
+    }
+    seconds = timing_since(&start);
+
+    for (int t = 0; t < threads; ++t) {
+        bad   += analyzers[t].bad;
+        turns += analyzers[t].turns;
+        for (int p = 0; p < Num_players; ++p) {
+            all[p].games  += analyzers[t].stats[p].games;
+            all[p].points += analyzers[t].stats[p].points;
+            for (int row = KEEPS; row <= CHANCE; ++row) {
+                all[p].lost[row]     += analyzers[t].stats[p].lost[row];
+                all[p].made[row]     += analyzers[t].stats[p].made[row];
+                all[p].mistakes[row] += analyzers[t].stats[p].mistakes[row];
+            }
+        }
+    }
+    for (int p = 0; p < Num_players; ++p) {
+        games += all[p].games;
+    }
+
+    printf("%lu games (%lu bad) by %i player(s): %lu decisions from %lu "
+           "turns worked out, in %.2f s with %li thread(s) (%.0f games an "
+           "hour)\n", games, bad, Num_players, decisions, turns, seconds,
+           threads, (seconds > 0) ? games * SECONDS_PER_HOUR / seconds : 0);
+    report(all, evtable_value(Table, 0));
+
+    return EXIT_SUCCESS;
+
+} // end main
+
+// end regret.c
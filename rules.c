@@ -0,0 +1,417 @@
+// ----------------------------------------------------------------------
+// File: rules.c
+//
+// Name: Al Shaffer & Marshall Liu
+//
+// Description: This RULES module decides what a set of dice is worth
+//     in each line of the scorecard, and rolls dice from a caller-owned
+//     random number generator. Nothing in here touches the screen or
+//     keeps a global scorecard, so the PLAY module and the game server
+//     can both use it.
+//
+//     A YAHTZEE rolled once the YAHTZEE item is used is a Joker, by the
+//     official rules: it has to go in the upper item of its face if
+//     that's open, or else in any open lower item, where it scores as
+//     if it were a full house or a straight, or else in any open upper
+//     item (for nothing). What a Joker earns on top of that, when the
+//     YAHTZEE item was scored 50, is up to the GAME module.
+// ----------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "score.h"
+#include "rules.h"
+
+#define MAX_FULLHOUSE_MATCH  3
+#define MIN_FULLHOUSE_MATCH  2
+#define MIN_3KIND_MATCH      3
+#define MIN_4KIND_MATCH      4
+#define MAX_SMSTRAIGHT_MATCH 2
+#define MAX_LGSTRAIGHT_MATCH 1
+#define UPPER_ITEMS          (((1u << (SIXES + 1)) - 1) & ~1u)   // Bit item
+#define LOWER_ITEMS          (((1u << (CHANCE + 1)) - 1) & ~UPPER_ITEMS & ~1u)
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     how_many_of
+// Inputs
+//     dice
+//         The face values of all the dice.
+//     die
+//         This is the die value to be searched for.
+// Outputs
+//     function result
+// Description
+//     The function counts the number of die that have the input die
+//     "face up", and returns the number found. For example, if the
+//     current dice are "3 4 5 5 1", and the input is 5, this function
+//     will return 2.
+// ---------------------------------------------------------------------
+static int how_many_of(const unsigned char dice[], const int die)
+{
+    int count = 0;
+
+    for (int i=0; i < NUMBER_OF_DICE; ++i) {
+        if (dice[i] == die) {
+            ++count;
+        }
+    }
+
+    return count;
+
+}//end how_many_of
+
+
+// ---------------------------------------------------------------------
+// Function
+//     total_of_dice
+// Inputs
+//     dice
+//         The face values of all the dice.
+// Outputs
+//     Function result
+// Description
+//     This function looks at all the "face up" values of each die and
+//     returns their current total.
+// ---------------------------------------------------------------------
+static int total_of_dice(const unsigned char dice[])
+{
+    int score = 0;
+
+    for (int i=0; i < NUMBER_OF_DICE; ++i) {
+        score += dice[i];
+    }
+
+    return score;
+
+}//end total_of_dice
+
+
+// ---------------------------------------------------------------------
+// Function
+//     max_dice_matching
+// Inputs
+//     dice
+//         The face values of all the dice.
+// Outputs
+//     function result
+// Description
+//     This function determines the highest number of matching die. For
+//     example, if the dice were "4 2 1 4 4", the result would be 3.
+// ---------------------------------------------------------------------
+static int max_dice_matching(const unsigned char dice[])
+{
+    int count;
+    int max = 0;
+
+    // We'll look at each value and see how many of each we've got
+    for (int i=ACES; i <= NUMBER_OF_SIDES; ++i) {
+        count = how_many_of(dice, i);
+        if (count > max) {
+            max = count;
+        }
+    }
+
+    return max;
+
+}//end max_dice_matching
+
+
+// ---------------------------------------------------------------------
+// Function
+//     is_full_house
+// Inputs
+//     dice
+//         The face values of all the dice.
+// Outputs
+//     function result
+// Description
+//     This function determins whether the dice values represent a full
+//     house (or not), returning true or false.
+// ---------------------------------------------------------------------
+static bool is_full_house(const unsigned char dice[])
+{
+    bool result = false;
+
+    // If we have a 3-of-a-kind, then verify other dice are 2-of-a-kind
+    if (max_dice_matching(dice) == MAX_FULLHOUSE_MATCH) {
+        // Is there a two-of-a-kind?
+        for (int number=1; number <= NUMBER_OF_SIDES; ++number) {
+            if (how_many_of(dice, number) == MIN_FULLHOUSE_MATCH) {
+                result = true;
+                break;
+            }
+        }
+    }
+
+    return result;
+
+}//end is_full_house
+
+
+// ************************************************************************
+// *************************  EXTERNAL FUNCTIONS **************************
+// ************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     rules_score
+// Inputs
+//     dice
+//         The face values of all NUMBER_OF_DICE dice.
+//     item
+//         This is the line in the scorecard the dice would go on.
+// Outputs
+//     function result
+// Description
+//     This function returns what the dice are worth on the given line
+//     of the scorecard. If the dice don't match what the line needs
+//     (for example, "Full House" without a full house), the result is
+//     zero, as is the result for an item that doesn't exist.
+// ---------------------------------------------------------------------
+int rules_score(const unsigned char dice[], const int item)
+{
+    int score = 0;
+
+    if ((item >= ACES) && (item <= SIXES)) {
+        // The item is in the upper section.
+        // Add up the die with that number (if any)
+        score = how_many_of(dice, item) * item;
+    } else if (item == KIND3) {
+        if (max_dice_matching(dice) >= MIN_3KIND_MATCH) {
+            score = total_of_dice(dice);
+        }
+    } else if (item == KIND4) {
+        if (max_dice_matching(dice) >= MIN_4KIND_MATCH) {
+            score = total_of_dice(dice);
+        }
+    } else if ((item == FULL_HOUSE) && (is_full_house(dice))) {
+        score = SCORE_FULL_HOUSE;
+    } else if (item == STRAIGHT_SM) {
+        if (max_dice_matching(dice) > MAX_SMSTRAIGHT_MATCH) {
+            // A small straight can't have more than two dice matching
+            ; // do nothing; score is already zero
+        } else if ((how_many_of(dice, THREES) == 0) ||
+                   (how_many_of(dice, FOURS) == 0)) {
+            // A small straight always has at least a 3 and 4
+            ; // do nothing; score is already zero
+        } else if ((how_many_of(dice, ACES) > 0) &&
+                   (how_many_of(dice, TWOS) > 0)) {
+            // A straight with 1, 2, 3, 4
+            score = SCORE_STRAIGHT_SM;
+        } else if ((how_many_of(dice, TWOS) > 0) &&
+                   (how_many_of(dice, FIVES) > 0)) {
+            // A straight with 2, 3, 4, 5
+            score = SCORE_STRAIGHT_SM;
+        } else if ((how_many_of(dice, FIVES) > 0) &&
+                   (how_many_of(dice, SIXES) > 0)) {
+            // A straight with 3, 4, 5, 6
+            score = SCORE_STRAIGHT_SM;
+        }
+    } else if (item == STRAIGHT_LG) {
+        // Verify we have a large straight
+        if (max_dice_matching(dice) > MAX_LGSTRAIGHT_MATCH) {
+            // A large straight has no duplicates
+            ; // do nothing; the score is already zero
+        } else if ((how_many_of(dice, TWOS) == 0) ||
+                   (how_many_of(dice, THREES) == 0) ||
+                   (how_many_of(dice, FOURS) == 0) ||
+                   (how_many_of(dice, FIVES) == 0)) {
+            // A large straight always has 2, 3, 4, 5
+            ; // do nothing; the score is already zero
+        } else {
+            // Five different dice around 2 thru 5 are either
+            // 1, 2, 3, 4, 5 or 2, 3, 4, 5, 6
+            score = SCORE_STRAIGHT_LG;
+        }
+    } else if (item == YAHTZEE) {
+        if (max_dice_matching(dice) == NUMBER_OF_DICE) {
+            score = SCORE_YAHTZEE;
+        }
+    } else if (item == CHANCE) {
+        score = total_of_dice(dice);
+    }
+
+    return score;
+
+}//end rules_score
+
+
+// ---------------------------------------------------------------------
+// Function
+//     rules_joker
+// Inputs
+//     dice
+//         The face values of all NUMBER_OF_DICE dice.
+//     used
+//         The items already used on the scorecard (bit item).
+// Outputs
+//     function result
+// Description
+//     Returns true if the dice are a YAHTZEE and the YAHTZEE item is
+//     already used, which makes them a Joker.
+// ---------------------------------------------------------------------
+bool rules_joker(const unsigned char dice[], const unsigned int used)
+{
+    return (used & (1u << YAHTZEE)) &&
+           (max_dice_matching(dice) == NUMBER_OF_DICE);
+}//end rules_joker
+
+
+// ---------------------------------------------------------------------
+// Function
+//     rules_allowed
+// Inputs
+//     dice
+//         The face values of all NUMBER_OF_DICE dice.
+//     used
+//         The items already used on the scorecard (bit item).
+//     item
+//         This is the line in the scorecard the dice would go on.
+// Outputs
+//     function result
+// Description
+//     Returns true if the dice may be scored in the item: it has to
+//     exist and be open, and a Joker has to go where the Joker rule
+//     says.
+// ---------------------------------------------------------------------
+bool rules_allowed(const unsigned char dice[], const unsigned int used,
+                   const int item)
+{
+    if ((item < ACES) || (item > CHANCE) || (used & (1u << item))) {
+        return false;
+    } else if (!rules_joker(dice, used)) {
+        return true;
+    } else if (!(used & (1u << dice[0]))) {
+        // The upper item of the YAHTZEE's face comes first
+        return item == dice[0];
+    } else if ((used & LOWER_ITEMS) != LOWER_ITEMS) {
+        return item >= KIND3;
+    }
+
+    return true;
+
+}//end rules_allowed
+
+
+// ---------------------------------------------------------------------
+// Function
+//     rules_card_score
+// Inputs
+//     dice
+//         The face values of all NUMBER_OF_DICE dice.
+//     used
+//         The items already used on the scorecard (bit item).
+//     item
+//         This is the line in the scorecard the dice would go on.
+// Outputs
+//     function result
+// Description
+//     This function is rules_score() on a scorecard with those items
+//     used, where a Joker scores a full house or a straight in full.
+// ---------------------------------------------------------------------
+int rules_card_score(const unsigned char dice[], const unsigned int used,
+                     const int item)
+{
+    if (rules_joker(dice, used)) {
+        if (item == FULL_HOUSE) {
+            return SCORE_FULL_HOUSE;
+        } else if (item == STRAIGHT_SM) {
+            return SCORE_STRAIGHT_SM;
+        } else if (item == STRAIGHT_LG) {
+            return SCORE_STRAIGHT_LG;
+        }
+    }
+
+    return rules_score(dice, item);
+
+}//end rules_card_score
+
+
+// ---------------------------------------------------------------------
+// Function
+//     rules_seed
+// Inputs
+//     seed
+//         Any value, including zero.
+// Outputs
+//     function result
+// Description
+//     This function turns a seed into a starting state for the random
+//     number generator used by rules_roll_die(). The same seed always
+//     produces the same sequence of dice. The state is never zero,
+//     since the generator would get stuck there.
+// ---------------------------------------------------------------------
+uint64_t rules_seed(const uint64_t seed)
+{
+    // SplitMix64 finalizer, which spreads nearby seeds far apart
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL;
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
+
+    return (z == 0) ? 0x9E3779B97F4A7C15ULL : z;
+
+}//end rules_seed
+
+
+// ---------------------------------------------------------------------
+// Function
+//     rules_roll_die
+// Inputs
+//     rng
+//         The random number generator state, which gets advanced.
+// Outputs
+//     function result
+// Description
+//     This function rolls a single die, returning 1 thru
+//     NUMBER_OF_SIDES.
+// ---------------------------------------------------------------------
+unsigned char rules_roll_die(uint64_t *rng)
+{
+    // xorshift64*
+    uint64_t x = *rng;
+
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *rng = x;
+
+    return (unsigned char)(((x * 0x2545F4914F6CDD1DULL) >> 32)
+                           % NUMBER_OF_SIDES) + 1;
+
+}//end rules_roll_die
+
+
+// ---------------------------------------------------------------------
+// Function
+//     rules_roll
+// Inputs
+//     dice
+//         The face values of all the dice, which get updated.
+//     keep
+//         A bit mask of dice not to roll; bit 0 is the first die.
+//     rng
+//         The random number generator state, which gets advanced.
+// Outputs
+//     none
+// Description
+//     This function "rolls the dice" that aren't being kept.
+// ---------------------------------------------------------------------
+void rules_roll(unsigned char dice[], const unsigned int keep, uint64_t *rng)
+{
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        if ((keep & (1u << i)) == 0) {
+            dice[i] = rules_roll_die(rng);
+        }
+    }
+
+}//end rules_roll
+
+// end rules.c
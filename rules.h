@@ -0,0 +1,35 @@
+// -------------------------------------------------------------------
+// File: rules.h
+//
+// Name: Marshall Liu
+//
+// Description: This is the header file for the RULES module of the
+//     YAHTZEE game. It holds the dice and scoring rules without any
+//     of the terminal or scorecard state, so that more than one game
+//     can be evaluated at a time.
+// -------------------------------------------------------------------
+
+#ifndef RULES_H
+#define RULES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define NUMBER_OF_DICE       5
+#define NUMBER_OF_SIDES      6
+#define NUMBER_OF_CATEGORIES 13
+#define MAX_ROLLS            3
+#define MAX_TURNS            13
+
+extern int      rules_score(const unsigned char dice[], const int item);
+extern bool     rules_joker(const unsigned char dice[], const unsigned int used);
+extern bool     rules_allowed(const unsigned char dice[],
+                              const unsigned int used, const int item);
+extern int      rules_card_score(const unsigned char dice[],
+                                 const unsigned int used, const int item);
+extern uint64_t rules_seed(const uint64_t seed);
+extern unsigned char rules_roll_die(uint64_t *rng);
+extern void     rules_roll(unsigned char dice[], const unsigned int keep,
+                           uint64_t *rng);
+
+#endif // RULES_H
@@ -31,7 +31,7 @@ struct entry_t {
 // **************************************************************************
 
 // The Scorecard
-static struct entry_t Score[NUMBER_OF_ENTRIES+1]; // row 0 is not used
+static struct entry_t Score[YAHTZEE_BONUS+1]; // row 0 is not used
 
 // The Entry Names in a scorecard
 static char *Entry_names[] = {
@@ -48,7 +48,8 @@ static char *Entry_names[] = {
     "Sm. Straight (score 30)    ",
     "Lg. Straight (score 40)    ",
     "YAHTZEE      (score 50)    ",
-    "Chance       (add all dice)"
+    "Chance       (add all dice)",
+    "YAHTZEE Bonus (100 each)   "
 };
 
     int tot_score;
@@ -73,7 +74,7 @@ static char *Entry_names[] = {
 // ---------------------------------------------------------------------
 void score_reset(void)
 {
-   for(int i = 1; i < (NUMBER_OF_ENTRIES + 1); i++)
+   for(int i = 1; i <= YAHTZEE_BONUS; i++)
    {
         Score[i].value= 0;
         Score[i].used = false;
@@ -98,9 +99,10 @@ void score_display(void)
     + Score[5].value + Score[6].value;
 
     //account for bonus
-    if (tot_score >= 63)
+    bonus = 0;
+    if (tot_score >= BONUS_THRESHOLD)
     {
-        bonus = 35;
+        bonus = SCORE_BONUS;
     }
 
     // total score of left side
@@ -108,7 +110,8 @@ void score_display(void)
 
     //score of right section
     total_right = Score[7].value + Score[8].value + Score[9].value + Score[10].value 
-    + Score[11].value + Score[12].value + Score[13].value;
+    + Score[11].value + Score[12].value + Score[13].value
+    + Score[YAHTZEE_BONUS].value;
 
     // grand total
     grand_total = total_left + total_right;
@@ -123,6 +126,7 @@ void score_display(void)
     printf(" %i %s %34i %47i %76s %80i \n", 4, Entry_names[4], Score[4].value, 11,  Entry_names[11], Score[11].value);
     printf(" %i %s %34i %47i %76s %80i \n", 5, Entry_names[5], Score[5].value, 12,  Entry_names[12], Score[12].value);
     printf(" %i %s %34i %47i %76s %80i \n", 6, Entry_names[6], Score[6].value, 13,  Entry_names[13], Score[13].value);  
+    printf("%46s %49s %80i \n", "", Entry_names[YAHTZEE_BONUS], Score[YAHTZEE_BONUS].value);
 
 /*    for (int i = 0; i < ( NUMBER_OF_ENTRIES + 1); i++){
         if ( Score[i].value == 0 )
@@ -198,7 +202,7 @@ void score_display_final(void)
 
     //prints lower section
     printf("LOWER SECTION \n");
-    for (int i = 7; i < (NUMBER_OF_ENTRIES+ 1); i++)
+    for (int i = 7; i <= YAHTZEE_BONUS; i++)
     {
         printf("   %s %34i", Entry_names[i], Score[i].value);
     }
@@ -225,11 +229,12 @@ void score_display_final(void)
 //     the function returns a non-SUCCESS and no change to the card
 //     happens. The given item must also exist, or the function returns
 //     a non-SUCCESS and no change to the card happens. Otherwise, the
-//     requested change occurs, and a SUCCESS is returned.
+//     requested change occurs, and a SUCCESS is returned. The YAHTZEE
+//     bonus line is never used up; each score given is added to it.
 // ---------------------------------------------------------------------
 int score_set(const int item, const int score)
 {
-    if ( item < 1 || item > 14)
+    if ( item < 1 || item > YAHTZEE_BONUS)
     {
         return !SUCCESS;
     }
@@ -237,6 +242,13 @@ int score_set(const int item, const int score)
     {
         return !SUCCESS;
     }
+    if (item == YAHTZEE_BONUS)
+    {
+        Score[item].value += score;
+        Score[item].used = true;
+
+        return SUCCESS;
+    }
     if (Score[item].used == true )
     {
         return !SUCCESS;
@@ -22,11 +22,16 @@
 #define STRAIGHT_LG       11
 #define YAHTZEE           12
 #define CHANCE            13
+#define YAHTZEE_BONUS     14  // Not an item; the line for bonus YAHTZEEs
 
 #define SCORE_FULL_HOUSE  25
 #define SCORE_STRAIGHT_SM 30
 #define SCORE_STRAIGHT_LG 40
 #define SCORE_YAHTZEE     50
+#define SCORE_YAHTZEE_BONUS 100  // For each YAHTZEE after one scored 50
+
+#define BONUS_THRESHOLD   63  // Upper section total needed for a bonus
+#define SCORE_BONUS       35
 
 #define SUCCESS           0
 
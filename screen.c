@@ -7,14 +7,24 @@
 //     This module sets the foreground and background colors of the
 //     terminal, clears the screen, and resets the terminal back to its
 //     original state.
+//
+//     It can also stand in for a terminal that doesn't exist. With the
+//     virtual terminal, everything written to stdout is captured in
+//     memory a frame at a time (a frame being everything since the
+//     last screen_clear()), and stdin is read from a function supplied
+//     by the caller, so the game can be driven by a script.
 // ----------------------------------------------------------------------
 
+#define _GNU_SOURCE   // for fopencookie()
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <errno.h>
 #include <termios.h>
 #include <unistd.h>
+#include <string.h>
+#include <sys/types.h>
 #include <sys/ioctl.h>
 #include "screen.h"
 
@@ -28,6 +38,7 @@
 #define SET_FOREGROUND_COLOR "\x1b[%i"
 #define SET_BOTH_COLORS      "\x1b[%i;%im"  // background, foreground
 #define COLOR_RESET          "\x1b[0m"
+#define FIRST_FRAME_SIZE     4096
 
 #define NEW_SCREEN() \
         printf(CLEAR_SCREEN); \
@@ -39,6 +50,14 @@
 
 static bool Screen_initialized = false;
 
+// The virtual terminal
+static screen_input_t Input;            // Where keystrokes come from
+static void          *Input_context;
+static char          *Frame;            // The frame being drawn
+static size_t         Frame_length;
+static size_t         Frame_size;       // Room in Frame
+static unsigned long  Frames;           // Frames finished so far
+
 
 // ***********************************************************************
 // *************************** INTERNAL FUNCTIONS ************************
@@ -51,6 +70,76 @@ static void set_colors(void)
 }//end set_colors
 
 
+// ---------------------------------------------------------------------
+// Function
+//     capture_write
+// Inputs
+//     cookie
+//         Not used.
+//     buf
+//         What was written to stdout.
+//     size
+//         How many bytes were written.
+// Outputs
+//     function result
+// Description
+//     This is the write function of the virtual terminal's stdout. It
+//     adds what was written to the current frame, returning how many
+//     bytes were taken (zero if memory ran out).
+// ---------------------------------------------------------------------
+static ssize_t capture_write(void *cookie, const char *buf, size_t size)
+{
+    size_t needed = Frame_length + size + 1;   // +1 for the '\0'
+    size_t new_size;
+    char  *frame;
+
+    (void)cookie;
+    if (needed > Frame_size) {
+        new_size = (Frame_size == 0) ? FIRST_FRAME_SIZE : Frame_size;
+        while (new_size < needed) {
+            new_size *= 2;
+        }
+        frame = realloc(Frame, new_size);
+        if (frame == NULL) {
+            return 0;
+        }
+        Frame      = frame;
+        Frame_size = new_size;
+    }
+
+    memcpy(Frame + Frame_length, buf, size);
+    Frame_length += size;
+    Frame[Frame_length] = '\0';
+
+    return size;
+
+}//end capture_write
+
+
+// ---------------------------------------------------------------------
+// Function
+//     keyboard_read
+// Inputs
+//     cookie
+//         Not used.
+//     buf
+//         Where to put the keystrokes.
+//     size
+//         How much room there is in buf.
+// Outputs
+//     function result
+// Description
+//     This is the read function of the virtual terminal's stdin. It
+//     passes the request on to the caller's input function, returning
+//     how many bytes were read (zero at the end of input).
+// ---------------------------------------------------------------------
+static ssize_t keyboard_read(void *cookie, char *buf, size_t size)
+{
+    (void)cookie;
+    return Input(Input_context, buf, size);
+}//end keyboard_read
+
+
 // ***********************************************************************
 // *************************** EXTERNAL FUNCTIONS ************************
 // ***********************************************************************
@@ -63,11 +152,18 @@ static void set_colors(void)
 // Outputs
 //     none
 // Description
-//     Clears the terminal screen
+//     Clears the terminal screen, which on the virtual terminal means
+//     starting a new frame.
 // ---------------------------------------------------------------------
 void screen_clear(void)
 {
     NEW_SCREEN();
+
+    if (Input != NULL) {
+        // Start a new frame on the virtual terminal
+        ++Frames;
+        Frame_length = 0;
+    }
 }//end screen_clear
 
 
@@ -184,3 +280,96 @@ void screen_text_color(const int color)
 {
     printf(SET_BOTH_COLORS, BACKGROUND_GREEN, color);
 }//end screen_text_color
+
+
+// ---------------------------------------------------------------------
+// Function
+//     screen_init_virtual
+// Inputs
+//     input
+//         The function that supplies keystrokes. It is called like
+//         read(), with context as its first argument.
+//     context
+//         Passed to input.
+// Outputs
+//     none
+// Description
+//     This function is used instead of screen_init() when there's no
+//     terminal. It replaces stdout with a stream that captures frames
+//     in memory, and stdin with a stream that reads from the input
+//     function. Since there's no real screen, any size is big enough.
+//     Like screen_init(), it is intended to be used once.
+// ---------------------------------------------------------------------
+void screen_init_virtual(const screen_input_t input, void *context)
+{
+    cookie_io_functions_t display  = { .write = capture_write };
+    cookie_io_functions_t keyboard = { .read = keyboard_read };
+    FILE                 *out;
+    FILE                 *in;
+
+    if (Screen_initialized) {
+        screen_reset();
+        printf("\n\nError: Screen module initialized twice.\n\n");
+        exit(EXIT_FAILURE);
+    }
+
+    out = fopencookie(NULL, "w", display);
+    in  = fopencookie(NULL, "r", keyboard);
+    if ((out == NULL) || (in == NULL)) {
+        perror("Unable to create the virtual terminal");
+        exit(EXIT_FAILURE);
+    }
+    fflush(stdout);
+    stdout = out;
+    stdin  = in;
+    Input         = input;
+    Input_context = context;
+
+    // Set color scheme and initialize the screen
+    set_colors();
+    NEW_SCREEN();
+
+    // Remember that we've done this
+    Screen_initialized = true;
+
+}//end screen_init_virtual
+
+
+// ---------------------------------------------------------------------
+// Function
+//     screen_text
+// Inputs
+//     none
+// Outputs
+//     function result
+// Description
+//     On the virtual terminal, this returns everything drawn since the
+//     screen was last cleared (escape sequences and all), which is what
+//     a player would be looking at. Otherwise it returns NULL.
+// ---------------------------------------------------------------------
+const char *screen_text(void)
+{
+    if (Input == NULL) {
+        return NULL;
+    }
+
+    fflush(stdout);
+    return (Frame == NULL) ? "" : Frame;
+
+}//end screen_text
+
+
+// ---------------------------------------------------------------------
+// Function
+//     screen_frames
+// Inputs
+//     none
+// Outputs
+//     function result
+// Description
+//     Returns how many frames the virtual terminal has finished.
+// ---------------------------------------------------------------------
+unsigned long screen_frames(void)
+{
+    return Frames;
+}//end screen_frames
@@ -10,13 +10,21 @@
 #ifndef SCREEN_H
 #define SCREEN_H
 
+#include <sys/types.h>
+
 #define BLACK_TEXT 30
 #define WHITE_TEXT 97
 
+// Supplies keystrokes to the virtual terminal, the same way as read()
+typedef ssize_t (*screen_input_t)(void *context, char *buf, size_t size);
+
 extern void screen_init(void);
 extern void screen_reset(void);
 extern void screen_clear(void);
 extern void screen_cursor(const int row, const int col);
 extern void screen_text_color(const int color);
+extern void screen_init_virtual(const screen_input_t input, void *context);
+extern const char *screen_text(void);
+extern unsigned long screen_frames(void);
 
 #endif // SCREEN_H
@@ -0,0 +1,511 @@
+// ----------------------------------------------------------------------
+// File: script.c
+//
+// Name: Al Shaffer & Marshall Liu
+//
+// Description: This is a driver that plays the real interactive game
+//     (play_yahtzee() and everything it calls) from a script instead of
+//     a keyboard, on the SCREEN module's virtual terminal. It plays the
+//     script over and over with a different seed each time, checks
+//     what is on the screen as it goes, and reports how many games and
+//     frames per second it got through.
+//
+//     A script is a text file. Each line is typed into the game as it
+//     is, except for these:
+//
+//         # anything        a comment
+//         ? word word ...   the words must be on the screen, in order
+//
+//     A "?" line is checked when the game next waits for input, against
+//     the frame the player would be looking at. "?" lines after the
+//     last input are checked against the final scorecard.
+//
+//     Without a script file, each game is scripted to choose, roll and
+//     score every turn, and its final total is checked against the same
+//     moves replayed through game_step().
+//
+//     With -x, every game played to the end is appended to a columnar
+//     binary file, the same as ./yahtzee -x does (-p bit-packs it).
+//
+//     Since stdout belongs to the virtual terminal, the report goes to
+//     stderr.
+//
+// Syntax: ./yahtzee_script [-g games] [-s seed] [-x export_file [-p]]
+//                          [script_file]
+// ----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include "screen.h"
+#include "score.h"
+#include "rules.h"
+#include "game.h"
+#include "play.h"
+#include "export.h"
+
+#define DEFAULT_GAMES 1000
+#define DEFAULT_SEED  1
+#define MAX_LINE      256
+#define FIRST_LINES   64
+#define EXPECT        '?'
+#define COMMENT       '#'
+#define ESCAPE        '\x1b'
+#define BASE_10       10
+
+
+// **************************************************************************
+// ****************************  DEFINED TYPES   ****************************
+// **************************************************************************
+
+// A script, and how far the game has gotten through it
+struct script_t {
+    char          **lines;
+    size_t          count;
+    size_t          size;      // Room in lines
+    size_t          next;      // The next line to type or check
+    unsigned long   game;      // Which game is being played
+    unsigned long   failures;  // Expectations that weren't met
+};
+
+
+// **************************************************************************
+// **************************** GLOBAL VARIABLES ****************************
+// **************************************************************************
+
+static struct script_t Script;
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     script_add
+// Inputs
+//     script
+//         The script to add a line to.
+//     line
+//         The line, without a trailing '\n'.
+// Outputs
+//     none
+// Description
+//     This function adds a copy of the line to the end of the script.
+// ---------------------------------------------------------------------
+static void script_add(struct script_t *script, const char *line)
+{
+    size_t size = (script->size == 0) ? FIRST_LINES : script->size * 2;
+    char **lines;
+
+    if (script->count == script->size) {
+        lines = realloc(script->lines, size * sizeof(*script->lines));
+        if (lines == NULL) {
+            perror("script");
+            exit(EXIT_FAILURE);
+        }
+        script->lines = lines;
+        script->size  = size;
+    }
+    script->lines[script->count] = strdup(line);
+    if (script->lines[script->count] == NULL) {
+        perror("script");
+        exit(EXIT_FAILURE);
+    }
+    ++script->count;
+
+}//end script_add
+
+
+// ---------------------------------------------------------------------
+// Function
+//     script_clear
+// Inputs
+//     script
+//         The script to empty.
+// Outputs
+//     none
+// Description
+//     Throws away all the lines of the script.
+// ---------------------------------------------------------------------
+static void script_clear(struct script_t *script)
+{
+    for (size_t i = 0; i < script->count; ++i) {
+        free(script->lines[i]);
+    }
+    script->count = 0;
+    script->next  = 0;
+
+}//end script_clear
+
+
+// ---------------------------------------------------------------------
+// Function
+//     script_load
+// Inputs
+//     script
+//         The script to fill in.
+//     path
+//         The script file.
+// Outputs
+//     function result
+// Description
+//     This function reads a script file, leaving out the comments. The
+//     result is false if the file can't be read.
+// ---------------------------------------------------------------------
+static bool script_load(struct script_t *script, const char *path)
+{
+    FILE *file = fopen(path, "r");
+    char  line[MAX_LINE];
+
+    if (file == NULL) {
+        perror(path);
+        return false;
+    }
+    while (fgets(line, MAX_LINE, file) != NULL) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] != COMMENT) {
+            script_add(script, line);
+        }
+    }
+    fclose(file);
+
+    return true;
+
+}//end script_load
+
+
+// ---------------------------------------------------------------------
+// Function
+//     script_standard
+// Inputs
+//     script
+//         The script to fill in.
+//     seed
+//         The seed the game will be played with.
+// Outputs
+//     none
+// Description
+//     This function writes the script for the built-in game: on odd
+//     turns keep the first die, then roll twice and score the turn's
+//     number. The same moves are replayed through game_step() to find
+//     the final total the scorecard must show.
+// ---------------------------------------------------------------------
+static void script_standard(struct script_t *script, const uint64_t seed)
+{
+    struct game_t        game;
+    struct game_action_t keep  = { GAME_KEEP, 1 };
+    struct game_action_t roll  = { GAME_ROLL, 0 };
+    struct game_action_t score = { GAME_SCORE, 0 };
+    char                 line[MAX_LINE];
+
+    game_new(&game, seed);
+    script_clear(script);
+
+    for (int turn = 1; turn <= MAX_TURNS; ++turn) {
+        snprintf(line, MAX_LINE, "? Turn %i out of %i Roll 1 out of %i",
+                 turn, MAX_TURNS, MAX_ROLLS);
+        script_add(script, line);
+        if (turn % 2 == 1) {
+            script_add(script, "C");
+            script_add(script, "? Die # Keep Roll Enter the die #");
+            script_add(script, "1");
+            script_add(script, "R");
+            game_step(&game, keep, &game);
+        }
+        script_add(script, "R");
+        snprintf(line, MAX_LINE, "? Turn %i out of %i Roll 2 out of %i",
+                 turn, MAX_TURNS, MAX_ROLLS);
+        script_add(script, line);
+        script_add(script, "R");
+        script_add(script, "? Select the item number");
+        snprintf(line, MAX_LINE, "%i", turn);
+        script_add(script, line);
+        game_step(&game, roll, &game);
+        game_step(&game, roll, &game);
+        score.arg = turn;
+        game_step(&game, score, &game);
+    }
+
+    snprintf(line, MAX_LINE, "? GRAND_TOTAL %i", game_total(&game));
+    script_add(script, line);
+
+}//end script_standard
+
+
+// ---------------------------------------------------------------------
+// Function
+//     visible_text
+// Inputs
+//     screen
+//         What was drawn, escape sequences and all.
+// Outputs
+//     function result
+// Description
+//     This function returns a copy of the screen with the terminal
+//     escape sequences (colors and cursor moves) turned into spaces,
+//     which leaves what a player would actually read. The copy is
+//     good until the next call.
+// ---------------------------------------------------------------------
+static const char *visible_text(const char *screen)
+{
+    static char  *text = NULL;
+    static size_t size = 0;
+    size_t        len = strlen(screen);
+    size_t        out = 0;
+
+    if (len + 1 > size) {
+        size = len + 1;
+        text = realloc(text, size);
+        if (text == NULL) {
+            perror("script");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    for (size_t i = 0; i < len; ++i) {
+        if ((screen[i] == ESCAPE) && (screen[i + 1] == '[')) {
+            // Skip to the letter that ends the sequence
+            for (i += 2; (i < len) && !isalpha((unsigned char)screen[i]);
+                 ++i) {
+                ;
+            }
+            text[out++] = ' ';
+        } else {
+            text[out++] = screen[i];
+        }
+    }
+    text[out] = '\0';
+
+    return text;
+
+}//end visible_text
+
+
+// ---------------------------------------------------------------------
+// Function
+//     find_word
+// Inputs
+//     text
+//         The text to search.
+//     word
+//         The word to look for.
+// Outputs
+//     function result
+// Description
+//     This function finds the word in the text, returning where it
+//     ends or NULL if it isn't there. Only whole words count, so "1"
+//     isn't found in "13", but punctuation may be part of the word.
+// ---------------------------------------------------------------------
+static const char *find_word(const char *text, const char *word)
+{
+    size_t      len = strlen(word);
+    const char *found;
+
+    for (found = strstr(text, word); found != NULL;
+         found = strstr(found + 1, word)) {
+        if (((found == text) || !isalnum((unsigned char)found[-1])) &&
+            !isalnum((unsigned char)found[len])) {
+            return found + len;
+        }
+    }
+
+    return NULL;
+
+}//end find_word
+
+
+// ---------------------------------------------------------------------
+// Function
+//     script_check
+// Inputs
+//     script
+//         The script being played.
+// Outputs
+//     none
+// Description
+//     This function checks every "?" line from where the script is up
+//     to, against what is on the screen now. The first few failures are
+//     described on stderr.
+// ---------------------------------------------------------------------
+static void script_check(struct script_t *script)
+{
+    const char *screen = visible_text(screen_text());
+    const char *found;
+    char        words[MAX_LINE];
+    char       *word;
+    char       *save;
+
+    while ((script->next < script->count) &&
+           (script->lines[script->next][0] == EXPECT)) {
+        snprintf(words, MAX_LINE, "%s", script->lines[script->next] + 1);
+        found = screen;
+        for (word = strtok_r(words, " ", &save); word != NULL;
+             word = strtok_r(NULL, " ", &save)) {
+            found = find_word(found, word);
+            if (found == NULL) {
+                break;
+            }
+        }
+
+        if (found == NULL) {
+            if (++script->failures <= 3) {
+                fprintf(stderr, "Game %lu, line %zu: expected \"%s\" but "
+                        "the screen was:\n%s\n\n", script->game,
+                        script->next + 1, script->lines[script->next] + 2,
+                        screen);
+            }
+        }
+        ++script->next;
+    }
+
+}//end script_check
+
+
+// ---------------------------------------------------------------------
+// Function
+//     script_read
+// Inputs
+//     context
+//         The script being played.
+//     buf
+//         Where to put the keystrokes.
+//     size
+//         How much room there is in buf.
+// Outputs
+//     function result
+// Description
+//     This is the virtual terminal's keyboard. The game only asks for
+//     more input once it has drawn its prompt, so that's when the "?"
+//     lines are checked. Then the next line is typed, with its '\n'.
+//     The result is how many bytes were typed, or zero at the end of
+//     the script.
+// ---------------------------------------------------------------------
+static ssize_t script_read(void *context, char *buf, size_t size)
+{
+    struct script_t *script = context;
+    size_t           len;
+
+    script_check(script);
+    if (script->next == script->count) {
+        return 0;
+    }
+
+    len = strlen(script->lines[script->next]);
+    if (len + 1 > size) {
+        len = size - 1;
+    }
+    memcpy(buf, script->lines[script->next], len);
+    buf[len] = '\n';
+    ++script->next;
+
+    return len + 1;
+
+}//end script_read
+
+
+// **************************************************************************
+// *********************************  MAIN **********************************
+// **************************************************************************
+int main(int argc, char *argv[])
+{
+    unsigned long    games = DEFAULT_GAMES;
+    uint64_t         seed = DEFAULT_SEED;
+    const char      *path = NULL;
+    const char      *export_path = NULL;
+    bool             packed = false;
+    struct export_t *out = NULL;
+    struct timespec  start;
+    struct timespec  end;
+    double           seconds;
+    size_t           last;
+    int              opt;
+
+    while ((opt = getopt(argc, argv, "g:s:x:p")) != -1) {
+        if (opt == 'g') {
+            games = strtoul(optarg, NULL, BASE_10);
+        } else if (opt == 's') {
+            seed = strtoull(optarg, NULL, BASE_10);
+        } else if (opt == 'x') {
+            export_path = optarg;
+        } else if (opt == 'p') {
+            packed = true;
+        } else {
+            fprintf(stderr, "Syntax: %s [-g games] [-s seed] "
+                    "[-x export_file [-p]] [script_file]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (export_path != NULL) {
+        out = export_open(export_path, packed);
+        if (out == NULL) {
+            perror(export_path);
+            return EXIT_FAILURE;
+        }
+    }
+    if (optind < argc) {
+        path = argv[optind];
+        if (!script_load(&Script, path)) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    screen_init_virtual(script_read, &Script);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (Script.game = 0; Script.game < games; ++Script.game) {
+        if (path == NULL) {
+            script_standard(&Script, seed + Script.game);
+        }
+        Script.next = 0;
+        clearerr(stdin);
+
+        score_reset();
+        play_seed(seed + Script.game);
+        play_yahtzee();
+
+        // Whatever hasn't been typed is never going to be, so only the
+        // "?" lines after the last input are left to check
+        last = Script.count;
+        while ((last > Script.next) && (Script.lines[last - 1][0] == EXPECT)) {
+            --last;
+        }
+        Script.next = last;
+
+        // Check the rest against the final scorecard
+        screen_clear();
+        score_display();
+        script_check(&Script);
+
+        if ((out != NULL) && !play_game()->quit &&
+            (export_append(out, play_game()) != SUCCESS)) {
+            perror(export_path);
+            return EXIT_FAILURE;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    fprintf(stderr, "%lu games, %lu frames, %lu failed checks in %.3f s\n",
+            games, screen_frames(), Script.failures, seconds);
+    fprintf(stderr, "%.0f games/sec, %.0f frames/sec\n",
+            games / seconds, screen_frames() / seconds);
+
+    script_clear(&Script);
+    free(Script.lines);
+    if ((out != NULL) && (export_close(out) != SUCCESS)) {
+        perror(export_path);
+        return EXIT_FAILURE;
+    }
+
+    return (Script.failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+} // end main
+
+// end script.c
@@ -0,0 +1,843 @@
+// ----------------------------------------------------------------------
+// File: search.c
+//
+// Name: Al Shaffer & Marshall Liu
+//
+// Description: This SEARCH module picks which dice to keep by looking
+//     ahead through the rest of the turn, for players that have no
+//     solved table and only a fixed time per decision.
+//
+//     The dice are searched as how many show each face, so the up to
+//     32 ways of keeping some of five dice become only the different
+//     ones, and a re-roll of k dice has at most 252 outcomes, each
+//     with its chance. What the turn is worth is the best the dice can
+//     be scored at its end (by the Joker rule, with any YAHTZEE bonus),
+//     with each upper section point also worth its share of the bonus
+//     until the bonus is made. There's no table
+//     of what comes after the turn, so this is a greedy player, but
+//     one that plays the turn itself right.
+//
+//     Searching is branch and bound. Each item has an optimistic bound
+//     on what the dice could still score in it, from score.h (a full
+//     house is at most SCORE_FULL_HOUSE, a face at most five of it,
+//     and so on) and whether the kept dice can still make it. Keeps
+//     are tried best bound first, and a keep, or the rest of a keep's
+//     outcomes, is cut off as soon as even its bound can't beat the
+//     best keep found so far.
+//
+//     With two rolls to go, the search first looks just one roll ahead
+//     (quick, and a good order to try keeps in), then the whole turn.
+//     If the deadline comes first, it returns the best keep it has
+//     finished looking at, at the deepest level it got to, or, if it
+//     didn't finish any, the dice showing the most common face.
+// ----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include "score.h"
+#include "rules.h"
+#include "game.h"
+#include "search.h"
+
+#define MAX_OUTCOMES 252    // Rolls of five dice, in any order
+#define MAX_KEEPS    32     // Ways to keep some of five dice
+#define ALL_DICE     ((1u << NUMBER_OF_DICE) - 1)
+#define SMALL_RUN    4      // Faces in a row for a small straight
+#define LARGE_RUN    5
+#define NS_PER_US    1000
+#define NS_PER_SEC   1000000000L
+
+// What one upper section point is worth toward the bonus
+#define BONUS_SHARE  ((float)SCORE_BONUS / BONUS_THRESHOLD)
+
+
+// **************************************************************************
+// ****************************  DEFINED TYPES   ****************************
+// **************************************************************************
+
+// One way some dice can come up, in any order
+struct outcome_t {
+    unsigned char count[NUMBER_OF_SIDES + 1];    // By face
+    int           key;
+    float         chance;
+};
+
+// One way to keep some of the dice
+struct keep_t {
+    unsigned char count[NUMBER_OF_SIDES + 1];
+    int           key;        // key_of() the kept dice
+    int           free;       // Dice to roll
+    float         bound;      // The most it could be worth
+    float         value;      // What it's worth, once looked at
+};
+
+// One decision being searched
+struct context_t {
+    struct search_t *s;
+    unsigned int     used;        // Items used, bit item
+    bool             fifty;       // Whether YAHTZEE was scored 50
+    bool             bonus_open;  // Whether upper points still count more
+    struct timespec  deadline;
+    bool             timed;       // Whether there is a deadline
+};
+
+
+// **************************************************************************
+// **************************** GLOBAL VARIABLES ****************************
+// **************************************************************************
+
+static struct outcome_t Outcomes[NUMBER_OF_DICE + 1][MAX_OUTCOMES];
+static int              Outcome_count[NUMBER_OF_DICE + 1];
+static int              Power[NUMBER_OF_SIDES + 1];   // Of 6, by face
+static bool             Built;
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     key_of
+// Inputs
+//     count
+//         How many dice show each face.
+// Outputs
+//     function result
+// Description
+//     Returns a number for the dice, less than SEARCH_KEYS.
+// ---------------------------------------------------------------------
+static int key_of(const unsigned char count[])
+{
+    int key = 0;
+
+    for (int f = 1; f <= NUMBER_OF_SIDES; ++f) {
+        key += count[f] * Power[f];
+    }
+
+    return key;
+
+}//end key_of
+
+
+// ---------------------------------------------------------------------
+// Function
+//     add_outcomes
+// Inputs
+//     dice
+//         How many dice are rolled.
+//     face
+//         The lowest face still to be given a count.
+//     count
+//         The counts so far.
+//     left
+//         Dice not given a face yet.
+//     chance
+//         The number of orders the counts so far can come up in, over
+//         6 ^ dice.
+// Outputs
+//     none
+// Description
+//     This function adds every outcome of rolling the dice that goes
+//     on from the counts so far.
+// ---------------------------------------------------------------------
+static void add_outcomes(const int dice, const int face, unsigned char count[],
+                         const int left, const double chance)
+{
+    struct outcome_t *o;
+    double            ways = chance;
+
+    if (face == NUMBER_OF_SIDES) {
+        count[face] = left;
+        for (int n = 2; n <= left; ++n) {
+            ways /= n;
+        }
+        o = &Outcomes[dice][Outcome_count[dice]++];
+        memcpy(o->count, count, sizeof(o->count));
+        o->key    = key_of(count);
+        o->chance = ways;
+        return;
+    }
+
+    for (int n = 0; n <= left; ++n) {
+        count[face] = n;
+        add_outcomes(dice, face + 1, count, left - n, ways);
+        ways /= n + 1;
+    }
+
+}//end add_outcomes
+
+
+// ---------------------------------------------------------------------
+// Function
+//     build
+// Inputs
+//     none
+// Outputs
+//     none
+// Description
+//     This function lists the outcomes of rolling 0 thru 5 dice, the
+//     first time it's called.
+// ---------------------------------------------------------------------
+static void build(void)
+{
+    unsigned char count[NUMBER_OF_SIDES + 1] = { 0 };
+    double        chance;
+
+    if (Built) {
+        return;
+    }
+    Power[1] = 1;
+    for (int f = 2; f <= NUMBER_OF_SIDES; ++f) {
+        Power[f] = Power[f - 1] * NUMBER_OF_SIDES;
+    }
+    for (int dice = 0; dice <= NUMBER_OF_DICE; ++dice) {
+        chance = 1;
+        for (int n = 2; n <= dice; ++n) {
+            chance *= n;
+        }
+        for (int n = 0; n < dice; ++n) {
+            chance /= NUMBER_OF_SIDES;
+        }
+        add_outcomes(dice, 1, count, dice, chance);
+    }
+    Built = true;
+
+}//end build
+
+
+// ---------------------------------------------------------------------
+// Function
+//     item_value
+// Inputs
+//     c
+//         The decision.
+//     item
+//         A scorecard item.
+//     score
+//         What the dice score in it.
+// Outputs
+//     function result
+// Description
+//     Returns what scoring that is worth to the search.
+// ---------------------------------------------------------------------
+static float item_value(const struct context_t *c, const int item,
+                        const int score)
+{
+    if ((item <= SIXES) && c->bonus_open) {
+        return score * (1 + BONUS_SHARE);
+    }
+
+    return score;
+
+}//end item_value
+
+
+// ---------------------------------------------------------------------
+// Function
+//     leaf
+// Inputs
+//     c
+//         The decision.
+//     count
+//         Five dice.
+//     key
+//         Their key_of().
+//     item
+//         Where to put the best item to score them in, or NULL.
+// Outputs
+//     function result
+// Description
+//     Returns what scoring the dice now is worth: the most they're
+//     worth in any item the Joker rule allows.
+// ---------------------------------------------------------------------
+static float leaf(const struct context_t *c, const unsigned char count[],
+                  const int key, int *item)
+{
+    struct search_t *s = c->s;
+    unsigned char    dice[NUMBER_OF_DICE];
+    int              n = 0;
+    float            bonus;
+    float            value;
+
+    if ((s->leaf_stamp[key] == s->stamp) && (item == NULL)) {
+        return s->leaf[key];
+    }
+
+    for (int f = 1; f <= NUMBER_OF_SIDES; ++f) {
+        for (int i = 0; i < count[f]; ++i) {
+            dice[n++] = f;
+        }
+    }
+    s->leaf[key] = -1;
+    bonus = (c->fifty && rules_joker(dice, c->used)) ? SCORE_YAHTZEE_BONUS : 0;
+    for (int i = ACES; i <= CHANCE; ++i) {
+        if (!rules_allowed(dice, c->used, i)) {
+            continue;
+        }
+        value = bonus + item_value(c, i, rules_card_score(dice, c->used, i));
+        if (value > s->leaf[key]) {
+            s->leaf[key] = value;
+            if (item != NULL) {
+                *item = i;
+            }
+        }
+    }
+    s->leaf_stamp[key] = s->stamp;
+    ++s->nodes;
+
+    return s->leaf[key];
+
+}//end leaf
+
+
+// ---------------------------------------------------------------------
+// Function
+//     bound
+// Inputs
+//     c
+//         The decision.
+//     count
+//         The dice kept.
+//     free
+//         How many dice are rolled, once, before scoring.
+// Outputs
+//     function result
+// Description
+//     Returns the most the dice could be worth once scored. It only
+//     asks whether the kept dice can still make each item, and what
+//     the item's score could be at best. A Joker could score the most
+//     of any lower item, and a YAHTZEE bonus on top.
+// ---------------------------------------------------------------------
+static float bound(const struct context_t *c, const unsigned char count[],
+                   const int free)
+{
+    int   kept = NUMBER_OF_DICE - free;
+    int   sum = 0;
+    int   most = 0;
+    int   faces = 0;
+    int   run;
+    bool  joker;
+    float best = 0;
+    float value;
+
+    for (int f = 1; f <= NUMBER_OF_SIDES; ++f) {
+        sum  += f * count[f];
+        most  = (count[f] > most) ? count[f] : most;
+        faces += (count[f] > 0);
+    }
+    joker = (c->used & (1u << YAHTZEE)) && (faces <= 1);
+
+    for (int item = ACES; item <= CHANCE; ++item) {
+        if (c->used & (1u << item)) {
+            continue;
+        }
+        value = 0;
+        if (item <= SIXES) {
+            value = item_value(c, item, (count[item] + free) * item);
+        } else if ((item == KIND3) || (item == KIND4) || (item == CHANCE)) {
+            if ((item == CHANCE) ||
+                (most + free >= ((item == KIND3) ? 3 : 4))) {
+                value = sum + free * NUMBER_OF_SIDES;
+            }
+        } else if (item == FULL_HOUSE) {
+            value = ((faces <= 2) && (most <= 3)) ? SCORE_FULL_HOUSE : 0;
+        } else if (item == YAHTZEE) {
+            value = (faces <= 1) ? SCORE_YAHTZEE : 0;
+        } else {
+            // A straight needs every kept die but (5 - run) to be a
+            // different face of it
+            run = (item == STRAIGHT_SM) ? SMALL_RUN : LARGE_RUN;
+            for (int low = 1; low + run - 1 <= NUMBER_OF_SIDES; ++low) {
+                faces = 0;
+                for (int f = low; f < low + run; ++f) {
+                    faces += (count[f] > 0);
+                }
+                if (kept - faces <= NUMBER_OF_DICE - run) {
+                    value = (item == STRAIGHT_SM) ? SCORE_STRAIGHT_SM
+                                                  : SCORE_STRAIGHT_LG;
+                }
+            }
+        }
+        best = (value > best) ? value : best;
+    }
+    if (joker) {
+        best  = (SCORE_STRAIGHT_LG > best) ? SCORE_STRAIGHT_LG : best;
+        best += c->fifty ? SCORE_YAHTZEE_BONUS : 0;
+    }
+
+    return best;
+
+}//end bound
+
+
+// ---------------------------------------------------------------------
+// Function
+//     list_keeps
+// Inputs
+//     c
+//         The decision.
+//     count
+//         Five dice.
+//     keeps
+//         Where to put the different ways to keep some of them.
+// Outputs
+//     function result
+// Description
+//     This function lists the ways to keep some (not all) of the dice,
+//     best bound first, for a last roll, and returns how many.
+// ---------------------------------------------------------------------
+static int list_keeps(const struct context_t *c, const unsigned char count[],
+                      struct keep_t keeps[])
+{
+    struct keep_t k;
+    int           n = 0;
+    int           ways = 1;
+    int           w;
+    int           j;
+
+    for (int f = 1; f <= NUMBER_OF_SIDES; ++f) {
+        ways *= count[f] + 1;
+    }
+
+    for (int i = 0; i < ways - 1; ++i) {   // The last is keeping all
+        memset(&k, 0, sizeof(k));
+        k.free = NUMBER_OF_DICE;
+        w      = i;
+        for (int f = 1; f <= NUMBER_OF_SIDES; ++f) {
+            k.count[f] = w % (count[f] + 1);
+            w         /= count[f] + 1;
+            k.free    -= k.count[f];
+        }
+        k.key   = key_of(k.count);
+        k.bound = bound(c, k.count, k.free);
+
+        // Insertion sort, by bound
+        for (j = n; (j > 0) && (keeps[j - 1].bound < k.bound); --j) {
+            keeps[j] = keeps[j - 1];
+        }
+        keeps[j] = k;
+        ++n;
+    }
+
+    return n;
+
+}//end list_keeps
+
+
+// ---------------------------------------------------------------------
+// Function
+//     last_roll
+// Inputs
+//     c
+//         The decision.
+//     count
+//         Five dice, with one roll left.
+//     key
+//         Their key_of().
+// Outputs
+//     function result
+// Description
+//     Returns what the dice are worth with one roll left, playing it
+//     right: the best of scoring now and each keep's average over its
+//     outcomes. It's exact, in spite of cutting keeps off.
+// ---------------------------------------------------------------------
+static float last_roll(const struct context_t *c, const unsigned char count[],
+                       const int key)
+{
+    struct search_t *s = c->s;
+    struct keep_t    keeps[MAX_KEEPS];
+    unsigned char    next[NUMBER_OF_SIDES + 1];
+    int              n;
+    float            best;
+    float            sum;
+    float            left;
+    int              o;
+
+    if (s->last_stamp[key] == s->stamp) {
+        return s->last[key];
+    }
+
+    best = leaf(c, count, key, NULL);
+    n    = list_keeps(c, count, keeps);
+    for (int k = 0; k < n; ++k) {
+        if (keeps[k].bound <= best) {
+            s->pruned += n - k;      // And so can none after it
+            break;
+        }
+        sum  = 0;
+        left = 1;
+        for (o = 0; o < Outcome_count[keeps[k].free]; ++o) {
+            for (int f = 1; f <= NUMBER_OF_SIDES; ++f) {
+                next[f] = keeps[k].count[f] +
+                          Outcomes[keeps[k].free][o].count[f];
+            }
+            sum  += Outcomes[keeps[k].free][o].chance *
+                    leaf(c, next, keeps[k].key +
+                               Outcomes[keeps[k].free][o].key, NULL);
+            left -= Outcomes[keeps[k].free][o].chance;
+            if (sum + left * keeps[k].bound <= best) {
+                ++s->pruned;
+                break;
+            }
+        }
+        if ((o == Outcome_count[keeps[k].free]) && (sum > best)) {
+            best = sum;
+        }
+    }
+
+    s->last[key]       = best;
+    s->last_stamp[key] = s->stamp;
+
+    return best;
+
+}//end last_roll
+
+
+// ---------------------------------------------------------------------
+// Function
+//     past_deadline
+// Inputs
+//     c
+//         The decision.
+// Outputs
+//     function result
+// Description
+//     Returns true if the decision is out of time.
+// ---------------------------------------------------------------------
+static bool past_deadline(const struct context_t *c)
+{
+    struct timespec now;
+
+    if (!c->timed) {
+        return false;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (now.tv_sec > c->deadline.tv_sec) ||
+           ((now.tv_sec == c->deadline.tv_sec) &&
+            (now.tv_nsec >= c->deadline.tv_nsec));
+
+}//end past_deadline
+
+
+// ---------------------------------------------------------------------
+// Function
+//     look_ahead
+// Inputs
+//     c
+//         The decision.
+//     count
+//         The dice.
+//     keeps
+//         The keeps to look at, in the order to look at them. Their
+//         values are set.
+//     n
+//         How many there are.
+//     depth
+//         How many rolls to look ahead: 1 or 2.
+//     best
+//         What scoring now is worth; set to the best found.
+// Outputs
+//     function result
+// Description
+//     This function looks at each keep in turn, and returns the number
+//     of the best (n for scoring now), or -1 if it ran out of time
+//     before finishing the first keep that could beat scoring now.
+//     Keeps it didn't finish have a value of -1.
+// ---------------------------------------------------------------------
+static int look_ahead(const struct context_t *c, struct keep_t keeps[],
+                      const int n, const int depth, float *best)
+{
+    struct search_t *s = c->s;
+    unsigned char    next[NUMBER_OF_SIDES + 1];
+    int              best_keep = n;
+    float            top;
+    float            sum;
+    float            left;
+    float            value;
+    int              key;
+    int              o;
+
+    memset(next, 0, sizeof(next));
+    top = (depth == 1) ? 0 : bound(c, next, NUMBER_OF_DICE);
+    for (int k = 0; k < n; ++k) {
+        keeps[k].value = -1;
+    }
+
+    for (int k = 0; k < n; ++k) {
+        // With a roll after this one, every die can still change
+        value = (depth == 1) ? keeps[k].bound : top;
+        if (value <= *best) {
+            ++s->pruned;
+            continue;
+        }
+        sum  = 0;
+        left = 1;
+        for (o = 0; o < Outcome_count[keeps[k].free]; ++o) {
+            for (int f = 1; f <= NUMBER_OF_SIDES; ++f) {
+                next[f] = keeps[k].count[f] +
+                          Outcomes[keeps[k].free][o].count[f];
+            }
+            key   = keeps[k].key + Outcomes[keeps[k].free][o].key;
+            sum  += Outcomes[keeps[k].free][o].chance *
+                    ((depth == 1) ? leaf(c, next, key, NULL)
+                                  : last_roll(c, next, key));
+            left -= Outcomes[keeps[k].free][o].chance;
+            if (sum + left * value <= *best) {
+                ++s->pruned;
+                break;
+            }
+            if (past_deadline(c)) {
+                s->timed_out = true;
+                return best_keep;
+            }
+        }
+        if (o == Outcome_count[keeps[k].free]) {
+            keeps[k].value = sum;
+            if (sum > *best) {
+                *best     = sum;
+                best_keep = k;
+            }
+        }
+    }
+
+    return best_keep;
+
+}//end look_ahead
+
+
+// ---------------------------------------------------------------------
+// Function
+//     dice_for
+// Inputs
+//     game
+//         The game.
+//     count
+//         The dice wanted, by face.
+// Outputs
+//     function result
+// Description
+//     Returns which of the game's dice (a bit mask) to keep to keep
+//     those, choosing dice already kept where it can.
+// ---------------------------------------------------------------------
+static unsigned int dice_for(const struct game_t *game,
+                             const unsigned char count[])
+{
+    unsigned char need[NUMBER_OF_SIDES + 1];
+    unsigned int  keep = 0;
+
+    memcpy(need, count, sizeof(need));
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+            if (((pass == 0) == !!(game->keep & (1u << i))) &&
+                !(keep & (1u << i)) && (need[game->dice[i]] > 0)) {
+                --need[game->dice[i]];
+                keep |= 1u << i;
+            }
+        }
+    }
+
+    return keep;
+
+}//end dice_for
+
+
+// ************************************************************************
+// *************************  EXTERNAL FUNCTIONS **************************
+// ************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     search_init
+// Inputs
+//     s
+//         A search to start.
+// Outputs
+//     none
+// Description
+//     This function readies a search for its first decision.
+// ---------------------------------------------------------------------
+void search_init(struct search_t *s)
+{
+    build();
+    memset(s, 0, sizeof(*s));
+    s->turn = -1;
+    s->depth = -1;
+
+}//end search_init
+
+
+// ---------------------------------------------------------------------
+// Function
+//     search_keep
+// Inputs
+//     s
+//         The search, from search_init().
+//     game
+//         A game that isn't over.
+//     deadline_us
+//         How long it may take, in microseconds; 0 for no limit.
+// Outputs
+//     function result
+// Description
+//     Returns which dice to keep (a bit mask) for the next roll; all
+//     of them means the dice should be scored now.
+// ---------------------------------------------------------------------
+unsigned int search_keep(struct search_t *s, const struct game_t *game,
+                         const long deadline_us)
+{
+    struct context_t c = { s, game->used,
+                           game->score[YAHTZEE] == SCORE_YAHTZEE,
+                           game_upper(game) < BONUS_THRESHOLD,
+                           { 0, 0 }, deadline_us > 0 };
+    unsigned char    count[NUMBER_OF_SIDES + 1] = { 0 };
+    struct keep_t    keeps[MAX_KEEPS];
+    struct keep_t    first[MAX_KEEPS];
+    int              n;
+    int              best_keep;
+    int              key;
+    int              face;
+    int              j;
+    float            best;
+
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        ++count[game->dice[i]];
+    }
+    key = key_of(count);
+    if ((s->used == game->used) && (s->fifty == c.fifty) &&
+        (s->upper == game_upper(game)) &&
+        (s->turn == game->turn) && (s->roll == game->roll) &&
+        (s->key == key)) {
+        return s->want;
+    }
+
+    // What the dice are worth only depends on the scorecard
+    if ((s->used != game->used) || (s->fifty != c.fifty) ||
+        (s->upper != game_upper(game)) || (s->turn != game->turn)) {
+        if (++s->stamp == 0) {
+            memset(s->leaf_stamp, 0, sizeof(s->leaf_stamp));
+            memset(s->last_stamp, 0, sizeof(s->last_stamp));
+            s->stamp = 1;
+        }
+    }
+    s->used      = game->used;
+    s->fifty     = c.fifty;
+    s->upper     = game_upper(game);
+    s->turn      = game->turn;
+    s->roll      = game->roll;
+    s->key       = key;
+    s->want      = ALL_DICE;
+    s->depth     = 0;
+    s->timed_out = false;
+    s->nodes     = 0;
+    s->pruned    = 0;
+    if (game->roll >= MAX_ROLLS) {
+        return s->want;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &c.deadline);
+    c.deadline.tv_nsec += (deadline_us % (NS_PER_SEC / NS_PER_US)) * NS_PER_US;
+    c.deadline.tv_sec  += deadline_us / (NS_PER_SEC / NS_PER_US) +
+                          c.deadline.tv_nsec / NS_PER_SEC;
+    c.deadline.tv_nsec %= NS_PER_SEC;
+
+    // Until something better is found, go for the most common face
+    memset(keeps[0].count, 0, sizeof(keeps[0].count));
+    face = NUMBER_OF_SIDES;
+    for (int f = NUMBER_OF_SIDES; f >= 1; --f) {
+        face = (count[f] > count[face]) ? f : face;
+    }
+    keeps[0].count[face] = count[face];
+    s->want = dice_for(game, keeps[0].count);
+
+    // Then one roll ahead
+    n    = list_keeps(&c, count, keeps);
+    best = leaf(&c, count, key, NULL);
+    best_keep = look_ahead(&c, keeps, n, 1, &best);
+    if ((best_keep < n) || !s->timed_out) {
+        s->want = (best_keep < n) ? dice_for(game, keeps[best_keep].count)
+                                  : ALL_DICE;
+    }
+    if (s->timed_out) {
+        return s->want;
+    }
+    s->depth = 1;
+    if (game->roll == MAX_ROLLS - 1) {
+        return s->want;
+    }
+
+    // Then the whole turn, best keep so far first
+    for (int i = 0; i < n; ++i) {
+        for (j = i; (j > 0) && (first[j - 1].value < keeps[i].value); --j) {
+            first[j] = first[j - 1];
+        }
+        first[j] = keeps[i];
+    }
+    best = leaf(&c, count, key, NULL);
+    best_keep = look_ahead(&c, first, n, 2, &best);
+    if ((best_keep < n) || !s->timed_out) {
+        s->want = (best_keep < n) ? dice_for(game, first[best_keep].count)
+                                  : ALL_DICE;
+    }
+    if (!s->timed_out) {
+        s->depth = 2;
+    }
+
+    return s->want;
+
+}//end search_keep
+
+
+// ---------------------------------------------------------------------
+// Function
+//     search_choose
+// Inputs
+//     s
+//         The search, from search_init().
+//     game
+//         A game that isn't over.
+//     deadline_us
+//         How long a new decision may take, in microseconds; 0 for no
+//         limit.
+// Outputs
+//     function result
+// Description
+//     Returns what to do next: switch a die between keep and roll,
+//     roll, or score (in the item the dice are worth the most in).
+// ---------------------------------------------------------------------
+struct game_action_t search_choose(struct search_t *s,
+                                   const struct game_t *game,
+                                   const long deadline_us)
+{
+    struct game_action_t action = { GAME_SCORE, 0 };
+    struct context_t     c = { s, game->used,
+                               game->score[YAHTZEE] == SCORE_YAHTZEE,
+                               game_upper(game) < BONUS_THRESHOLD,
+                               { 0, 0 }, false };
+    unsigned char        count[NUMBER_OF_SIDES + 1] = { 0 };
+    unsigned int         want = search_keep(s, game, deadline_us);
+
+    if (want != ALL_DICE) {
+        action.type = GAME_ROLL;
+        if (want != game->keep) {
+            action.type = GAME_KEEP;
+            action.arg  = __builtin_ctz(want ^ game->keep) + 1;
+        }
+        return action;
+    }
+
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        ++count[game->dice[i]];
+    }
+    leaf(&c, count, key_of(count), &action.arg);
+
+    return action;
+
+}//end search_choose
+
+// end search.c
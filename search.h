@@ -0,0 +1,54 @@
+// -------------------------------------------------------------------
+// File: search.h
+//
+// Name: Marshall Liu
+//
+// Description: This is the header file for the SEARCH module, which
+//     picks the dice to keep by searching the rest of the turn, within
+//     a time limit, without any solved table.
+// -------------------------------------------------------------------
+
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rules.h"
+#include "game.h"
+
+#define SEARCH_KEYS 46656   // Dice by how many of each face, base 6
+
+// One search's memory, and the answer it last gave. It's big, so keep
+// one around rather than on the stack.
+struct search_t {
+    // The decision the answer is for
+    unsigned int used;
+    bool         fifty;        // Whether YAHTZEE was scored 50
+    int          upper;
+    int          turn;
+    int          roll;
+    int          key;
+    unsigned int want;         // The dice to keep; all of them to score
+
+    // What the search knows about the dice of this turn
+    uint32_t     stamp;        // Marks this turn's entries
+    uint32_t     leaf_stamp[SEARCH_KEYS];
+    float        leaf[SEARCH_KEYS];      // Scoring a roll now
+    uint32_t     last_stamp[SEARCH_KEYS];
+    float        last[SEARCH_KEYS];      // A roll with one roll left
+
+    // How the last search went
+    uint64_t     nodes;        // Rolls looked at
+    uint64_t     pruned;       // Keeps or outcomes cut off by a bound
+    int          depth;        // Rolls ahead it finished looking, or -1
+    bool         timed_out;
+};
+
+extern void search_init(struct search_t *s);
+extern unsigned int search_keep(struct search_t *s, const struct game_t *game,
+                                const long deadline_us);
+extern struct game_action_t search_choose(struct search_t *s,
+                                          const struct game_t *game,
+                                          const long deadline_us);
+
+#endif // SEARCH_H
@@ -0,0 +1,299 @@
+// ----------------------------------------------------------------------
+// File: sens.c
+//
+// Name: Al Shaffer & Marshall Liu
+//
+// Description: This SENS module works out, for house rules that change
+//     what a full house, a straight, a YAHTZEE or a bonus is worth, how
+//     much the best expected score would change, without solving the
+//     game again for each value to try.
+//
+//     A scorecard's value is a sum of what's scored along the way, so
+//     with the play held fixed it moves with a constant by how many
+//     times the constant is expected to be scored from there on. While
+//     the play is the best play, that is the derivative of the best
+//     value too: a small change to a constant only changes which play
+//     is best where two plays were already worth the same. So each
+//     scorecard carries the counts next to its value, through the same
+//     backward pass (as the SOLVER module does it, by layers of
+//     scorecard masks): averaged along with the value where the dice
+//     are rolled, and taken from whichever choice is best by value
+//     where the player chooses.
+//
+//     The upper bonus's threshold is a whole number of points, with no
+//     derivative, so it isn't one of the constants.
+// ----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "score.h"
+#include "rules.h"
+#include "game.h"
+#include "solver.h"
+#include "sens.h"
+
+#define FULL_MASK (SOLVER_MASKS - 1)
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     best_keeps
+// Inputs
+//     keeps
+//         What each keep is worth, SENS_COLUMNS values per keep.
+//     rolls
+//         Where to put what holding each roll is worth.
+// Outputs
+//     none
+// Description
+//     This function is solver_best() for a value and its counts: each
+//     roll takes all the columns of the keep that's worth the most,
+//     instead of the best of each column on its own.
+// ---------------------------------------------------------------------
+static void best_keeps(const float keeps[][SENS_COLUMNS],
+                       float rolls[][SENS_COLUMNS])
+{
+    const struct solver_dice_t *d = solver_dice();
+    int                         best;
+
+    for (int r = 0; r < SOLVER_ROLLS; ++r) {
+        best = SOLVER_FIRST_ROLL + r;
+        for (int s = d->sub_start[r]; s < d->sub_start[r + 1]; ++s) {
+            if (keeps[d->subs[s]][0] > keeps[best][0]) {
+                best = d->subs[s];
+            }
+        }
+        memcpy(rolls[r], keeps[best], sizeof(rolls[r]));
+    }
+
+}//end best_keeps
+
+
+// ---------------------------------------------------------------------
+// Function
+//     score_roll
+// Inputs
+//     s
+//         The values and counts being solved.
+//     state
+//         The scorecard.
+//     r
+//         The roll, after the last roll of the turn.
+//     out
+//         Where to put what the roll is worth, and its counts.
+// Outputs
+//     none
+// Description
+//     This function scores the roll in the best item it can be, and
+//     counts the constants that scoring it earns.
+// ---------------------------------------------------------------------
+static void score_roll(const struct sens_t *s, const int state, const int r,
+                       float out[])
+{
+    unsigned int card = state / SOLVER_UPPER;
+    int          upper = state % SOLVER_UPPER;
+    int          yahtzee_bonus = solver_yahtzee_bonus(state, r);
+    int          best_item = 0;
+    int          best_score = 0;
+    int          best_next = 0;
+    float        best = -1;
+    float        value;
+    unsigned int items;
+    int          item;
+    int          score;
+    int          next;
+
+    for (items = solver_items(state, r); items != 0; items &= items - 1) {
+        item  = __builtin_ctz(items) + ACES;
+        score = solver_item_score(state, r, item);
+        next  = solver_state(solver_card_after(card, item, score),
+                             solver_upper_after(upper, item, score));
+        value = score + solver_bonus_after(upper, item, score) +
+                s->at[next][0];
+        if (value > best) {
+            best       = value;
+            best_item  = item;
+            best_score = score;
+            best_next  = next;
+        }
+    }
+
+    memcpy(out, s->at[best_next], SENS_COLUMNS * sizeof(float));
+    out[0] = best + yahtzee_bonus;
+    out[1 + SENS_FULL_HOUSE]  += (best_item == FULL_HOUSE) &&
+                                 (best_score == SCORE_FULL_HOUSE);
+    out[1 + SENS_STRAIGHT_SM] += (best_item == STRAIGHT_SM) &&
+                                 (best_score == SCORE_STRAIGHT_SM);
+    out[1 + SENS_STRAIGHT_LG] += (best_item == STRAIGHT_LG) &&
+                                 (best_score == SCORE_STRAIGHT_LG);
+    out[1 + SENS_YAHTZEE]     += (best_item == YAHTZEE) &&
+                                 (best_score == SCORE_YAHTZEE);
+    out[1 + SENS_YAHTZEE_BONUS] += (yahtzee_bonus > 0);
+    out[1 + SENS_BONUS] += (solver_bonus_after(upper, best_item,
+                                               best_score) > 0);
+
+}//end score_roll
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solve_mask
+// Inputs
+//     mask
+//         The items used.
+//     context
+//         The values and counts being solved.
+//     scratch
+//         Room for SENS_COLUMNS values for every roll and keep.
+// Outputs
+//     none
+// Description
+//     This function solves every reachable scorecard with these items
+//     used, with YAHTZEE scored 50 or not, for solver_by_layer(): the
+//     same turn as solver_turn(), with the counts carried along.
+// ---------------------------------------------------------------------
+static void solve_mask(const unsigned int mask, void *context, void *scratch)
+{
+    struct sens_t *s = context;
+    float        (*rolls)[SENS_COLUMNS] = scratch;
+    float        (*keeps)[SENS_COLUMNS] = rolls + SOLVER_ROLLS;
+    unsigned int   card;
+    int            state;
+
+    for (int fifty = 0; fifty <= ((mask & SOLVER_YAHTZEE_BIT) != 0);
+         ++fifty) {
+        card = solver_card(mask, fifty);
+        for (int u = 0; u < SOLVER_UPPER; ++u) {
+            state = card * SOLVER_UPPER + u;
+            memset(s->at[state], 0, sizeof(s->at[state]));
+            if ((mask == FULL_MASK) || !solver_reachable(mask, u) ||
+                (solver_state(card, u) != state)) {
+                continue;
+            }
+
+            for (int r = 0; r < SOLVER_ROLLS; ++r) {
+                score_roll(s, state, r, rolls[r]);
+            }
+            for (int n = MAX_ROLLS - 1; n >= 0; --n) {
+                solver_expect(rolls[0], keeps[0], SENS_COLUMNS);
+                if (n > 0) {
+                    best_keeps(keeps, rolls);
+                }
+            }
+            memcpy(s->at[state], keeps[0], sizeof(s->at[state]));
+        }
+    }
+
+}//end solve_mask
+
+
+// **************************************************************************
+// *************************** EXTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     sens_solve
+// Inputs
+//     threads
+//         How many threads to use.
+// Outputs
+//     function result
+// Description
+//     This function solves the game for the most points, with the
+//     derivatives by each constant, and returns them to be freed by
+//     sens_free(), or NULL if there's no memory.
+// ---------------------------------------------------------------------
+struct sens_t *sens_solve(const int threads)
+{
+    struct sens_t *s = calloc(1, sizeof(*s));
+
+    if (s == NULL) {
+        return NULL;
+    }
+    s->at = solver_alloc(SOLVER_STATES * sizeof(*s->at));
+    if (s->at == NULL) {
+        free(s);
+        return NULL;
+    }
+    if (solver_by_layer(threads, solve_mask, s,
+                        (SOLVER_ROLLS + SOLVER_KEEPS) * sizeof(*s->at)) !=
+        SUCCESS) {
+        sens_free(s);
+        return NULL;
+    }
+
+    return s;
+
+}//end sens_solve
+
+
+// ---------------------------------------------------------------------
+// Function
+//     sens_free
+// Inputs
+//     s
+//         From sens_solve().
+// Outputs
+//     none
+// Description
+//     This function frees the values and derivatives.
+// ---------------------------------------------------------------------
+void sens_free(struct sens_t *s)
+{
+    solver_free(s->at);
+    free(s);
+}//end sens_free
+
+
+// ---------------------------------------------------------------------
+// Function
+//     sens_name
+// Inputs
+//     constant
+//         A SENS_ constant.
+// Outputs
+//     function result
+// Description
+//     Returns the constant's name in score.h, for reports.
+// ---------------------------------------------------------------------
+const char *sens_name(const int constant)
+{
+    static const char *names[SENS_CONSTANTS] = {
+        "SCORE_FULL_HOUSE", "SCORE_STRAIGHT_SM", "SCORE_STRAIGHT_LG",
+        "SCORE_YAHTZEE", "SCORE_YAHTZEE_BONUS", "SCORE_BONUS"
+    };
+
+    return names[constant];
+}//end sens_name
+
+
+// ---------------------------------------------------------------------
+// Function
+//     sens_constant
+// Inputs
+//     constant
+//         A SENS_ constant.
+// Outputs
+//     function result
+// Description
+//     Returns what the constant is in these rules.
+// ---------------------------------------------------------------------
+int sens_constant(const int constant)
+{
+    static const int values[SENS_CONSTANTS] = {
+        SCORE_FULL_HOUSE, SCORE_STRAIGHT_SM, SCORE_STRAIGHT_LG,
+        SCORE_YAHTZEE, SCORE_YAHTZEE_BONUS, SCORE_BONUS
+    };
+
+    return values[constant];
+}//end sens_constant
+
+// end sens.c
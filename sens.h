@@ -0,0 +1,40 @@
+// -------------------------------------------------------------------
+// File: sens.h
+//
+// Name: Marshall Liu
+//
+// Description: This is the header file for the SENS module, which
+//     works out how the best expected score would move with each of
+//     the scoring constants, in the same pass that solves for it.
+// -------------------------------------------------------------------
+
+#ifndef SENS_H
+#define SENS_H
+
+#include "solver.h"
+
+// The scoring constants, in the order their derivatives are stored
+#define SENS_FULL_HOUSE    0   // SCORE_FULL_HOUSE
+#define SENS_STRAIGHT_SM   1   // SCORE_STRAIGHT_SM
+#define SENS_STRAIGHT_LG   2   // SCORE_STRAIGHT_LG
+#define SENS_YAHTZEE       3   // SCORE_YAHTZEE
+#define SENS_YAHTZEE_BONUS 4   // SCORE_YAHTZEE_BONUS
+#define SENS_BONUS         5   // SCORE_BONUS, for the upper section
+#define SENS_CONSTANTS     6
+
+// For every scorecard, its value (as solver_solve() gives it) and then
+// the derivative of the value by each constant, which is how many
+// times the constant is expected to be scored from there on, playing
+// for the most points.
+#define SENS_COLUMNS       (1 + SENS_CONSTANTS)
+
+struct sens_t {
+    float (*at)[SENS_COLUMNS];    // SOLVER_STATES of them
+};
+
+extern struct sens_t *sens_solve(const int threads);
+extern void  sens_free(struct sens_t *s);
+extern const char *sens_name(const int constant);
+extern int   sens_constant(const int constant);
+
+#endif // SENS_H
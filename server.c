@@ -0,0 +1,631 @@
+// ----------------------------------------------------------------------
+// File: server.c
+//
+// Name: Al Shaffer & Marshall Liu
+//
+// Description: This is the main program for the YAHTZEE game server.
+//     It serves many games at once over a Unix-domain socket. Each
+//     connection is one game session, which only moves forward (via
+//     game_step()) when a complete request line arrives, so nothing
+//     ever blocks waiting on one player. Sessions and their packed
+//     games come from per-thread slab stores, so an idle session costs
+//     a few hundred bytes and no malloc of its own. A few threads each run
+//     their own epoll loop and share the listening socket.
+//
+//     The protocol is one line per request and one line per reply:
+//
+//         N <seed>    start a new game with the given seed
+//         K <die>     switch whether to keep or roll die 1 thru 5
+//         R           roll the dice that aren't kept
+//         S <item>    put the dice on line <item> of the scorecard
+//         Q           quit
+//
+//     Every reply is either "OK <turn> <roll> <dice> <keep> <total>",
+//     "END <total>" once the last turn is scored, "ERR <reason>", or
+//     "BYE" for a quit. <dice> is the five face values run together
+//     and <keep> is the keep mask in hex, where bit 0 is die 1.
+//
+// Syntax: ./yahtzee_server [-s socket_path] [-t threads]
+// ----------------------------------------------------------------------
+
+#define _GNU_SOURCE   // for accept4()
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include "score.h"
+#include "rules.h"
+#include "game.h"
+#include "store.h"
+
+#define DEFAULT_SOCKET  "/tmp/yahtzee.sock"
+#define DEFAULT_THREADS 2
+#define MAX_THREADS     64
+#define LISTEN_BACKLOG  4096
+#define MAX_EVENTS      256
+#define IN_SIZE         64
+#define OUT_SIZE        192
+#define MAX_REPLY       64
+#define BASE_10         10
+
+// Requests (the rest are the GAME_ actions)
+#define NEW   'N'
+
+
+// **************************************************************************
+// ****************************  DEFINED TYPES   ****************************
+// **************************************************************************
+
+// One connected player. Their game is kept packed in the worker's
+// game store, and only unpacked while a request is being handled.
+struct session_t {
+    int           fd;
+    uint32_t      self;        // This session's handle
+    uint32_t      game;        // The game's handle
+    bool          closing;     // Close once flushed
+    uint8_t       in_len;
+    uint8_t       out_len;
+    uint8_t       out_off;
+    char          in[IN_SIZE];
+    char          out[OUT_SIZE];
+};
+
+// One event loop thread
+struct worker_t {
+    pthread_t          thread;
+    int                epfd;
+    struct store_t     sessions;  // session_t records
+    struct store_t     games;     // game_packed_t records
+    unsigned long long accepted;  // Sessions accepted
+    unsigned long long played;    // Games played to the end
+    unsigned long long requests;  // Requests handled
+    uint32_t           peak;      // Most sessions open at once
+};
+
+
+// **************************************************************************
+// **************************** GLOBAL VARIABLES ****************************
+// **************************************************************************
+
+static int             Listen_fd = -1;
+static volatile sig_atomic_t Stopping = 0;
+static struct worker_t Workers[MAX_THREADS];
+static int             Num_workers = DEFAULT_THREADS;
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    Stopping = 1;
+}//end on_signal
+
+
+// ---------------------------------------------------------------------
+// Function
+//     session_reply
+// Inputs
+//     s
+//         The session to reply to.
+//     fmt
+//         A printf() format for the reply, without the trailing '\n'.
+// Outputs
+//     none
+// Description
+//     This function queues one reply line in the session's output
+//     buffer. Callers make sure there's at least MAX_REPLY bytes free.
+// ---------------------------------------------------------------------
+static void session_reply(struct session_t *s, const char *fmt, ...)
+    __attribute__((format(printf, 2, 3)));
+
+static void session_reply(struct session_t *s, const char *fmt, ...)
+{
+    va_list args;
+    int     room = OUT_SIZE - s->out_len - 1;
+    int     len;
+
+    va_start(args, fmt);
+    len = vsnprintf(s->out + s->out_len, room, fmt, args);
+    va_end(args);
+    if (len > 0) {
+        s->out_len += (len < room) ? len : room - 1;
+    }
+    s->out[s->out_len++] = '\n';
+
+}//end session_reply
+
+
+// ---------------------------------------------------------------------
+// Function
+//     session_reply_state
+// Inputs
+//     s
+//         The session to reply to.
+//     g
+//         The session's game.
+// Outputs
+//     none
+// Description
+//     This function queues the "OK" or "END" reply that describes where
+//     the game is now.
+// ---------------------------------------------------------------------
+static void session_reply_state(struct session_t *s, const struct game_t *g)
+{
+    if (game_over(g)) {
+        session_reply(s, "END %i", game_total(g));
+    } else {
+        session_reply(s, "OK %u %u %u%u%u%u%u %02x %i",
+                      g->turn, g->roll,
+                      g->dice[0], g->dice[1], g->dice[2], g->dice[3],
+                      g->dice[4], g->keep, game_total(g));
+    }
+
+}//end session_reply_state
+
+
+// ---------------------------------------------------------------------
+// Function
+//     session_request
+// Inputs
+//     w
+//         The worker that owns the session.
+//     s
+//         The session the request came in on.
+//     line
+//         The request, without the trailing '\n'.
+// Outputs
+//     none
+// Description
+//     This function applies one request to the session's game and
+//     queues the reply. The requests other than NEW are the actions
+//     game_step() takes, spelled the same way.
+// ---------------------------------------------------------------------
+static void session_request(struct worker_t *w, struct session_t *s,
+                            char *line)
+{
+    struct game_packed_t *packed = store_get(&w->games, s->game);
+    struct game_action_t  action;
+    struct game_t         game;
+    int                   result;
+
+    ++w->requests;
+    action.type = line[0];
+    action.arg  = (int)strtol(line + 1, NULL, BASE_10);
+
+    if (action.type == NEW) {
+        game_new(&game, strtoull(line + 1, NULL, BASE_10));
+        game_pack(&game, packed);
+        session_reply_state(s, &game);
+        return;
+    }
+
+    game_unpack(packed, &game);
+    result = game_step(&game, action, &game);
+    game_pack(&game, packed);
+    if (result < 0) {
+        session_reply(s, "ERR %s", game_error_text(result));
+    } else if (result & GAME_EVENT_QUIT) {
+        session_reply(s, "BYE");
+        s->closing = true;
+    } else {
+        if (result & GAME_EVENT_OVER) {
+            ++w->played;
+        }
+        session_reply_state(s, &game);
+    }
+
+}//end session_request
+
+
+// ---------------------------------------------------------------------
+// Function
+//     session_close
+// Inputs
+//     w
+//         The worker that owns the session.
+//     s
+//         The session to end.
+// Outputs
+//     none
+// Description
+//     Disconnects the player and frees the session and its game.
+// ---------------------------------------------------------------------
+static void session_close(struct worker_t *w, struct session_t *s)
+{
+    epoll_ctl(w->epfd, EPOLL_CTL_DEL, s->fd, NULL);
+    close(s->fd);
+    store_free(&w->games, s->game);
+    store_free(&w->sessions, s->self);
+
+}//end session_close
+
+
+// ---------------------------------------------------------------------
+// Function
+//     session_flush
+// Inputs
+//     w
+//         The worker that owns the session.
+//     s
+//         The session with replies to send.
+// Outputs
+//     function result
+// Description
+//     This function writes as much of the queued replies as the socket
+//     will take, and asks epoll to say when it can take the rest. The
+//     result is false if the session was closed.
+// ---------------------------------------------------------------------
+static bool session_flush(struct worker_t *w, struct session_t *s)
+{
+    struct epoll_event ev;
+    ssize_t            sent;
+
+    while (s->out_off < s->out_len) {
+        sent = send(s->fd, s->out + s->out_off, s->out_len - s->out_off,
+                    MSG_NOSIGNAL);
+        if (sent > 0) {
+            s->out_off += sent;
+        } else if ((sent < 0) && (errno == EINTR)) {
+            continue;
+        } else if ((sent < 0) && ((errno == EAGAIN) ||
+                                  (errno == EWOULDBLOCK))) {
+            break;
+        } else {
+            session_close(w, s);
+            return false;
+        }
+    }
+
+    if (s->out_off == s->out_len) {
+        s->out_off = 0;
+        s->out_len = 0;
+        if (s->closing) {
+            session_close(w, s);
+            return false;
+        }
+        ev.events = EPOLLIN | EPOLLRDHUP;
+    } else {
+        // Stop reading until the player catches up on replies
+        ev.events = EPOLLOUT;
+    }
+    ev.data.ptr = s;
+    epoll_ctl(w->epfd, EPOLL_CTL_MOD, s->fd, &ev);
+
+    return true;
+
+}//end session_flush
+
+
+// ---------------------------------------------------------------------
+// Function
+//     session_input
+// Inputs
+//     w
+//         The worker that owns the session.
+//     s
+//         The session that is readable.
+// Outputs
+//     none
+// Description
+//     This function handles every complete request line the player has
+//     sent, reading more until the socket is drained, and then sends
+//     the replies.
+// ---------------------------------------------------------------------
+static void session_input(struct worker_t *w, struct session_t *s)
+{
+    ssize_t got;
+    char   *line;
+    char   *newline;
+    size_t  used;
+
+    while (true) {
+        // Handle each complete line while there's room to reply
+        line = s->in;
+        while ((!s->closing) && (OUT_SIZE - s->out_len >= MAX_REPLY) &&
+               ((newline = memchr(line, '\n', s->in + s->in_len - line))
+                != NULL)) {
+            *newline = '\0';
+            if ((newline > line) && (newline[-1] == '\r')) {
+                newline[-1] = '\0';
+            }
+            session_request(w, s, line);
+            line = newline + 1;
+        }
+        used = line - s->in;
+        memmove(s->in, line, s->in_len - used);
+        s->in_len -= used;
+
+        if (s->closing) {
+            break;
+        } else if (OUT_SIZE - s->out_len < MAX_REPLY) {
+            // Send what's queued to make room for more replies. If the
+            // player isn't reading, wait for EPOLLOUT to come back here.
+            if (!session_flush(w, s)) {
+                return;
+            } else if (OUT_SIZE - s->out_len < MAX_REPLY) {
+                return;
+            }
+            continue;
+        } else if (s->in_len == IN_SIZE) {
+            // A request that doesn't fit the buffer isn't a request
+            session_close(w, s);
+            return;
+        }
+
+        got = recv(s->fd, s->in + s->in_len, IN_SIZE - s->in_len, 0);
+        if ((got < 0) && (errno == EINTR)) {
+            continue;
+        } else if ((got < 0) && ((errno == EAGAIN) ||
+                                 (errno == EWOULDBLOCK))) {
+            break;
+        } else if (got <= 0) {
+            session_close(w, s);
+            return;
+        }
+        s->in_len += got;
+    }
+
+    session_flush(w, s);
+
+}//end session_input
+
+
+// ---------------------------------------------------------------------
+// Function
+//     accept_sessions
+// Inputs
+//     w
+//         The worker that saw the listening socket become readable.
+// Outputs
+//     none
+// Description
+//     This function accepts every waiting connection, and starts each
+//     one in a new game with a seed of its own.
+// ---------------------------------------------------------------------
+static void accept_sessions(struct worker_t *w)
+{
+    struct epoll_event ev;
+    struct session_t  *s;
+    struct game_t      game;
+    struct timespec    now;
+    uint32_t           self;
+    uint32_t           handle;
+    int                fd;
+
+    while (true) {
+        fd = accept4(Listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK) &&
+                (errno != EINTR)) {
+                perror("accept");
+            }
+            break;
+        }
+
+        self   = store_alloc(&w->sessions);
+        handle = store_alloc(&w->games);
+        if ((self == STORE_NONE) || (handle == STORE_NONE)) {
+            if (self != STORE_NONE) {
+                store_free(&w->sessions, self);
+            }
+            if (handle != STORE_NONE) {
+                store_free(&w->games, handle);
+            }
+            close(fd);
+            continue;
+        }
+
+        s = store_get(&w->sessions, self);
+        memset(s, 0, sizeof(*s));
+        s->fd   = fd;
+        s->self = self;
+        s->game = handle;
+        clock_gettime(CLOCK_REALTIME, &now);
+        game_new(&game, ((uint64_t)now.tv_sec << 32) ^ now.tv_nsec ^
+                        ((uint64_t)fd << 48));
+        game_pack(&game, store_get(&w->games, handle));
+
+        ev.events   = EPOLLIN | EPOLLRDHUP;
+        ev.data.ptr = s;
+        if (epoll_ctl(w->epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            close(fd);
+            store_free(&w->games, handle);
+            store_free(&w->sessions, self);
+            continue;
+        }
+        ++w->accepted;
+        if (w->sessions.live > w->peak) {
+            w->peak = w->sessions.live;
+        }
+    }
+
+}//end accept_sessions
+
+
+// ---------------------------------------------------------------------
+// Function
+//     worker_loop
+// Inputs
+//     arg
+//         The worker_t this thread runs.
+// Outputs
+//     function result
+// Description
+//     This is the event loop for one thread. It runs until the server
+//     is told to stop.
+// ---------------------------------------------------------------------
+static void *worker_loop(void *arg)
+{
+    struct worker_t   *w = arg;
+    struct epoll_event events[MAX_EVENTS];
+    struct session_t  *s;
+    int                count;
+
+    while (!Stopping) {
+        count = epoll_wait(w->epfd, events, MAX_EVENTS, 500);
+        for (int i = 0; i < count; ++i) {
+            s = events[i].data.ptr;
+            if (s == NULL) {
+                accept_sessions(w);
+            } else if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                session_close(w, s);
+            } else if (events[i].events & EPOLLOUT) {
+                if (session_flush(w, s) && (s->in_len > 0)) {
+                    // Pick up requests that were waiting on room to reply
+                    session_input(w, s);
+                }
+            } else {
+                session_input(w, s);
+            }
+        }
+    }
+
+    return NULL;
+
+}//end worker_loop
+
+
+// ---------------------------------------------------------------------
+// Function
+//     open_listener
+// Inputs
+//     path
+//         Where to put the Unix-domain socket.
+// Outputs
+//     function result
+// Description
+//     This function creates the non-blocking listening socket,
+//     replacing any old socket file at the same path.
+// ---------------------------------------------------------------------
+static int open_listener(const char *path)
+{
+    struct sockaddr_un addr;
+    int                fd;
+
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Error: socket path is too long\n");
+        return -1;
+    }
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    unlink(path);
+
+    if ((bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) ||
+        (listen(fd, LISTEN_BACKLOG) < 0)) {
+        perror(path);
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+
+}//end open_listener
+
+
+// **************************************************************************
+// *********************************  MAIN **********************************
+// **************************************************************************
+int main(int argc, char *argv[])
+{
+    const char        *path = DEFAULT_SOCKET;
+    struct epoll_event ev;
+    struct sigaction   sa;
+    unsigned long long sessions = 0;
+    unsigned long long games = 0;
+    unsigned long long requests = 0;
+    unsigned long long peak = 0;
+    size_t             bytes = 0;
+    int                opt;
+
+    while ((opt = getopt(argc, argv, "s:t:")) != -1) {
+        if (opt == 's') {
+            path = optarg;
+        } else if (opt == 't') {
+            Num_workers = atoi(optarg);
+        } else {
+            fprintf(stderr, "Syntax: %s [-s socket_path] [-t threads]\n",
+                    argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if ((Num_workers < 1) || (Num_workers > MAX_THREADS)) {
+        fprintf(stderr, "Error: threads must be 1 thru %i\n", MAX_THREADS);
+        return EXIT_FAILURE;
+    }
+
+    Listen_fd = open_listener(path);
+    if (Listen_fd < 0) {
+        return EXIT_FAILURE;
+    }
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    // Every worker waits on the listening socket, but EPOLLEXCLUSIVE
+    // wakes only one of them for each new connection.
+    for (int i = 0; i < Num_workers; ++i) {
+        store_init(&Workers[i].sessions, sizeof(struct session_t));
+        store_init(&Workers[i].games, sizeof(struct game_packed_t));
+        Workers[i].epfd = epoll_create1(EPOLL_CLOEXEC);
+        ev.events   = EPOLLIN | EPOLLEXCLUSIVE;
+        ev.data.ptr = NULL;
+        if ((Workers[i].epfd < 0) ||
+            (epoll_ctl(Workers[i].epfd, EPOLL_CTL_ADD, Listen_fd, &ev) < 0)) {
+            perror("epoll");
+            return EXIT_FAILURE;
+        }
+        pthread_create(&Workers[i].thread, NULL, worker_loop, &Workers[i]);
+    }
+
+    printf("Serving YAHTZEE on %s with %i thread(s)\n", path, Num_workers);
+    fflush(stdout);
+
+    for (int i = 0; i < Num_workers; ++i) {
+        pthread_join(Workers[i].thread, NULL);
+        sessions += Workers[i].accepted;
+        games    += Workers[i].played;
+        requests += Workers[i].requests;
+        peak     += Workers[i].peak;
+        bytes    += store_bytes(&Workers[i].sessions) +
+                    store_bytes(&Workers[i].games);
+    }
+
+    close(Listen_fd);
+    unlink(path);
+    printf("%llu sessions, %llu games finished, %llu requests\n",
+           sessions, games, requests);
+    printf("%llu sessions at peak, %zu bytes of session and game slabs "
+           "(%zu + %zu per session)\n", peak, bytes,
+           sizeof(struct session_t), sizeof(struct game_packed_t));
+
+    return EXIT_SUCCESS;
+
+} // end main
+
+// end server.c
@@ -0,0 +1,661 @@
+// ----------------------------------------------------------------------
+// File: sim.c
+//
+// Name: Al Shaffer & Marshall Liu
+//
+// Description: This is a driver for long simulation runs. It plays
+//     games headless (the BOT module playing through game_step()) in
+//     several worker processes, so a crash only loses the work that
+//     was in progress, and a run can use every core it's allowed.
+//
+//     The games are split into shards, each a fixed range of seeds, so
+//     a shard always adds up to the same thing no matter which worker
+//     plays it or how many times. The shards and what they added up to
+//     live in a POSIX shared memory region. Workers claim shards from
+//     it one at a time and write each shard's results back when it's
+//     done; the parent merges them at the end.
+//
+//     If a worker dies, the shard it was playing is put back and a new
+//     worker is started to play it again (up to MAX_ATTEMPTS times). If
+//     the whole run dies, the region is left behind, and running the
+//     same command again picks up where it left off: only the shards
+//     that weren't done are played. The region is removed once a run
+//     is complete, unless -k is given.
+//
+//     -w defaults to the number of CPUs this process may use, taking
+//     both its CPU affinity and any cgroup CPU quota into account. -K
+//     kills the worker playing the given shard, the first time, to try
+//     out recovery. -d makes the bot search for its keeps, taking at
+//     most the given microseconds per decision (0 for no limit).
+//
+// Syntax: ./yahtzee_sim [-n games] [-s first_seed] [-w workers]
+//                       [-b games_per_shard] [-m shm_name] [-k]
+//                       [-K shard] [-d deadline_us]
+// ----------------------------------------------------------------------
+
+#define _GNU_SOURCE   // for sched_getaffinity()
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "score.h"
+#include "rules.h"
+#include "game.h"
+#include "bot.h"
+
+#define DEFAULT_GAMES       1000000
+#define DEFAULT_SEED        1
+#define DEFAULT_SHARD_GAMES 50000
+#define DEFAULT_SHM         "/yahtzee_sim"
+#define REGION_MAGIC        0x324D49535A59ULL  // "YZSIM2"
+#define MAX_WORKERS         1024
+#define MAX_ATTEMPTS        3
+#define MAX_TOTAL           1575  // The best possible scorecard
+#define NO_SHARD            UINT32_MAX
+#define CGROUP_CPU_MAX      "/sys/fs/cgroup/cpu.max"
+#define BASE_10             10
+
+// Shard states
+#define SHARD_PENDING 0
+#define SHARD_RUNNING 1
+#define SHARD_DONE    2
+#define SHARD_FAILED  3
+
+// A shard's claim word: its state in the low 32 bits and the worker
+// playing it in the high 32 bits
+#define CLAIM(state, pid)   (((uint64_t)(uint32_t)(pid) << 32) | (state))
+#define CLAIM_STATE(claim)  ((uint32_t)(claim))
+
+
+// **************************************************************************
+// ****************************  DEFINED TYPES   ****************************
+// **************************************************************************
+
+// What a batch of games added up to
+struct tally_t {
+    uint64_t games;
+    uint64_t total_sum;
+    uint64_t total_squares;
+    uint64_t bonuses;                          // Games with the bonus
+    uint64_t item_sum[NUMBER_OF_CATEGORIES + 1];
+    uint64_t item_zero[NUMBER_OF_CATEGORIES + 1];
+    uint64_t histogram[MAX_TOTAL + 1];         // Games per grand total
+};
+
+// One range of seeds. The state and the worker playing it share one
+// word, only changed atomically since every worker looks at it, so a
+// shard is never RUNNING without its owner.
+struct shard_t {
+    uint64_t       claim;      // See CLAIM()
+    uint32_t       attempts;
+    uint32_t       unused;
+    uint64_t       first_seed;
+    uint64_t       games;
+    struct tally_t tally;      // Valid once the state is SHARD_DONE
+};
+
+// The shared memory region. The run's parameters are kept so that a
+// resumed run can check it's the same run.
+struct region_t {
+    uint64_t       magic;
+    uint64_t       first_seed;
+    uint64_t       games;
+    uint64_t       shard_games;
+    uint32_t       num_shards;
+    int32_t        deadline_us;   // For the bot's search; -1 if not
+    struct shard_t shards[];
+};
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     default_workers
+// Inputs
+//     none
+// Outputs
+//     function result
+// Description
+//     Returns how many CPUs this process can really use: the CPUs in
+//     its affinity mask, or fewer if its cgroup has a CPU quota.
+// ---------------------------------------------------------------------
+static int default_workers(void)
+{
+    cpu_set_t set;
+    FILE     *file;
+    long      quota;
+    long      period;
+    int       cpus = 1;
+
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        cpus = CPU_COUNT(&set);
+    }
+
+    // cpu.max is "max <period>" or "<quota> <period>"
+    file = fopen(CGROUP_CPU_MAX, "r");
+    if (file != NULL) {
+        if ((fscanf(file, "%ld %ld", &quota, &period) == 2) &&
+            (quota > 0) && (period > 0) &&
+            ((quota + period - 1) / period < cpus)) {
+            cpus = (quota + period - 1) / period;
+        }
+        fclose(file);
+    }
+
+    return (cpus < 1) ? 1 : cpus;
+
+}//end default_workers
+
+
+// ---------------------------------------------------------------------
+// Function
+//     region_open
+// Inputs
+//     name
+//         The shared memory name.
+//     first_seed, games, shard_games, deadline_us
+//         What the run is.
+//     resumed
+//         Set to whether an unfinished run was found.
+// Outputs
+//     function result
+// Description
+//     This function creates the region for a run, or maps the one a
+//     run with the same parameters left behind. It returns NULL if it
+//     can't, or if the region left behind is for a different run.
+// ---------------------------------------------------------------------
+static struct region_t *region_open(const char *name,
+                                    const uint64_t first_seed,
+                                    const uint64_t games,
+                                    const uint64_t shard_games,
+                                    const int32_t deadline_us,
+                                    bool *resumed)
+{
+    struct region_t *r;
+    struct stat      info;
+    uint32_t         shards = (games + shard_games - 1) / shard_games;
+    size_t           bytes = sizeof(*r) + shards * sizeof(r->shards[0]);
+    int              fd;
+
+    *resumed = false;
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if ((fd < 0) && (errno == EEXIST)) {
+        *resumed = true;
+        fd = shm_open(name, O_RDWR, 0600);
+    }
+    if ((fd < 0) || (!*resumed && (ftruncate(fd, bytes) != 0)) ||
+        (fstat(fd, &info) != 0)) {
+        perror(name);
+        return NULL;
+    }
+    if ((size_t)info.st_size != bytes) {
+        fprintf(stderr, "Error: %s holds a different run; remove it "
+                "from /dev/shm or use -m\n", name);
+        close(fd);
+        return NULL;
+    }
+    r = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (r == MAP_FAILED) {
+        perror(name);
+        return NULL;
+    }
+
+    if (*resumed) {
+        if ((r->magic != REGION_MAGIC) || (r->first_seed != first_seed) ||
+            (r->games != games) || (r->shard_games != shard_games) ||
+            (r->deadline_us != deadline_us)) {
+            fprintf(stderr, "Error: %s holds a different run; remove it "
+                    "from /dev/shm or use -m\n", name);
+            munmap(r, bytes);
+            return NULL;
+        }
+
+        // Whatever was being played when the last run died is redone
+        for (uint32_t i = 0; i < shards; ++i) {
+            if (CLAIM_STATE(r->shards[i].claim) != SHARD_DONE) {
+                r->shards[i].claim    = CLAIM(SHARD_PENDING, 0);
+                r->shards[i].attempts = 0;
+            }
+        }
+        return r;
+    }
+
+    // ftruncate() already zeroed it
+    r->first_seed  = first_seed;
+    r->games       = games;
+    r->shard_games = shard_games;
+    r->deadline_us = deadline_us;
+    r->num_shards  = shards;
+    for (uint32_t i = 0; i < shards; ++i) {
+        r->shards[i].first_seed = first_seed + i * shard_games;
+        r->shards[i].games      = (i + 1 < shards) ? shard_games :
+                                  games - i * shard_games;
+    }
+    r->magic = REGION_MAGIC;
+
+    return r;
+
+}//end region_open
+
+
+// ---------------------------------------------------------------------
+// Function
+//     claim_shard
+// Inputs
+//     r
+//         The region.
+// Outputs
+//     function result
+// Description
+//     This function takes the first pending shard for this process,
+//     and returns its index, or NO_SHARD if there are none left. The
+//     shard becomes RUNNING with this process as its owner in the one
+//     compare-and-swap, so recover() can't miss it if we die here.
+// ---------------------------------------------------------------------
+static uint32_t claim_shard(struct region_t *r)
+{
+    uint64_t running = CLAIM(SHARD_RUNNING, getpid());
+    uint64_t pending;
+
+    for (uint32_t i = 0; i < r->num_shards; ++i) {
+        pending = CLAIM(SHARD_PENDING, 0);
+        if (__atomic_compare_exchange_n(&r->shards[i].claim, &pending,
+                                        running, false,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            ++r->shards[i].attempts;
+            return i;
+        }
+    }
+
+    return NO_SHARD;
+
+}//end claim_shard
+
+
+// ---------------------------------------------------------------------
+// Function
+//     play_shard
+// Inputs
+//     shard
+//         The shard to play.
+//     tally
+//         Where to add up its games.
+// Outputs
+//     none
+// Description
+//     This function plays every game in the shard's seed range.
+// ---------------------------------------------------------------------
+static void play_shard(const struct shard_t *shard, struct tally_t *tally)
+{
+    struct game_t game;
+    int           total;
+
+    memset(tally, 0, sizeof(*tally));
+    for (uint64_t i = 0; i < shard->games; ++i) {
+        total = bot_play(&game, shard->first_seed + i);
+        ++tally->games;
+        tally->total_sum     += total;
+        tally->total_squares += (uint64_t)total * total;
+        ++tally->histogram[(total > MAX_TOTAL) ? MAX_TOTAL : total];
+        if (game_upper(&game) >= BONUS_THRESHOLD) {
+            ++tally->bonuses;
+        }
+        for (int item = ACES; item <= CHANCE; ++item) {
+            tally->item_sum[item] += game.score[item];
+            tally->item_zero[item] += (game.score[item] == 0);
+        }
+    }
+
+}//end play_shard
+
+
+// ---------------------------------------------------------------------
+// Function
+//     run_worker
+// Inputs
+//     r
+//         The region.
+//     kill_shard
+//         A shard to die on the first time it's played, or NO_SHARD.
+// Outputs
+//     none
+// Description
+//     This is a worker process. It plays shards until there are none
+//     left, then exits.
+// ---------------------------------------------------------------------
+static void run_worker(struct region_t *r, const uint32_t kill_shard)
+{
+    struct tally_t tally;
+    uint32_t       i;
+
+    while ((i = claim_shard(r)) != NO_SHARD) {
+        if ((i == kill_shard) && (r->shards[i].attempts == 1)) {
+            kill(getpid(), SIGKILL);
+        }
+        play_shard(&r->shards[i], &tally);
+
+        // The tally has to be in place before anyone can see DONE
+        r->shards[i].tally = tally;
+        __atomic_store_n(&r->shards[i].claim, CLAIM(SHARD_DONE, getpid()),
+                         __ATOMIC_RELEASE);
+    }
+
+    _exit(EXIT_SUCCESS);
+
+}//end run_worker
+
+
+// ---------------------------------------------------------------------
+// Function
+//     recover
+// Inputs
+//     r
+//         The region.
+//     pid
+//         A worker that died.
+// Outputs
+//     function result
+// Description
+//     This function puts back the shard the worker was playing, or
+//     gives up on it after MAX_ATTEMPTS. It returns how many shards
+//     were put back.
+// ---------------------------------------------------------------------
+static int recover(struct region_t *r, const pid_t pid)
+{
+    struct shard_t *shard;
+    int             count = 0;
+
+    for (uint32_t i = 0; i < r->num_shards; ++i) {
+        shard = &r->shards[i];
+        if (__atomic_load_n(&shard->claim, __ATOMIC_ACQUIRE) !=
+            CLAIM(SHARD_RUNNING, pid)) {
+            continue;
+        }
+        if (shard->attempts >= MAX_ATTEMPTS) {
+            fprintf(stderr, "shard %u (seeds %llu+%llu) failed %u times; "
+                    "giving up\n", i, (unsigned long long)shard->first_seed,
+                    (unsigned long long)shard->games, shard->attempts);
+            __atomic_store_n(&shard->claim, CLAIM(SHARD_FAILED, pid),
+                             __ATOMIC_RELEASE);
+        } else {
+            fprintf(stderr, "shard %u (seeds %llu+%llu) lost; playing it "
+                    "again\n", i, (unsigned long long)shard->first_seed,
+                    (unsigned long long)shard->games);
+            __atomic_store_n(&shard->claim, CLAIM(SHARD_PENDING, 0),
+                             __ATOMIC_RELEASE);
+            ++count;
+        }
+    }
+
+    return count;
+
+}//end recover
+
+
+// ---------------------------------------------------------------------
+// Function
+//     merge
+// Inputs
+//     r
+//         The region, once every worker is done.
+//     all
+//         Where to add up every shard.
+// Outputs
+//     function result
+// Description
+//     This function adds the finished shards together, and returns
+//     how many shards aren't finished.
+// ---------------------------------------------------------------------
+static uint32_t merge(const struct region_t *r, struct tally_t *all)
+{
+    const struct tally_t *t;
+    uint32_t              missing = 0;
+
+    memset(all, 0, sizeof(*all));
+    for (uint32_t i = 0; i < r->num_shards; ++i) {
+        if (CLAIM_STATE(r->shards[i].claim) != SHARD_DONE) {
+            ++missing;
+            continue;
+        }
+        t = &r->shards[i].tally;
+        all->games         += t->games;
+        all->total_sum     += t->total_sum;
+        all->total_squares += t->total_squares;
+        all->bonuses       += t->bonuses;
+        for (int item = ACES; item <= CHANCE; ++item) {
+            all->item_sum[item]  += t->item_sum[item];
+            all->item_zero[item] += t->item_zero[item];
+        }
+        for (int total = 0; total <= MAX_TOTAL; ++total) {
+            all->histogram[total] += t->histogram[total];
+        }
+    }
+
+    return missing;
+
+}//end merge
+
+
+// ---------------------------------------------------------------------
+// Function
+//     percentile
+// Inputs
+//     all
+//         The merged tally.
+//     fraction
+//         Which percentile, as a fraction.
+// Outputs
+//     function result
+// Description
+//     Returns the grand total that fraction of the games were at or
+//     below.
+// ---------------------------------------------------------------------
+static int percentile(const struct tally_t *all, const double fraction)
+{
+    uint64_t target = (uint64_t)ceil(fraction * all->games);
+    uint64_t seen = 0;
+
+    for (int total = 0; total <= MAX_TOTAL; ++total) {
+        seen += all->histogram[total];
+        if ((seen >= target) && (seen > 0)) {
+            return total;
+        }
+    }
+
+    return MAX_TOTAL;
+
+}//end percentile
+
+
+// ---------------------------------------------------------------------
+// Function
+//     report
+// Inputs
+//     all
+//         The merged tally.
+// Outputs
+//     none
+// Description
+//     This function prints what all the games added up to.
+// ---------------------------------------------------------------------
+static void report(const struct tally_t *all)
+{
+    static const char *names[NUMBER_OF_CATEGORIES + 1] = {
+        "", "Aces", "Twos", "Threes", "Fours", "Fives", "Sixes",
+        "3 of a kind", "4 of a kind", "Full house", "Small straight",
+        "Large straight", "Yahtzee", "Chance"
+    };
+    double games = (all->games > 0) ? all->games : 1;
+    double mean = all->total_sum / games;
+
+    printf("%-16s %10s %10s\n", "Item", "Mean", "Zeroed");
+    for (int item = ACES; item <= CHANCE; ++item) {
+        printf("%-16s %10.3f %9.2f%%\n", names[item],
+               all->item_sum[item] / games,
+               100.0 * all->item_zero[item] / games);
+    }
+    printf("Upper bonus in %.2f%% of games\n", 100.0 * all->bonuses / games);
+    printf("Grand total: mean %.3f, std dev %.3f, p1 %i, p50 %i, p99 %i\n",
+           mean, sqrt(all->total_squares / games - mean * mean),
+           percentile(all, 0.01), percentile(all, 0.50),
+           percentile(all, 0.99));
+
+}//end report
+
+
+// **************************************************************************
+// *********************************  MAIN **********************************
+// **************************************************************************
+int main(int argc, char *argv[])
+{
+    const char      *name = DEFAULT_SHM;
+    uint64_t         games = DEFAULT_GAMES;
+    uint64_t         first_seed = DEFAULT_SEED;
+    uint64_t         shard_games = DEFAULT_SHARD_GAMES;
+    uint32_t         kill_shard = NO_SHARD;
+    int32_t          deadline_us = -1;
+    bool             keep = false;
+    bool             resumed;
+    int              workers = default_workers();
+    int              running = 0;
+    int              redone = 0;
+    int              status;
+    int              opt;
+    uint32_t         done = 0;
+    uint64_t         already = 0;
+    uint32_t         missing;
+    pid_t            pid;
+    struct region_t *r;
+    struct tally_t   all;
+    struct timespec  start;
+    struct timespec  end;
+    double           seconds;
+
+    while ((opt = getopt(argc, argv, "n:s:w:b:m:kK:d:")) != -1) {
+        if (opt == 'n') {
+            games = strtoull(optarg, NULL, BASE_10);
+        } else if (opt == 's') {
+            first_seed = strtoull(optarg, NULL, BASE_10);
+        } else if (opt == 'w') {
+            workers = atoi(optarg);
+        } else if (opt == 'b') {
+            shard_games = strtoull(optarg, NULL, BASE_10);
+        } else if (opt == 'm') {
+            name = optarg;
+        } else if (opt == 'k') {
+            keep = true;
+        } else if (opt == 'K') {
+            kill_shard = strtoul(optarg, NULL, BASE_10);
+        } else if (opt == 'd') {
+            deadline_us = atoi(optarg);
+        } else {
+            fprintf(stderr, "Syntax: %s [-n games] [-s first_seed] "
+                    "[-w workers] [-b games_per_shard] [-m shm_name] [-k] "
+                    "[-K shard] [-d deadline_us]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if ((workers < 1) || (workers > MAX_WORKERS) || (games == 0) ||
+        (shard_games == 0)) {
+        fprintf(stderr, "Error: need 1 thru %i workers and at least one "
+                "game per shard\n", MAX_WORKERS);
+        return EXIT_FAILURE;
+    }
+
+    r = region_open(name, first_seed, games, shard_games,
+                    (deadline_us < 0) ? -1 : deadline_us, &resumed);
+    if (r == NULL) {
+        return EXIT_FAILURE;
+    }
+    if (resumed) {
+        for (uint32_t i = 0; i < r->num_shards; ++i) {
+            if (CLAIM_STATE(r->shards[i].claim) == SHARD_DONE) {
+                ++done;
+                already += r->shards[i].games;
+            }
+        }
+        printf("Resuming %s: %u of %u shards already done\n", name, done,
+               r->num_shards);
+    }
+    if (workers > (int)(r->num_shards - done)) {
+        workers = r->num_shards - done;
+    }
+    printf("Playing %llu games from seed %llu in %u shards with %i "
+           "worker(s)\n", (unsigned long long)games,
+           (unsigned long long)first_seed, r->num_shards, workers);
+    if (r->deadline_us >= 0) {
+        printf("The bot searches, up to %i us per decision\n",
+               r->deadline_us);
+        bot_search(r->deadline_us);
+    }
+    fflush(stdout);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (running = 0; running < workers; ++running) {
+        if (fork() == 0) {
+            run_worker(r, kill_shard);
+        }
+    }
+
+    // Replace any worker that dies while there's still work to do
+    while (running > 0) {
+        pid = wait(&status);
+        if (pid < 0) {
+            break;
+        }
+        --running;
+        if (WIFEXITED(status) && (WEXITSTATUS(status) == EXIT_SUCCESS)) {
+            continue;
+        }
+        fprintf(stderr, "worker %i died (%s %i)\n", (int)pid,
+                WIFSIGNALED(status) ? "signal" : "status",
+                WIFSIGNALED(status) ? WTERMSIG(status) :
+                WEXITSTATUS(status));
+        if (recover(r, pid) > 0) {
+            ++redone;
+            if (fork() == 0) {
+                run_worker(r, kill_shard);
+            }
+            ++running;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    missing = merge(r, &all);
+    report(&all);
+    printf("%llu games played in %.3f s: %.0f games/sec, %i shard(s) "
+           "redone\n", (unsigned long long)(all.games - already), seconds,
+           (all.games - already) / seconds, redone);
+
+    if (missing > 0) {
+        fprintf(stderr, "%u shard(s) not finished; run the same command "
+                "again to finish them\n", missing);
+        return EXIT_FAILURE;
+    }
+    if (!keep) {
+        shm_unlink(name);
+    }
+
+    return EXIT_SUCCESS;
+
+} // end main
+
+// end sim.c
@@ -0,0 +1,250 @@
+// ----------------------------------------------------------------------
+// File: solvebench.c
+//
+// Name: Al Shaffer & Marshall Liu
+//
+// Description: This is a benchmark for where the solvers' big arrays
+//     live in memory (see solver_memory()). It solves the game for
+//     points with every kind of page, first with each thread owning
+//     the same masks in every layer and touching their pages of the
+//     table, and then with it all touched up front by the thread that
+//     allocated it and the masks claimed as they go. It reports how
+//     long each solve took, how many page faults it took, and whether
+//     it got the same answer.
+//
+//     With -w, each configuration also solves for the chance of
+//     winning from the given scorecard mask (in hex, bit 0 is ACES)
+//     against an opponent whose totals are spread around 250, which
+//     needs much bigger arrays: the stored chances, and several MB of
+//     scratch memory per thread. Solving that from a fresh game (-w 0)
+//     takes a while.
+//
+//     Kinds of pages the kernel doesn't have are reported and skipped;
+//     explicit huge pages have to be reserved first (vm.nr_hugepages).
+//
+// Syntax: ./yahtzee_solvebench [-t threads] [-n repeats] [-w mask]
+// ----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include "score.h"
+#include "rules.h"
+#include "game.h"
+#include "solver.h"
+#include "winprob.h"
+#include "timing.h"
+
+#define DEFAULT_REPEATS  3
+#define OPPONENT_MEAN    250.0
+#define OPPONENT_SPREAD  60.0
+#define BASE_10          10
+#define BASE_16          16
+#define NS_PER_SEC       1e9
+
+
+// **************************************************************************
+// ****************************  DEFINED TYPES   ****************************
+// **************************************************************************
+
+// What one solve took
+struct timing_t {
+    double seconds;
+    long   faults;     // Minor page faults, all threads
+    double answer;     // To check every configuration agrees
+};
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     faults_now
+// Inputs
+//     none
+// Outputs
+//     function result
+// Description
+//     Returns how many minor page faults the process has taken.
+// ---------------------------------------------------------------------
+static long faults_now(void)
+{
+    struct rusage usage;
+
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_minflt;
+}//end faults_now
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solve_points
+// Inputs
+//     threads
+//         How many threads to solve with.
+//     timing
+//         Where to put what the solve took.
+// Outputs
+//     function result
+// Description
+//     This function solves the game for points, returning SUCCESS, or
+//     !SUCCESS if there's no memory for it.
+// ---------------------------------------------------------------------
+static int solve_points(const int threads, struct timing_t *timing)
+{
+    struct timespec start;
+    long            faults = faults_now();
+    float          *ev;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    ev = solver_solve(threads);
+    if (ev == NULL) {
+        return !SUCCESS;
+    }
+    timing->seconds = timing_since(&start);
+    timing->faults  = faults_now() - faults;
+    timing->answer  = ev[0];
+    solver_free(ev);
+
+    return SUCCESS;
+
+}//end solve_points
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solve_win
+// Inputs
+//     opponent
+//         The chance of each of the opponent's final totals.
+//     mask
+//         The scorecard to solve from.
+//     threads
+//         How many threads to solve with.
+//     timing
+//         Where to put what the solve took.
+// Outputs
+//     function result
+// Description
+//     This function solves for the chance of winning, returning
+//     SUCCESS, or !SUCCESS if there's no memory for it.
+// ---------------------------------------------------------------------
+static int solve_win(const double opponent[], const unsigned int mask,
+                     const int threads, struct timing_t *timing)
+{
+    struct timespec   start;
+    long              faults = faults_now();
+    struct winprob_t *w;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    w = winprob_solve(opponent, mask, threads);
+    if (w == NULL) {
+        return !SUCCESS;
+    }
+    timing->seconds = timing_since(&start);
+    timing->faults  = faults_now() - faults;
+    timing->answer  = winprob_value(w, solver_state(mask, 0), 0);
+    winprob_free(w);
+
+    return SUCCESS;
+
+}//end solve_win
+
+
+// **************************************************************************
+// *********************************  MAIN **********************************
+// **************************************************************************
+int main(int argc, char *argv[])
+{
+    static double   opponent[WINPROB_TOTALS];
+    struct timing_t timing;
+    struct timing_t best[2];
+    long            threads = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned long   repeats = DEFAULT_REPEATS;
+    unsigned int    mask = 0;
+    bool            win = false;
+    double          z;
+    int             opt;
+
+    while ((opt = getopt(argc, argv, "t:n:w:")) != -1) {
+        if (opt == 't') {
+            threads = atoi(optarg);
+        } else if (opt == 'n') {
+            repeats = strtoul(optarg, NULL, BASE_10);
+        } else if (opt == 'w') {
+            mask = strtoul(optarg, NULL, BASE_16);
+            win  = true;
+        } else {
+            threads = 0;
+            break;
+        }
+    }
+    if ((threads < 1) || (repeats == 0) || (mask >= SOLVER_MASKS - 1)) {
+        fprintf(stderr, "Syntax: %s [-t threads] [-n repeats] [-w mask]\n",
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+    for (int t = 0; t < WINPROB_TOTALS; ++t) {
+        z = (t - OPPONENT_MEAN) / OPPONENT_SPREAD;
+        opponent[t] = exp(-z * z / 2);
+    }
+    solver_dice();
+
+    printf("Best of %lu solve(s) with %li thread(s)\n", repeats, threads);
+    printf("%-8s %-6s %10s %10s %12s", "pages", "touch", "points s",
+           "faults", "expected");
+    if (win) {
+        printf(" %10s %10s %12s", "win s", "faults", "chance");
+    }
+    printf("\n");
+
+    for (int pages = 0; pages < SOLVER_PAGES; ++pages) {
+        for (int touch = 0; touch < 2; ++touch) {
+            if (solver_memory(pages, touch == 0) != SUCCESS) {
+                printf("%-8s (not available here)\n",
+                       solver_pages_name(pages));
+                break;
+            }
+
+            memset(best, 0, sizeof(best));
+            for (unsigned long i = 0; i < repeats; ++i) {
+                for (int kind = 0; kind <= win; ++kind) {
+                    if (((kind == 0) ? solve_points(threads, &timing)
+                                     : solve_win(opponent, mask, threads,
+                                                 &timing)) != SUCCESS) {
+                        perror("solver");
+                        return EXIT_FAILURE;
+                    }
+                    if ((i == 0) || (timing.seconds < best[kind].seconds)) {
+                        best[kind] = timing;
+                    }
+                }
+            }
+
+            printf("%-8s %-6s %10.3f %10li %12.6f", solver_pages_name(pages),
+                   (touch == 0) ? "first" : "front", best[0].seconds,
+                   best[0].faults, best[0].answer);
+            if (win) {
+                printf(" %10.3f %10li %12.6f", best[1].seconds,
+                       best[1].faults, best[1].answer);
+            }
+            printf("\n");
+        }
+    }
+    printf("(first: each thread touches the pages of the masks it owns; "
+           "front: the allocating thread touches it all)\n");
+
+    return EXIT_SUCCESS;
+
+} // end main
+
+// end solvebench.c
@@ -0,0 +1,1520 @@
+// ----------------------------------------------------------------------
+// File: solver.c
+//
+// Name: Al Shaffer & Marshall Liu
+//
+// Description: This SOLVER module works out how to play YAHTZEE for
+//     the most points on average. The only things about a scorecard
+//     that matter for the rest of a game are which items are used, how
+//     far the upper section is toward its bonus, and whether YAHTZEE
+//     was scored 50 (so that another earns a YAHTZEE bonus), so there
+//     are just 12288 x 64 scorecards to solve (see solver_card()).
+//     Each one's value, the points still to come with the best play
+//     from the start of a turn, comes from the values of the
+//     scorecards one item fuller. Solving them from the full scorecard
+//     back to the empty one solves the whole game.
+//
+//     Within a turn the dice only matter as a roll (the dice in any
+//     order), of which there are 252, and what's kept, of which there
+//     are 462 sets of 0 thru 5 dice. Keeping some dice and rolling the
+//     rest is worth the same as rolling the missing dice one at a time,
+//     so a keep is worth the average of the six keeps one die bigger,
+//     which makes a whole turn a few thousand operations.
+//
+//     The tables of rolls and keeps, and the pieces of a turn, are
+//     exported for other solvers that value a scorecard some other way.
+// ----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "score.h"
+#include "rules.h"
+#include "game.h"
+#include "solver.h"
+
+#define KEY_SIZE    46656   // NUMBER_OF_SIDES ^ NUMBER_OF_SIDES
+#define NO_KEEP     -1
+#define MAX_THREADS 64
+#define HUGE_PAGE   (2u << 20)   // x86-64 and arm64, with 4 KB pages
+#define ALLOC_HEADER 64          // Before what solver_alloc() returns, so
+                                 // it stays on a cache line
+#define PAGE_CARDS_SHIFT 4       // A 4 KB page holds 16 cards' rows
+#define OWNER_GROUPS (1u << (YAHTZEE - ACES - PAGE_CARDS_SHIFT))
+                                 // Masks by their bits between those
+                                 // and YAHTZEE's, which pick the page
+
+_Static_assert((SOLVER_UPPER * sizeof(float)) << PAGE_CARDS_SHIFT == 4096,
+               "a 4 KB page must hold 1 << PAGE_CARDS_SHIFT cards");
+
+
+// **************************************************************************
+// ****************************  DEFINED TYPES   ****************************
+// **************************************************************************
+
+// What the threads of solver_by_layer() share
+struct layer_job_t {
+    solver_mask_fn_t fn;
+    void            *context;
+    size_t           scratch_bytes;
+    int              threads;     // Set before any thread starts a layer
+    unsigned int     next[NUMBER_OF_CATEGORIES + 1];  // By layer, the next
+                                                      // mask to be claimed
+    int              failed;      // A thread had no scratch memory
+    pthread_mutex_t  lock;        // For waiting between layers
+    pthread_cond_t   passed;
+    int              waiting;
+    unsigned int     round;
+};
+
+// One of the threads of solver_by_layer()
+struct layer_thread_t {
+    struct layer_job_t *job;
+    int                 index;
+    pthread_t           thread;
+};
+
+
+// **************************************************************************
+// **************************** GLOBAL VARIABLES ****************************
+// **************************************************************************
+
+static struct solver_dice_t Dice;
+static short          Key_keep[KEY_SIZE];      // Counts key -> keep
+static unsigned short Masks[SOLVER_MASKS];     // By number of items used
+static unsigned short Layer_start[NUMBER_OF_CATEGORIES + 2];
+static unsigned char  Group_rank[OWNER_GROUPS];  // For owner_of()
+static bool           Reachable[SOLVER_UPPER_BITS + 1][SOLVER_UPPER];
+static pthread_once_t Once = PTHREAD_ONCE_INIT;
+
+static int            Pages = SOLVER_PAGES_SMALL;  // For solver_alloc()
+static bool           First_touch = true;          // Or touched up front
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     key_of
+// Inputs
+//     counts
+//         How many dice show each face, counts[1] thru counts[6].
+// Outputs
+//     function result
+// Description
+//     Returns a number unique to the counts, for looking up the keep.
+// ---------------------------------------------------------------------
+static int key_of(const int counts[])
+{
+    int key = 0;
+
+    for (int f = NUMBER_OF_SIDES; f >= 1; --f) {
+        key = key * NUMBER_OF_SIDES + counts[f];
+    }
+
+    return key;
+
+}//end key_of
+
+
+// ---------------------------------------------------------------------
+// Function
+//     build_keeps
+// Inputs
+//     none
+// Outputs
+//     none
+// Description
+//     This function lists every keep, smallest first, with the keep
+//     each added die makes, and every roll with its chance and scores.
+// ---------------------------------------------------------------------
+static void build_keeps(void)
+{
+    static const int factorial[NUMBER_OF_DICE + 1] = { 1, 1, 2, 6, 24, 120 };
+    int counts[NUMBER_OF_SIDES + 1];
+    int keeps = 0;
+    int ways;
+    int n;
+    int r;
+
+    for (int i = 0; i < KEY_SIZE; ++i) {
+        Key_keep[i] = NO_KEEP;
+    }
+
+    // Every set of counts that adds up to size, for each size
+    for (int size = 0; size <= NUMBER_OF_DICE; ++size) {
+        for (int key = 0; key < KEY_SIZE; ++key) {
+            n = 0;
+            for (int f = 1, k = key; f <= NUMBER_OF_SIDES; ++f) {
+                counts[f] = k % NUMBER_OF_SIDES;
+                k /= NUMBER_OF_SIDES;
+                n += counts[f];
+            }
+            if (n != size) {
+                continue;
+            }
+            Key_keep[key] = keeps;
+            Dice.keep_size[keeps] = size;
+            for (int f = 1; f <= NUMBER_OF_SIDES; ++f) {
+                Dice.keep_counts[keeps][f] = counts[f];
+            }
+            if (size == NUMBER_OF_DICE) {
+                r = keeps - SOLVER_FIRST_ROLL;
+                ways = factorial[NUMBER_OF_DICE];
+                for (int f = 1, d = 0; f <= NUMBER_OF_SIDES; ++f) {
+                    ways /= factorial[counts[f]];
+                    for (int c = 0; c < counts[f]; ++c) {
+                        Dice.roll_dice[r][d++] = f;
+                    }
+                }
+                Dice.roll_chance[r] = ways / 7776.0f;
+                for (int item = ACES; item <= CHANCE; ++item) {
+                    Dice.roll_score[r][item] =
+                        rules_score(Dice.roll_dice[r], item);
+                    Dice.roll_joker[r][item] =
+                        rules_card_score(Dice.roll_dice[r], 1u << YAHTZEE,
+                                         item);
+                }
+                Dice.roll_yahtzee[r] = rules_joker(Dice.roll_dice[r],
+                                                   1u << YAHTZEE);
+            }
+            ++keeps;
+        }
+    }
+
+    // Now that every keep has a number, what adding a die makes
+    for (int key = 0; key < KEY_SIZE; ++key) {
+        if ((Key_keep[key] == NO_KEEP) ||
+            (Dice.keep_size[Key_keep[key]] == NUMBER_OF_DICE)) {
+            continue;
+        }
+        for (int f = 1, k = key; f <= NUMBER_OF_SIDES; ++f) {
+            counts[f] = k % NUMBER_OF_SIDES;
+            k /= NUMBER_OF_SIDES;
+        }
+        for (int f = 1; f <= NUMBER_OF_SIDES; ++f) {
+            ++counts[f];
+            Dice.keep_child[Key_keep[key]][f - 1] = Key_keep[key_of(counts)];
+            --counts[f];
+        }
+    }
+
+}//end build_keeps
+
+
+// ---------------------------------------------------------------------
+// Function
+//     build_subs
+// Inputs
+//     none
+// Outputs
+//     none
+// Description
+//     This function lists, for every roll, each different set of its
+//     dice that could be kept (including none and all of them).
+// ---------------------------------------------------------------------
+static void build_subs(void)
+{
+    int          counts[NUMBER_OF_SIDES + 1];
+    int          keep[NUMBER_OF_SIDES + 1];
+    unsigned int n = 0;
+    bool         more;
+
+    for (int r = 0; r < SOLVER_ROLLS; ++r) {
+        Dice.sub_start[r] = n;
+        memset(counts, 0, sizeof(counts));
+        for (int d = 0; d < NUMBER_OF_DICE; ++d) {
+            ++counts[Dice.roll_dice[r][d]];
+        }
+
+        // Count through every keep[f] from 0 to counts[f]
+        memset(keep, 0, sizeof(keep));
+        do {
+            Dice.subs[n++] = Key_keep[key_of(keep)];
+            more = false;
+            for (int f = 1; (f <= NUMBER_OF_SIDES) && !more; ++f) {
+                if (keep[f] < counts[f]) {
+                    ++keep[f];
+                    more = true;
+                } else {
+                    keep[f] = 0;
+                }
+            }
+        } while (more);
+    }
+    Dice.sub_start[SOLVER_ROLLS] = n;
+
+}//end build_subs
+
+
+// ---------------------------------------------------------------------
+// Function
+//     build_layers
+// Inputs
+//     none
+// Outputs
+//     none
+// Description
+//     This function sorts the scorecard masks by how many items are
+//     used, works out which upper totals each mask can have, and ranks
+//     the groups of masks that owner_of() deals out.
+// ---------------------------------------------------------------------
+static void build_layers(void)
+{
+    unsigned int n = 0;
+
+    for (int layer = 0; layer <= NUMBER_OF_CATEGORIES; ++layer) {
+        Layer_start[layer] = n;
+        for (unsigned int mask = 0; mask < SOLVER_MASKS; ++mask) {
+            if (__builtin_popcount(mask) == layer) {
+                Masks[n++] = mask;
+            }
+        }
+    }
+    Layer_start[NUMBER_OF_CATEGORIES + 1] = n;
+
+    // Each used upper item adds 0 thru 5 of its face to what the rest
+    // of the used upper items could add up to
+    Reachable[0][0] = true;
+    for (unsigned int upper = 1; upper <= SOLVER_UPPER_BITS; ++upper) {
+        int          item = __builtin_ctz(upper) + ACES;
+        unsigned int rest = upper & (upper - 1);
+
+        for (int u = 0; u < SOLVER_UPPER; ++u) {
+            if (!Reachable[rest][u]) {
+                continue;
+            }
+            for (int c = 0; c <= NUMBER_OF_DICE; ++c) {
+                Reachable[upper][solver_upper_after(u, item, c * item)] =
+                    true;
+            }
+        }
+    }
+
+    // Rank the groups of masks owner_of() deals out by how much work
+    // they are: items used, then which upper items
+    n = 0;
+    for (int used = 0; used <= __builtin_popcount(OWNER_GROUPS - 1); ++used) {
+        for (unsigned int upper = 0;
+             upper <= (SOLVER_UPPER_BITS >> PAGE_CARDS_SHIFT); ++upper) {
+            for (unsigned int g = 0; g < OWNER_GROUPS; ++g) {
+                if ((__builtin_popcount(g) == used) &&
+                    ((g & (SOLVER_UPPER_BITS >> PAGE_CARDS_SHIFT)) == upper)) {
+                    Group_rank[g] = n++;
+                }
+            }
+        }
+    }
+
+}//end build_layers
+
+
+// ---------------------------------------------------------------------
+// Function
+//     build
+// Inputs
+//     none
+// Outputs
+//     none
+// Description
+//     This function builds all the tables, once.
+// ---------------------------------------------------------------------
+static void build(void)
+{
+    build_keeps();
+    build_subs();
+    build_layers();
+}//end build
+
+
+// ---------------------------------------------------------------------
+// Function
+//     owner_of
+// Inputs
+//     mask
+//         The items used.
+//     threads
+//         How many threads there are.
+// Outputs
+//     function result
+// Description
+//     Returns the thread that solves the mask with first touch, the
+//     same in every layer. The masks of the cards that share a 4 KB
+//     page of the points table, with YAHTZEE scored 50 or not, differ
+//     only in the bits outside the mask's group, so each such page has
+//     just one owner (but for the line of the card before it, since
+//     solver_alloc()'s header shifts the table by a line). The groups are dealt out in order of work, back
+//     and forth, to keep each layer's work even.
+// ---------------------------------------------------------------------
+static int owner_of(const unsigned int mask, const int threads)
+{
+    int rank = Group_rank[(mask >> PAGE_CARDS_SHIFT) & (OWNER_GROUPS - 1)];
+    int t = rank % threads;
+
+    return ((rank / threads) % 2) ? threads - 1 - t : t;
+
+}//end owner_of
+
+
+// ---------------------------------------------------------------------
+// Function
+//     layer_wait
+// Inputs
+//     job
+//         The layer_job_t.
+// Outputs
+//     none
+// Description
+//     This function waits until every thread of the job has got here.
+// ---------------------------------------------------------------------
+static void layer_wait(struct layer_job_t *job)
+{
+    unsigned int round;
+
+    pthread_mutex_lock(&job->lock);
+    round = job->round;
+    if (++job->waiting == job->threads) {
+        job->waiting = 0;
+        ++job->round;
+        pthread_cond_broadcast(&job->passed);
+    }
+    while (job->round == round) {
+        pthread_cond_wait(&job->passed, &job->lock);
+    }
+    pthread_mutex_unlock(&job->lock);
+
+}//end layer_wait
+
+
+// ---------------------------------------------------------------------
+// Function
+//     layer_loop
+// Inputs
+//     arg
+//         The layer_thread_t.
+// Outputs
+//     function result
+// Description
+//     This is one of solver_by_layer()'s threads. In each layer it
+//     solves the masks it owns with first touch, or else claims masks
+//     until there are none left, and then waits for the others. Its
+//     scratch memory is its own, so it's allocated (and first touched)
+//     here; if any thread has none, no thread solves anything.
+// ---------------------------------------------------------------------
+static void *layer_loop(void *arg)
+{
+    struct layer_thread_t *self = arg;
+    struct layer_job_t    *job = self->job;
+    void                  *scratch = solver_alloc(job->scratch_bytes);
+    unsigned int           i;
+
+    if (scratch == NULL) {
+        __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+    }
+    layer_wait(job);
+
+    for (int layer = NUMBER_OF_CATEGORIES;
+         (layer >= 0) && !__atomic_load_n(&job->failed, __ATOMIC_RELAXED);
+         --layer) {
+        if (First_touch) {
+            for (i = Layer_start[layer]; i < Layer_start[layer + 1]; ++i) {
+                if (owner_of(Masks[i], job->threads) == self->index) {
+                    job->fn(Masks[i], job->context, scratch);
+                }
+            }
+        } else {
+            while ((i = __atomic_fetch_add(&job->next[layer], 1,
+                                           __ATOMIC_RELAXED)) <
+                   Layer_start[layer + 1]) {
+                job->fn(Masks[i], job->context, scratch);
+            }
+        }
+        layer_wait(job);
+    }
+    solver_free(scratch);
+
+    return NULL;
+
+}//end layer_loop
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solve_mask
+// Inputs
+//     mask
+//         The items used.
+//     context
+//         The table being filled in.
+//     scratch
+//         A solver_turn_t for this thread.
+// Outputs
+//     none
+// Description
+//     This function solves every reachable scorecard with these items
+//     used, with YAHTZEE scored 50 or not, for solver_solve().
+// ---------------------------------------------------------------------
+static void solve_mask(const unsigned int mask, void *context, void *scratch)
+{
+    float        *ev = context;
+    unsigned int  card;
+    int           state;
+
+    for (int fifty = 0; fifty <= ((mask & SOLVER_YAHTZEE_BIT) != 0);
+         ++fifty) {
+        card = solver_card(mask, fifty);
+        for (int u = 0; u < SOLVER_UPPER; ++u) {
+            state = card * SOLVER_UPPER + u;
+            if ((mask == SOLVER_MASKS - 1) || !solver_reachable(mask, u) ||
+                (solver_state(card, u) != state)) {
+                ev[state] = 0;
+            } else {
+                solver_turn(ev, state, scratch);
+                ev[state] = ((struct solver_turn_t *)scratch)->keep[0][0];
+            }
+        }
+    }
+
+}//end solve_mask
+
+
+// ---------------------------------------------------------------------
+// Function
+//     open_items
+// Inputs
+//     mask
+//         The items used.
+//     r
+//         The roll.
+// Outputs
+//     function result
+// Description
+//     Returns the items the roll may be scored in (bit item - 1): the
+//     open ones, but for a Joker, the ones rules_allowed() allows.
+// ---------------------------------------------------------------------
+static unsigned int open_items(const unsigned int mask, const int r)
+{
+    unsigned int open = ~mask & (SOLVER_MASKS - 1);
+    unsigned int face = 1u << (Dice.roll_dice[r][0] - ACES);
+
+    if (!(mask & SOLVER_YAHTZEE_BIT) || !Dice.roll_yahtzee[r]) {
+        return open;
+    } else if (open & face) {
+        return face;
+    } else if (open & SOLVER_LOWER_BITS) {
+        return open & SOLVER_LOWER_BITS;
+    }
+
+    return open;
+
+}//end open_items
+
+
+// ---------------------------------------------------------------------
+// Function
+//     item_score
+// Inputs
+//     mask
+//         The items used.
+//     r
+//         The roll.
+//     item
+//         An item it may be scored in.
+// Outputs
+//     function result
+// Description
+//     Returns what the roll scores in the item, as a Joker if it is
+//     one.
+// ---------------------------------------------------------------------
+static inline int item_score(const unsigned int mask, const int r,
+                             const int item)
+{
+    return ((mask & SOLVER_YAHTZEE_BIT) && Dice.roll_yahtzee[r]) ?
+           Dice.roll_joker[r][item] : Dice.roll_score[r][item];
+}//end item_score
+
+
+// ---------------------------------------------------------------------
+// Function
+//     score_value
+// Inputs
+//     next
+//         The rows of the scorecards after this one, from solver_rows().
+//     state
+//         The scorecard.
+//     r
+//         The roll.
+//     item
+//         An item the roll may be scored in.
+// Outputs
+//     function result
+// Description
+//     Returns what scoring the roll in the item is worth, in points
+//     still to come.
+// ---------------------------------------------------------------------
+static float score_value(const float *next[], const int state, const int r,
+                         const int item)
+{
+    unsigned int card = state / SOLVER_UPPER;
+    unsigned int mask = solver_card_mask(card);
+    int          upper = state % SOLVER_UPPER;
+    int          score = item_score(mask, r, item);
+    unsigned int after = solver_card_after(card, item, score);
+    int          row = ((item == YAHTZEE) && (score == 0)) ? SOLVER_ZERO_ROW
+                                                           : item;
+    int          bonus = ((card >= SOLVER_MASKS) && Dice.roll_yahtzee[r]) ?
+                         SCORE_YAHTZEE_BONUS : 0;
+
+    return score + bonus + solver_bonus_after(upper, item, score) +
+           next[row][solver_state(after, solver_upper_after(upper, item,
+                                                            score)) -
+                     (int)(after * SOLVER_UPPER)];
+
+}//end score_value
+
+
+// ************************************************************************
+// *************************  EXTERNAL FUNCTIONS **************************
+// ************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_dice
+// Inputs
+//     none
+// Outputs
+//     function result
+// Description
+//     Returns the tables of rolls and keeps, building them the first
+//     time.
+// ---------------------------------------------------------------------
+const struct solver_dice_t *solver_dice(void)
+{
+    pthread_once(&Once, build);
+    return &Dice;
+}//end solver_dice
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_roll_of
+// Inputs
+//     dice
+//         The face values of all the dice, in any order.
+// Outputs
+//     function result
+// Description
+//     Returns which of the SOLVER_ROLLS rolls the dice are.
+// ---------------------------------------------------------------------
+int solver_roll_of(const unsigned char dice[])
+{
+    return solver_keep_of(dice, (1u << NUMBER_OF_DICE) - 1) -
+           SOLVER_FIRST_ROLL;
+}//end solver_roll_of
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_keep_of
+// Inputs
+//     dice
+//         The face values of all the dice.
+//     keep
+//         Which of them are kept; bit 0 is the first die.
+// Outputs
+//     function result
+// Description
+//     Returns which of the SOLVER_KEEPS keeps those dice are.
+// ---------------------------------------------------------------------
+int solver_keep_of(const unsigned char dice[], const unsigned int keep)
+{
+    static const int power[NUMBER_OF_SIDES + 1] = {
+        0, 1, 6, 36, 216, 1296, 7776
+    };
+    int key = 0;
+
+    solver_dice();
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        if (keep & (1u << i)) {
+            key += power[dice[i]];
+        }
+    }
+
+    return Key_keep[key];
+
+}//end solver_keep_of
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_keep_dice
+// Inputs
+//     dice
+//         The face values of all the dice.
+//     keep
+//         A keep that's part of the dice.
+// Outputs
+//     function result
+// Description
+//     Returns which dice to keep (bit 0 is the first die) to keep
+//     that keep. Of equal dice, the first ones are kept.
+// ---------------------------------------------------------------------
+unsigned int solver_keep_dice(const unsigned char dice[], const int keep)
+{
+    const struct solver_dice_t *d = solver_dice();
+    unsigned char               counts[NUMBER_OF_SIDES + 1];
+    unsigned int                mask = 0;
+
+    memcpy(counts, d->keep_counts[keep], sizeof(counts));
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        if (counts[dice[i]] > 0) {
+            --counts[dice[i]];
+            mask |= 1u << i;
+        }
+    }
+
+    return mask;
+
+}//end solver_keep_dice
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_state_of
+// Inputs
+//     game
+//         A game.
+// Outputs
+//     function result
+// Description
+//     Returns the game's scorecard as a solver_state().
+// ---------------------------------------------------------------------
+int solver_state_of(const struct game_t *game)
+{
+    int upper = game_upper(game);
+
+    if (upper > BONUS_THRESHOLD) {
+        upper = BONUS_THRESHOLD;
+    }
+
+    return solver_state(solver_card(game->used >> ACES,
+                                    game->score[YAHTZEE] == SCORE_YAHTZEE),
+                        upper);
+
+}//end solver_state_of
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_reachable
+// Inputs
+//     mask
+//         The items used.
+//     upper
+//         An upper section total (up to BONUS_THRESHOLD).
+// Outputs
+//     function result
+// Description
+//     Returns true if some game could get that upper total with those
+//     items used.
+// ---------------------------------------------------------------------
+bool solver_reachable(const unsigned int mask, const int upper)
+{
+    solver_dice();
+    return Reachable[mask & SOLVER_UPPER_BITS][upper];
+}//end solver_reachable
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_upper_after
+// Inputs
+//     upper
+//         The upper section total (up to BONUS_THRESHOLD).
+//     item
+//         The item being scored.
+//     score
+//         What it's scored as.
+// Outputs
+//     function result
+// Description
+//     Returns the upper section total afterward.
+// ---------------------------------------------------------------------
+int solver_upper_after(const int upper, const int item, const int score)
+{
+    if ((item > SIXES) || (upper + score < BONUS_THRESHOLD)) {
+        return (item > SIXES) ? upper : upper + score;
+    }
+
+    return BONUS_THRESHOLD;
+
+}//end solver_upper_after
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_bonus_after
+// Inputs
+//     upper, item, score
+//         As for solver_upper_after().
+// Outputs
+//     function result
+// Description
+//     Returns the bonus this score earns: SCORE_BONUS if it's the one
+//     that gets the upper section to BONUS_THRESHOLD, and 0 otherwise.
+// ---------------------------------------------------------------------
+int solver_bonus_after(const int upper, const int item, const int score)
+{
+    return ((item <= SIXES) && (upper < BONUS_THRESHOLD) &&
+            (upper + score >= BONUS_THRESHOLD)) ? SCORE_BONUS : 0;
+}//end solver_bonus_after
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_expect
+// Inputs
+//     roll_values
+//         What holding each roll is worth, width values per roll.
+//     keep_values
+//         Where to put what each keep is worth, width values per keep.
+//     width
+//         How many values there are for each roll or keep.
+// Outputs
+//     none
+// Description
+//     This function works out what keeping each set of dice and
+//     rolling the rest is worth, on average, from what each roll is
+//     worth.
+// ---------------------------------------------------------------------
+void solver_expect(const float roll_values[], float keep_values[],
+                   const int width)
+{
+    const struct solver_dice_t *d = solver_dice();
+    const float                *child[NUMBER_OF_SIDES];
+    float                      *value;
+
+    memcpy(keep_values + (size_t)SOLVER_FIRST_ROLL * width, roll_values,
+           (size_t)SOLVER_ROLLS * width * sizeof(float));
+    for (int k = SOLVER_FIRST_ROLL - 1; k >= 0; --k) {
+        value = keep_values + (size_t)k * width;
+        for (int f = 0; f < NUMBER_OF_SIDES; ++f) {
+            child[f] = keep_values + (size_t)d->keep_child[k][f] * width;
+        }
+        for (int j = 0; j < width; ++j) {
+            value[j] = (child[0][j] + child[1][j] + child[2][j] +
+                        child[3][j] + child[4][j] + child[5][j]) *
+                       (1.0f / NUMBER_OF_SIDES);
+        }
+    }
+
+}//end solver_expect
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_best
+// Inputs
+//     keep_values
+//         What each keep is worth, width values per keep.
+//     roll_values
+//         Where to put what holding each roll is worth, width values
+//         per roll.
+//     width
+//         How many values there are for each roll or keep.
+// Outputs
+//     none
+// Description
+//     This function works out what each roll is worth with another
+//     roll to come: the best of the keeps it allows.
+// ---------------------------------------------------------------------
+void solver_best(const float keep_values[], float roll_values[],
+                 const int width)
+{
+    const struct solver_dice_t *d = solver_dice();
+    const float                *keep;
+    float                      *value;
+
+    for (int r = 0; r < SOLVER_ROLLS; ++r) {
+        value = roll_values + (size_t)r * width;
+        memcpy(value, keep_values + (size_t)(SOLVER_FIRST_ROLL + r) * width,
+               width * sizeof(float));
+        for (int s = d->sub_start[r]; s < d->sub_start[r + 1]; ++s) {
+            keep = keep_values + (size_t)d->subs[s] * width;
+            for (int j = 0; j < width; ++j) {
+                value[j] = (keep[j] > value[j]) ? keep[j] : value[j];
+            }
+        }
+    }
+
+}//end solver_best
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_by_layer
+// Inputs
+//     threads
+//         How many threads to use.
+//     fn
+//         What to call for each mask.
+//     context
+//         What to pass to fn.
+//     scratch_bytes
+//         How much memory each thread gives fn to work in.
+// Outputs
+//     function result
+// Description
+//     This function calls fn for every scorecard mask, from the full
+//     one down to the empty one. All the masks with the same number of
+//     items used are done at once, spread over the threads, and all of
+//     them are finished before any mask with one item fewer is started.
+//     The same threads do every layer. It returns !SUCCESS, having
+//     solved nothing, if a thread had no memory for its scratch.
+// ---------------------------------------------------------------------
+int solver_by_layer(const int threads, solver_mask_fn_t fn, void *context,
+                    const size_t scratch_bytes)
+{
+    struct layer_thread_t self[MAX_THREADS];
+    struct layer_job_t    job = { fn, context, scratch_bytes };
+    int                   n = (threads > MAX_THREADS) ? MAX_THREADS : threads;
+    int                   started;
+
+    solver_dice();
+    for (int layer = 0; layer <= NUMBER_OF_CATEGORIES; ++layer) {
+        job.next[layer] = Layer_start[layer];
+    }
+    pthread_mutex_init(&job.lock, NULL);
+    pthread_cond_init(&job.passed, NULL);
+
+    // The threads can't start a layer until they know how many started
+    pthread_mutex_lock(&job.lock);
+    for (started = 1; started < n; ++started) {
+        self[started].job   = &job;
+        self[started].index = started;
+        if (pthread_create(&self[started].thread, NULL, layer_loop,
+                           &self[started]) != 0) {
+            break;
+        }
+    }
+    job.threads = started;
+    pthread_mutex_unlock(&job.lock);
+
+    self[0].job   = &job;
+    self[0].index = 0;
+    layer_loop(&self[0]);
+    for (int t = 1; t < started; ++t) {
+        pthread_join(self[t].thread, NULL);
+    }
+    pthread_cond_destroy(&job.passed);
+    pthread_mutex_destroy(&job.lock);
+
+    return job.failed ? !SUCCESS : SUCCESS;
+
+}//end solver_by_layer
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_memory
+// Inputs
+//     pages
+//         The SOLVER_PAGES_ kind of pages for solver_alloc() to use.
+//     first_touch
+//         Whether to leave the memory for whoever first writes it to
+//         touch, rather than touching it all when it's allocated.
+// Outputs
+//     function result
+// Description
+//     This function sets how the big arrays that solvers fill in (the
+//     tables, and each thread's scratch memory) are allocated, for the
+//     whole process. It's meant to be called before solving, and
+//     returns !SUCCESS, changing nothing, if the kernel doesn't have
+//     that kind of page.
+//
+//     Huge pages need far fewer TLB entries to cover a table. On a
+//     machine with more than one memory node, memory is placed on the
+//     node of the thread that first touches it. With first_touch, each
+//     thread of solver_by_layer() solves the same masks in every layer,
+//     and all the cards on a 4 KB page of the points table are one
+//     thread's (see owner_of()), so that thread touches the page and
+//     is the only one that writes it. Its scratch memory is its own
+//     too. This trades a few percent of even work in each layer for
+//     the locality; without first_touch the threads claim masks as
+//     they go, and everything is near the thread that allocated it.
+//
+//     The threads aren't pinned, so this holds as long as the kernel
+//     keeps them on their nodes. A 2 MB huge page holds 8192 cards,
+//     every thread's, so with huge pages each of the table's few pages
+//     is just near whichever thread touches it first.
+// ---------------------------------------------------------------------
+int solver_memory(const int pages, const bool first_touch)
+{
+    void *p;
+    bool  ok;
+
+    if ((pages < SOLVER_PAGES_SMALL) || (pages >= SOLVER_PAGES)) {
+        return !SUCCESS;
+    }
+
+    // Try one huge page of the kind asked for
+    if (pages == SOLVER_PAGES_HUGETLB) {
+        p  = mmap(NULL, HUGE_PAGE, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        ok = (p != MAP_FAILED);
+        if (ok) {
+            munmap(p, HUGE_PAGE);
+        }
+    } else if (pages == SOLVER_PAGES_THP) {
+        p  = mmap(NULL, 2 * HUGE_PAGE, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        ok = (p != MAP_FAILED);
+        if (ok) {
+            ok = (madvise((char *)p + HUGE_PAGE -
+                          (uintptr_t)p % HUGE_PAGE, HUGE_PAGE,
+                          MADV_HUGEPAGE) == 0);
+            munmap(p, 2 * HUGE_PAGE);
+        }
+    } else {
+        ok = true;
+    }
+    if (!ok) {
+        return !SUCCESS;
+    }
+
+    Pages       = pages;
+    First_touch = first_touch;
+
+    return SUCCESS;
+
+}//end solver_memory
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_pages_name
+// Inputs
+//     pages
+//         A SOLVER_PAGES_ kind of page.
+// Outputs
+//     function result
+// Description
+//     Returns the name of the kind of page, for reports.
+// ---------------------------------------------------------------------
+const char *solver_pages_name(const int pages)
+{
+    static const char *names[SOLVER_PAGES] = { "small", "thp", "hugetlb" };
+
+    return ((pages >= 0) && (pages < SOLVER_PAGES)) ? names[pages] : "?";
+}//end solver_pages_name
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_alloc
+// Inputs
+//     bytes
+//         How much memory is needed.
+// Outputs
+//     function result
+// Description
+//     This function allocates memory for a solver's array as
+//     solver_memory() says, to be freed with solver_free(), or returns
+//     NULL if there's none. The memory starts out zero. Arrays smaller
+//     than a huge page always get small pages, and if the reserved
+//     huge pages run out, so do bigger ones.
+// ---------------------------------------------------------------------
+void *solver_alloc(const size_t bytes)
+{
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t size = bytes + ALLOC_HEADER;
+    char  *base = MAP_FAILED;
+    char  *p;
+    size_t extra;
+
+    if ((Pages == SOLVER_PAGES_HUGETLB) && (size >= HUGE_PAGE)) {
+        size = (size + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+        base = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    } else if ((Pages == SOLVER_PAGES_THP) && (size >= HUGE_PAGE)) {
+        // Line the array up with huge pages, and give back the rest
+        size = (size + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+        p    = mmap(NULL, size + HUGE_PAGE, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p != MAP_FAILED) {
+            extra = (HUGE_PAGE - (uintptr_t)p % HUGE_PAGE) % HUGE_PAGE;
+            base  = p + extra;
+            if (extra > 0) {
+                munmap(p, extra);
+            }
+            munmap(base + size, HUGE_PAGE - extra);
+            madvise(base, size, MADV_HUGEPAGE);
+        }
+    }
+    if (base == MAP_FAILED) {
+        size = (bytes + ALLOC_HEADER + page - 1) / page * page;
+        base = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) {
+            return NULL;
+        }
+    }
+
+    if (!First_touch) {
+        memset(base, 0, size);
+    }
+    *(size_t *)base = size;
+
+    return base + ALLOC_HEADER;
+
+}//end solver_alloc
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_free
+// Inputs
+//     p
+//         Memory from solver_alloc(), or NULL.
+// Outputs
+//     none
+// Description
+//     This function frees the memory.
+// ---------------------------------------------------------------------
+void solver_free(void *p)
+{
+    char *base = (char *)p - ALLOC_HEADER;
+
+    if (p != NULL) {
+        munmap(base, *(size_t *)base);
+    }
+
+}//end solver_free
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_solve
+// Inputs
+//     threads
+//         How many threads to use.
+// Outputs
+//     function result
+// Description
+//     This function solves the game for the most points on average,
+//     and returns a table of SOLVER_STATES values (to be freed by the
+//     caller): the points still to come from the start of a turn with
+//     each scorecard, with the best play. It returns NULL if there's
+//     no memory for it. The table is from solver_alloc(), so it's
+//     freed with solver_free().
+// ---------------------------------------------------------------------
+float *solver_solve(const int threads)
+{
+    float *ev = solver_alloc(SOLVER_STATES * sizeof(float));
+
+    if ((ev != NULL) &&
+        (solver_by_layer(threads, solve_mask, ev,
+                         sizeof(struct solver_turn_t)) != SUCCESS)) {
+        solver_free(ev);
+        return NULL;
+    }
+
+    return ev;
+
+}//end solver_solve
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_turn_back
+// Inputs
+//     turn
+//         A turn with what each roll is worth after the last roll
+//         (turn->roll[MAX_ROLLS - 1]) filled in.
+// Outputs
+//     none
+// Description
+//     This function works back from the last roll to what every roll
+//     and keep is worth at each point of the turn. turn->keep[0][0]
+//     (keeping nothing for the first roll) is what the turn is worth.
+// ---------------------------------------------------------------------
+void solver_turn_back(struct solver_turn_t *turn)
+{
+    for (int n = MAX_ROLLS - 1; n >= 0; --n) {
+        solver_expect(turn->roll[n], turn->keep[n], 1);
+        if (n > 0) {
+            solver_best(turn->keep[n], turn->roll[n - 1], 1);
+        }
+    }
+
+}//end solver_turn_back
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_rows
+// Inputs
+//     ev
+//         The solved table.
+//     card
+//         The card at the start of a turn.
+//     next
+//         Where to put the rows.
+// Outputs
+//     none
+// Description
+//     This function points next[item], for each item not used yet, at
+//     the row of SOLVER_UPPER values of the scorecard with it used:
+//     all a turn needs from the table. YAHTZEE has two rows, one for
+//     each card it can lead to: next[YAHTZEE] for scoring 50, and
+//     next[SOLVER_ZERO_ROW] for scoring 0.
+// ---------------------------------------------------------------------
+void solver_rows(const float ev[], const unsigned int card,
+                 const float *next[])
+{
+    unsigned int mask = solver_card_mask(card);
+
+    for (int item = ACES; item <= CHANCE; ++item) {
+        if (!(mask & (1u << (item - ACES)))) {
+            next[item] = ev + solver_card_after(card, item, SCORE_YAHTZEE) *
+                              SOLVER_UPPER;
+        }
+    }
+    if (!(mask & SOLVER_YAHTZEE_BIT)) {
+        next[SOLVER_ZERO_ROW] = ev + solver_card_after(card, YAHTZEE, 0) *
+                                     SOLVER_UPPER;
+    }
+
+}//end solver_rows
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_items
+// Inputs
+//     state
+//         The scorecard.
+//     r
+//         The roll.
+// Outputs
+//     function result
+// Description
+//     Returns the items the roll may be scored in (bit item - 1), by
+//     the Joker rule.
+// ---------------------------------------------------------------------
+unsigned int solver_items(const int state, const int r)
+{
+    solver_dice();
+    return open_items(solver_card_mask(state / SOLVER_UPPER), r);
+}//end solver_items
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_item_score
+// Inputs
+//     state
+//         The scorecard.
+//     r
+//         The roll.
+//     item
+//         An item it may be scored in.
+// Outputs
+//     function result
+// Description
+//     Returns what the roll scores in the item, by the Joker rule. Any
+//     YAHTZEE bonus (solver_yahtzee_bonus()) or upper section bonus
+//     is on top of this.
+// ---------------------------------------------------------------------
+int solver_item_score(const int state, const int r, const int item)
+{
+    solver_dice();
+    return item_score(solver_card_mask(state / SOLVER_UPPER), r, item);
+}//end solver_item_score
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_yahtzee_bonus
+// Inputs
+//     state
+//         The scorecard.
+//     r
+//         The roll.
+// Outputs
+//     function result
+// Description
+//     Returns the YAHTZEE bonus scoring the roll earns, wherever it's
+//     scored.
+// ---------------------------------------------------------------------
+int solver_yahtzee_bonus(const int state, const int r)
+{
+    solver_dice();
+    return ((state / SOLVER_UPPER >= SOLVER_MASKS) && Dice.roll_yahtzee[r]) ?
+           SCORE_YAHTZEE_BONUS : 0;
+}//end solver_yahtzee_bonus
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_item_value
+// Inputs
+//     next
+//         The rows of the scorecards after this one, from solver_rows().
+//     state
+//         The scorecard.
+//     r
+//         The roll.
+//     item
+//         An item the roll may be scored in (see solver_items()).
+// Outputs
+//     function result
+// Description
+//     Returns what scoring the roll in the item is worth, in points
+//     still to come.
+// ---------------------------------------------------------------------
+float solver_item_value(const float *next[], const int state, const int r,
+                        const int item)
+{
+    solver_dice();
+    return score_value(next, state, r, item);
+
+}//end solver_item_value
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_turn_rows
+// Inputs
+//     next
+//         The rows of the scorecards after this one, from solver_rows().
+//     state
+//         The scorecard at the start of the turn.
+//     turn
+//         Where to put the values for the turn.
+// Outputs
+//     none
+// Description
+//     This function works out what every roll and keep is worth at
+//     each point of a turn, in points still to come.
+// ---------------------------------------------------------------------
+void solver_turn_rows(const float *next[], const int state,
+                      struct solver_turn_t *turn)
+{
+    unsigned int mask = solver_card_mask(state / SOLVER_UPPER);
+    unsigned int items;
+    float        value;
+    float        best;
+
+    solver_dice();
+
+    // After the last roll, the dice have to be scored
+    for (int r = 0; r < SOLVER_ROLLS; ++r) {
+        best = 0;
+        for (items = open_items(mask, r); items != 0;
+             items &= items - 1) {
+            value = score_value(next, state, r, __builtin_ctz(items) + ACES);
+            best  = (value > best) ? value : best;
+        }
+        turn->roll[MAX_ROLLS - 1][r] = best;
+    }
+
+    solver_turn_back(turn);
+    turn->state = state;
+
+}//end solver_turn_rows
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_turn
+// Inputs
+//     ev
+//         The solved table, at least for the scorecards after this
+//         one.
+//     state
+//         The scorecard at the start of the turn.
+//     turn
+//         Where to put the values for the turn.
+// Outputs
+//     none
+// Description
+//     This function is solver_turn_rows() straight from a table.
+// ---------------------------------------------------------------------
+void solver_turn(const float ev[], const int state, struct solver_turn_t *turn)
+{
+    const float *next[NUMBER_OF_CATEGORIES + 1];
+
+    solver_rows(ev, state / SOLVER_UPPER, next);
+    solver_turn_rows(next, state, turn);
+
+}//end solver_turn
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_best_keep
+// Inputs
+//     turn
+//         The values for the game's turn.
+//     game
+//         A game that isn't over.
+// Outputs
+//     function result
+// Description
+//     Returns the best keep for the game's dice. Keeping all of them
+//     means they should be scored now, as does being out of rolls.
+// ---------------------------------------------------------------------
+int solver_best_keep(const struct solver_turn_t *turn,
+                     const struct game_t *game)
+{
+    const struct solver_dice_t *d = solver_dice();
+    int                         r = solver_roll_of(game->dice);
+    int                         keep = SOLVER_FIRST_ROLL + r;
+    const float                *value;
+
+    if (game->roll >= MAX_ROLLS) {
+        return keep;
+    }
+
+    // Keeping everything wins a tie, since it's the same as scoring now
+    value = turn->keep[game->roll];
+    for (int s = d->sub_start[r]; s < d->sub_start[r + 1]; ++s) {
+        if (value[d->subs[s]] > value[keep]) {
+            keep = d->subs[s];
+        }
+    }
+
+    return keep;
+
+}//end solver_best_keep
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_keep_action
+// Inputs
+//     game
+//         A game that isn't over.
+//     keep
+//         The keep wanted for the game's dice.
+//     action
+//         Where to put the next action toward it.
+// Outputs
+//     function result
+// Description
+//     This function works out what to do next to keep the dice in the
+//     keep and roll the rest: switch a die between keep and roll, or
+//     roll. It returns false if the keep is all the dice, in which
+//     case they should be scored instead.
+// ---------------------------------------------------------------------
+bool solver_keep_action(const struct game_t *game, const int keep,
+                        struct game_action_t *action)
+{
+    unsigned int change;
+
+    if (keep == SOLVER_FIRST_ROLL + solver_roll_of(game->dice)) {
+        return false;
+    }
+
+    change = solver_keep_dice(game->dice, keep) ^ game->keep;
+    if (change != 0) {
+        action->type = GAME_KEEP;
+        action->arg  = __builtin_ctz(change) + 1;
+    } else {
+        action->type = GAME_ROLL;
+        action->arg  = 0;
+    }
+
+    return true;
+
+}//end solver_keep_action
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_best_item
+// Inputs
+//     next
+//         The rows of the scorecards after this one, from solver_rows().
+//     state
+//         The scorecard.
+//     r
+//         The roll.
+// Outputs
+//     function result
+// Description
+//     Returns the best item to score the roll in, of the ones the
+//     Joker rule allows.
+// ---------------------------------------------------------------------
+int solver_best_item(const float *next[], const int state, const int r)
+{
+    unsigned int items;
+    int          item;
+    int          best_item = 0;
+    float        value;
+    float        best = -1;
+
+    solver_dice();
+    for (items = open_items(solver_card_mask(state / SOLVER_UPPER), r);
+         items != 0; items &= items - 1) {
+        item  = __builtin_ctz(items) + ACES;
+        value = score_value(next, state, r, item);
+        if (value > best) {
+            best      = value;
+            best_item = item;
+        }
+    }
+
+    return best_item;
+
+}//end solver_best_item
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_choose
+// Inputs
+//     ev
+//         The solved table.
+//     game
+//         A game that isn't over.
+//     turn
+//         The values for the game's turn, if turn->state is the game's
+//         scorecard; otherwise they're worked out and kept here for
+//         the next call.
+// Outputs
+//     function result
+// Description
+//     Returns the best thing to do next for the most points: switch a
+//     die between keep and roll, roll, or score. Dice are switched one
+//     at a time until the best keep is set, then they're rolled.
+// ---------------------------------------------------------------------
+struct game_action_t solver_choose(const float ev[], const struct game_t *game,
+                                   struct solver_turn_t *turn)
+{
+    struct game_action_t action = { GAME_SCORE, 0 };
+    int                  state = solver_state_of(game);
+    const float         *next[NUMBER_OF_CATEGORIES + 1];
+
+    solver_rows(ev, state / SOLVER_UPPER, next);
+    if (turn->state != state) {
+        solver_turn_rows(next, state, turn);
+    }
+    if (solver_keep_action(game, solver_best_keep(turn, game), &action)) {
+        return action;
+    }
+    action.arg = solver_best_item(next, state, solver_roll_of(game->dice));
+
+    return action;
+
+}//end solver_choose
+
+// end solver.c
@@ -0,0 +1,230 @@
+// -------------------------------------------------------------------
+// File: solver.h
+//
+// Name: Marshall Liu
+//
+// Description: This is the header file for the SOLVER module, which
+//     works out the best way to play YAHTZEE by dynamic programming
+//     over the scorecard, and holds the tables of dice every such
+//     solver needs.
+// -------------------------------------------------------------------
+
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "score.h"
+#include "rules.h"
+#include "game.h"
+
+#define SOLVER_ROLLS      252   // Rolls of five dice, in any order
+#define SOLVER_KEEPS      462   // Sets of 0 thru 5 dice to keep
+#define SOLVER_FIRST_ROLL (SOLVER_KEEPS - SOLVER_ROLLS)  // Keep of roll 0
+#define SOLVER_MAX_SUBS   (SOLVER_ROLLS * (1 << NUMBER_OF_DICE))
+#define SOLVER_UPPER      (BONUS_THRESHOLD + 1)  // The last means "made"
+#define SOLVER_MASKS      (1u << NUMBER_OF_CATEGORIES)
+#define SOLVER_UPPER_BITS ((1u << SIXES) - 1)    // Upper items in a mask
+#define SOLVER_LOWER_BITS ((SOLVER_MASKS - 1) & ~SOLVER_UPPER_BITS)
+#define SOLVER_YAHTZEE_BIT (1u << (YAHTZEE - ACES))
+#define SOLVER_ZERO_ROW   0     // next[] row for YAHTZEE scored 0
+
+// The kinds of pages solver_alloc() can use (see solver_memory())
+#define SOLVER_PAGES_SMALL   0  // The usual 4 KB pages
+#define SOLVER_PAGES_THP     1  // Transparent huge pages, asked for
+#define SOLVER_PAGES_HUGETLB 2  // Huge pages reserved by the admin
+                                // (vm.nr_hugepages)
+#define SOLVER_PAGES         3
+
+// A scorecard's card is its mask of items used, and whether YAHTZEE
+// was scored 50 (which makes YAHTZEE bonuses possible). Only masks with
+// YAHTZEE used can have it, so the cards are numbered densely: first
+// every mask as itself, then the masks with YAHTZEE scored 50, with
+// the YAHTZEE bit squeezed out, 1.5 times as many cards as masks. A
+// scorecard (a state) is a card and an upper total.
+#define SOLVER_CARDS      (SOLVER_MASKS + SOLVER_MASKS / 2)
+#define SOLVER_STATES     (SOLVER_CARDS * SOLVER_UPPER)
+
+// Every roll and every set of dice that can be kept. Keeps are in
+// order of size, so the keeps of all five dice (the rolls) come last:
+// roll r is keep SOLVER_FIRST_ROLL + r.
+struct solver_dice_t {
+    unsigned char  roll_dice[SOLVER_ROLLS][NUMBER_OF_DICE];   // Sorted
+    unsigned char  roll_score[SOLVER_ROLLS][NUMBER_OF_CATEGORIES + 1];
+    unsigned char  roll_joker[SOLVER_ROLLS][NUMBER_OF_CATEGORIES + 1];
+    bool           roll_yahtzee[SOLVER_ROLLS];
+    float          roll_chance[SOLVER_ROLLS];      // Rolling all five
+    unsigned char  keep_size[SOLVER_KEEPS];
+    unsigned char  keep_counts[SOLVER_KEEPS][NUMBER_OF_SIDES + 1]; // By face
+    short          keep_child[SOLVER_KEEPS][NUMBER_OF_SIDES]; // Plus a die
+    unsigned short sub_start[SOLVER_ROLLS + 1];    // Into subs
+    unsigned short subs[SOLVER_MAX_SUBS];          // Keeps of each roll
+};
+
+// The best values during one turn, for one scorecard
+struct solver_turn_t {
+    int   state;                                // -1 if not worked out
+    float roll[MAX_ROLLS][SOLVER_ROLLS];        // Holding roll r after
+                                                // roll number n + 1
+    float keep[MAX_ROLLS][SOLVER_KEEPS];        // Keeping k for roll
+                                                // number n + 1
+};
+
+// Called by solver_by_layer() for each scorecard mask
+typedef void (*solver_mask_fn_t)(const unsigned int mask, void *context,
+                                 void *scratch);
+
+extern const struct solver_dice_t *solver_dice(void);
+extern int  solver_roll_of(const unsigned char dice[]);
+extern int  solver_keep_of(const unsigned char dice[],
+                           const unsigned int keep);
+extern unsigned int solver_keep_dice(const unsigned char dice[],
+                                     const int keep);
+extern int  solver_state_of(const struct game_t *game);
+extern bool solver_reachable(const unsigned int mask, const int upper);
+extern int  solver_upper_after(const int upper, const int item,
+                               const int score);
+extern int  solver_bonus_after(const int upper, const int item,
+                               const int score);
+extern void solver_expect(const float roll_values[], float keep_values[],
+                          const int width);
+extern void solver_best(const float keep_values[], float roll_values[],
+                        const int width);
+extern int  solver_memory(const int pages, const bool first_touch);
+extern const char *solver_pages_name(const int pages);
+extern void *solver_alloc(const size_t bytes);
+extern void solver_free(void *p);
+extern int  solver_by_layer(const int threads, solver_mask_fn_t fn,
+                            void *context, const size_t scratch_bytes);
+extern float *solver_solve(const int threads);
+extern void solver_turn_back(struct solver_turn_t *turn);
+extern void solver_rows(const float ev[], const unsigned int card,
+                        const float *next[]);
+extern unsigned int solver_items(const int state, const int r);
+extern int  solver_item_score(const int state, const int r, const int item);
+extern int  solver_yahtzee_bonus(const int state, const int r);
+extern float solver_item_value(const float *next[], const int state,
+                               const int r, const int item);
+extern void solver_turn_rows(const float *next[], const int state,
+                             struct solver_turn_t *turn);
+extern void solver_turn(const float ev[], const int state,
+                        struct solver_turn_t *turn);
+extern int  solver_best_keep(const struct solver_turn_t *turn,
+                             const struct game_t *game);
+extern bool solver_keep_action(const struct game_t *game, const int keep,
+                               struct game_action_t *action);
+extern int  solver_best_item(const float *next[], const int state,
+                             const int r);
+extern struct game_action_t solver_choose(const float ev[],
+                                          const struct game_t *game,
+                                          struct solver_turn_t *turn);
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_card
+// Inputs
+//     mask
+//         The items used, bit item - 1.
+//     fifty
+//         Whether YAHTZEE was scored 50. Without YAHTZEE used, it's
+//         ignored.
+// Outputs
+//     function result
+// Description
+//     Returns the number of the card. The cards of all the scorecards
+//     with the same mask but one are a mask apart from each other, so
+//     this is in the header to get inlined into solver loops.
+// ---------------------------------------------------------------------
+static inline unsigned int solver_card(const unsigned int mask,
+                                       const bool fifty)
+{
+    if (!fifty || !(mask & SOLVER_YAHTZEE_BIT)) {
+        return mask;
+    }
+
+    return SOLVER_MASKS + ((mask & (SOLVER_YAHTZEE_BIT - 1)) |
+                           ((mask >> 1) & ~(SOLVER_YAHTZEE_BIT - 1)));
+
+}//end solver_card
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_card_mask
+// Inputs
+//     card
+//         A card, from solver_card().
+// Outputs
+//     function result
+// Description
+//     Returns the card's mask of items used.
+// ---------------------------------------------------------------------
+static inline unsigned int solver_card_mask(const unsigned int card)
+{
+    unsigned int squeezed = card - SOLVER_MASKS;
+
+    if (card < SOLVER_MASKS) {
+        return card;
+    }
+
+    return (squeezed & (SOLVER_YAHTZEE_BIT - 1)) |
+           ((squeezed & ~(SOLVER_YAHTZEE_BIT - 1)) << 1) | SOLVER_YAHTZEE_BIT;
+
+}//end solver_card_mask
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_card_after
+// Inputs
+//     card
+//         A card.
+//     item
+//         An item not used yet.
+//     score
+//         What it's scored as.
+// Outputs
+//     function result
+// Description
+//     Returns the card after scoring the item.
+// ---------------------------------------------------------------------
+static inline unsigned int solver_card_after(const unsigned int card,
+                                             const int item, const int score)
+{
+    return solver_card(solver_card_mask(card) | (1u << (item - ACES)),
+                       (card >= SOLVER_MASKS) ||
+                       ((item == YAHTZEE) && (score == SCORE_YAHTZEE)));
+}//end solver_card_after
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solver_state
+// Inputs
+//     card
+//         The card, from solver_card(); a mask alone is the card with
+//         no YAHTZEE scored 50.
+//     upper
+//         The upper section total so far, which stops counting at
+//         BONUS_THRESHOLD.
+// Outputs
+//     function result
+// Description
+//     Returns the number of a scorecard, as far as the rest of the
+//     game goes. Once every upper item is used the upper total can't
+//     matter any more, so those scorecards are numbered as if it were
+//     0. This is in the header so it gets inlined into solver loops.
+// ---------------------------------------------------------------------
+static inline int solver_state(const unsigned int card, const int upper)
+{
+    if ((solver_card_mask(card) & SOLVER_UPPER_BITS) == SOLVER_UPPER_BITS) {
+        return card * SOLVER_UPPER;
+    }
+
+    return card * SOLVER_UPPER + upper;
+
+}//end solver_state
+
+#endif // SOLVER_H
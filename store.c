@@ -0,0 +1,168 @@
+// ----------------------------------------------------------------------
+// File: store.c
+//
+// Name: Al Shaffer & Marshall Liu
+//
+// Description: This STORE module hands out fixed size records from
+//     large slabs, so that a hundred thousand game sessions cost a few
+//     dozen mallocs instead of a hundred thousand. Freed records go on
+//     a freelist (threaded through the records themselves) and are
+//     handed out again before any new ones. A store is not locked; each
+//     thread that needs one keeps its own.
+// ----------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "store.h"
+
+#define FIRST_SLABS 16
+
+
+// ************************************************************************
+// *************************  EXTERNAL FUNCTIONS **************************
+// ************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     store_init
+// Inputs
+//     store
+//         The store to set up.
+//     record_size
+//         The size of every record in the store.
+// Outputs
+//     none
+// Description
+//     Sets up an empty store. No memory is allocated until the first
+//     record is.
+// ---------------------------------------------------------------------
+void store_init(struct store_t *store, const size_t record_size)
+{
+    memset(store, 0, sizeof(*store));
+
+    // The freelist link is kept in the record itself
+    store->record_size = (record_size < sizeof(uint32_t)) ?
+                         sizeof(uint32_t) : record_size;
+    store->free_head   = STORE_NONE;
+
+}//end store_init
+
+
+// ---------------------------------------------------------------------
+// Function
+//     store_destroy
+// Inputs
+//     store
+//         The store to get rid of.
+// Outputs
+//     none
+// Description
+//     Frees every slab. All the handles from the store become invalid.
+// ---------------------------------------------------------------------
+void store_destroy(struct store_t *store)
+{
+    for (uint32_t i = 0; i < store->num_slabs; ++i) {
+        free(store->slabs[i]);
+    }
+    free(store->slabs);
+    store_init(store, store->record_size);
+
+}//end store_destroy
+
+
+// ---------------------------------------------------------------------
+// Function
+//     store_alloc
+// Inputs
+//     store
+//         The store to take a record from.
+// Outputs
+//     function result
+// Description
+//     Returns the handle of an unused record, or STORE_NONE if memory
+//     ran out. The record's contents are whatever was there before.
+// ---------------------------------------------------------------------
+uint32_t store_alloc(struct store_t *store)
+{
+    uint32_t        handle;
+    unsigned char **slabs;
+    uint32_t        max_slabs;
+
+    if (store->free_head != STORE_NONE) {
+        handle = store->free_head;
+        memcpy(&store->free_head, store_get(store, handle),
+               sizeof(uint32_t));
+        ++store->live;
+        return handle;
+    }
+
+    if (store->next_unused == store->num_slabs * STORE_SLAB_SIZE) {
+        // Every slab is full, so add another one
+        if (store->num_slabs == (STORE_NONE >> STORE_SLAB_BITS)) {
+            return STORE_NONE;
+        }
+        if (store->num_slabs == store->max_slabs) {
+            max_slabs = (store->max_slabs == 0) ?
+                        FIRST_SLABS : store->max_slabs * 2;
+            slabs = realloc(store->slabs, max_slabs * sizeof(*slabs));
+            if (slabs == NULL) {
+                return STORE_NONE;
+            }
+            store->slabs     = slabs;
+            store->max_slabs = max_slabs;
+        }
+        store->slabs[store->num_slabs] =
+            malloc(STORE_SLAB_SIZE * store->record_size);
+        if (store->slabs[store->num_slabs] == NULL) {
+            return STORE_NONE;
+        }
+        ++store->num_slabs;
+    }
+
+    ++store->live;
+    return store->next_unused++;
+
+}//end store_alloc
+
+
+// ---------------------------------------------------------------------
+// Function
+//     store_free
+// Inputs
+//     store
+//         The store the record came from.
+//     handle
+//         The record to give back.
+// Outputs
+//     none
+// Description
+//     Puts the record on the freelist, to be handed out again by the
+//     next store_alloc(). Slabs are never given back to the system.
+// ---------------------------------------------------------------------
+void store_free(struct store_t *store, const uint32_t handle)
+{
+    memcpy(store_get(store, handle), &store->free_head, sizeof(uint32_t));
+    store->free_head = handle;
+    --store->live;
+
+}//end store_free
+
+
+// ---------------------------------------------------------------------
+// Function
+//     store_bytes
+// Inputs
+//     store
+//         The store to measure.
+// Outputs
+//     function result
+// Description
+//     Returns how much memory the store's slabs take up.
+// ---------------------------------------------------------------------
+size_t store_bytes(const struct store_t *store)
+{
+    return (size_t)store->num_slabs * STORE_SLAB_SIZE * store->record_size;
+}//end store_bytes
+
+// end store.c
@@ -0,0 +1,59 @@
+// -------------------------------------------------------------------
+// File: store.h
+//
+// Name: Marshall Liu
+//
+// Description: This is the header file for the STORE module, a slab
+//     allocator for many small records of one fixed size.
+// -------------------------------------------------------------------
+
+#ifndef STORE_H
+#define STORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define STORE_SLAB_BITS 12                      // 4096 records per slab
+#define STORE_SLAB_SIZE (1u << STORE_SLAB_BITS)
+#define STORE_NONE      UINT32_MAX              // No record
+
+// A store of fixed size records. Each record is named by a handle,
+// and never moves once allocated.
+struct store_t {
+    size_t          record_size;
+    unsigned char **slabs;
+    uint32_t        num_slabs;
+    uint32_t        max_slabs;     // Room in the slabs array
+    uint32_t        next_unused;   // First record never handed out
+    uint32_t        free_head;     // First record on the freelist
+    uint32_t        live;          // Records handed out right now
+};
+
+extern void     store_init(struct store_t *store, const size_t record_size);
+extern void     store_destroy(struct store_t *store);
+extern uint32_t store_alloc(struct store_t *store);
+extern void     store_free(struct store_t *store, const uint32_t handle);
+extern size_t   store_bytes(const struct store_t *store);
+
+// ---------------------------------------------------------------------
+// Function
+//     store_get
+// Inputs
+//     store
+//         The store the record came from.
+//     handle
+//         The record, as returned by store_alloc().
+// Outputs
+//     function result
+// Description
+//     Returns a pointer to the record. This is in the header so the
+//     lookup (a shift, a mask and a multiply) gets inlined.
+// ---------------------------------------------------------------------
+static inline void *store_get(const struct store_t *store,
+                              const uint32_t handle)
+{
+    return store->slabs[handle >> STORE_SLAB_BITS] +
+           (size_t)(handle & (STORE_SLAB_SIZE - 1)) * store->record_size;
+}//end store_get
+
+#endif // STORE_H
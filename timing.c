@@ -0,0 +1,39 @@
+// ----------------------------------------------------------------------
+// File: timing.c
+//
+// Name: Al Shaffer & Marshall Liu
+//
+// Description: This TIMING module tells how long something has been
+//     running, by the monotonic clock, for the drivers that report
+//     their times.
+// ----------------------------------------------------------------------
+
+#include <time.h>
+#include "timing.h"
+
+
+// ************************************************************************
+// *************************  EXTERNAL FUNCTIONS **************************
+// ************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     timing_since
+// Inputs
+//     start
+//         When something started, from clock_gettime(CLOCK_MONOTONIC).
+// Outputs
+//     function result
+// Description
+//     Returns how many seconds ago that was.
+// ---------------------------------------------------------------------
+double timing_since(const struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) +
+           (now.tv_nsec - start->tv_nsec) / 1e9;
+}//end timing_since
+
+// end timing.c
@@ -0,0 +1,17 @@
+// -------------------------------------------------------------------
+// File: timing.h
+//
+// Name: Marshall Liu
+//
+// Description: This is the header file for the TIMING module, which
+//     the benchmarks and other drivers use to time what they run.
+// -------------------------------------------------------------------
+
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <time.h>
+
+extern double timing_since(const struct timespec *start);
+
+#endif // TIMING_H
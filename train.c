@@ -0,0 +1,428 @@
+// ----------------------------------------------------------------------
+// File: train.c
+//
+// Name: Al Shaffer & Marshall Liu
+//
+// Description: This is the trainer for the LEARN module. It learns a
+//     model of scorecard values by self-play, in rounds of fitted
+//     value iteration: the model plays a batch of games, split over
+//     several threads that each add to their own sums, and then the
+//     sums are merged and the model is fitted again.
+//
+//     What a scorecard is fitted to isn't what its game went on to
+//     score, which varies by 50 points or more from game to game, but
+//     what the turn played from it is worth by the model's own values
+//     of the scorecards after it: the value working out the turn gives
+//     anyway, with no dice in it at all. The first round plays from an
+//     empty model, every scorecard worth 0, so it learns what one turn
+//     is worth; each round after looks a turn further ahead, and the
+//     games show which scorecards are worth getting right.
+//
+//     While training, a roll is sometimes (-e, in percent of scores)
+//     scored in a random item instead of the best one, so that the
+//     model also sees scorecards its own play wouldn't reach.
+//
+//     After the last round the model plays fresh games without random
+//     scores, and, given a solved table (-r, from yahtzee_evbench -w),
+//     the table plays the same games (the same seeds), to show how many
+//     points the model gives up for being a few KB instead of a few
+//     MB. The model can be saved (-w).
+//
+// Syntax: ./yahtzee_train [-t threads] [-n rounds] [-g games_per_round]
+//                         [-e explore_percent] [-l ridge] [-s seed]
+//                         [-v test_games] [-r table_file]
+//                         [-w model_file]
+// ----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "score.h"
+#include "rules.h"
+#include "game.h"
+#include "solver.h"
+#include "evtable.h"
+#include "learn.h"
+#include "timing.h"
+
+#define DEFAULT_ROUNDS  30
+#define DEFAULT_GAMES   3000
+#define DEFAULT_TESTS   20000
+#define DEFAULT_EXPLORE 5.0
+#define DEFAULT_RIDGE   1e-4
+#define DEFAULT_SEED    1
+#define MAX_THREADS     256
+#define PERCENT         100.0
+#define BASE_10         10
+#define NS_PER_SEC      1e9
+#define SPREAD_SEED     0x9E3779B97F4A7C15ULL   // Keeps random scores apart
+                                                // from the dice
+
+
+// **************************************************************************
+// ****************************  DEFINED TYPES   ****************************
+// **************************************************************************
+
+// One thread's share of a batch of games
+struct trainer_t {
+    pthread_t               thread;
+    const struct learn_t   *model;
+    const struct evtable_t *table;     // To play the same games, or NULL
+    struct learn_sums_t    *sums;      // To add the games to, or NULL
+    uint64_t                first_seed;
+    unsigned long           games;
+    double                  explore;   // Chance of a random score
+    double                  points;    // Total of the model's games
+    double                  lost;      // And of what it lost to the table
+    double                  lost_squares;
+};
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     next_random
+// Inputs
+//     x
+//         The generator (xorshift64), never 0.
+// Outputs
+//     function result
+// Description
+//     Returns the next 64 random bits.
+// ---------------------------------------------------------------------
+static uint64_t next_random(uint64_t *x)
+{
+    *x ^= *x << 13;
+    *x ^= *x >> 7;
+    *x ^= *x << 17;
+    return *x;
+}//end next_random
+
+
+// ---------------------------------------------------------------------
+// Function
+//     random_item
+// Inputs
+//     game
+//         A game after its last roll of a turn.
+//     x
+//         The generator.
+// Outputs
+//     function result
+// Description
+//     Returns an item the dice may be scored in, at random.
+// ---------------------------------------------------------------------
+static int random_item(const struct game_t *game, uint64_t *x)
+{
+    int allowed[NUMBER_OF_CATEGORIES];
+    int n = 0;
+
+    for (int item = ACES; item <= CHANCE; ++item) {
+        if (rules_allowed(game->dice, game->used, item)) {
+            allowed[n++] = item;
+        }
+    }
+
+    return allowed[next_random(x) % n];
+
+}//end random_item
+
+
+// ---------------------------------------------------------------------
+// Function
+//     play_model
+// Inputs
+//     t
+//         The thread's share, for the model, the sums and the chance
+//         of a random score.
+//     seed
+//         The seed for the dice.
+// Outputs
+//     function result
+// Description
+//     This function plays a game from the model, adds every turn's
+//     scorecard and what its turn is worth to the sums (if any), and
+//     returns the final total.
+// ---------------------------------------------------------------------
+static int play_model(struct trainer_t *t, const uint64_t seed)
+{
+    struct solver_turn_t turn = { .state = -1 };
+    struct game_t        game;
+    struct game_action_t action;
+    uint64_t             x = (seed * SPREAD_SEED) | 1;
+    int                  turns = 0;
+
+    game_new(&game, seed);
+    while (!game_over(&game)) {
+        action = learn_choose(t->model, &game, &turn);
+        if ((game.turn > turns) && (t->sums != NULL)) {
+            learn_add(t->sums, turn.state, turn.keep[0][0]);
+        }
+        turns = game.turn;
+        if ((action.type == GAME_SCORE) && (t->explore > 0) &&
+            ((next_random(&x) >> 11) * 0x1.0p-53 < t->explore)) {
+            action.arg = random_item(&game, &x);
+        }
+        game_step(&game, action, &game);
+    }
+
+    return game_total(&game);
+
+}//end play_model
+
+
+// ---------------------------------------------------------------------
+// Function
+//     play_table
+// Inputs
+//     table
+//         The solved table.
+//     seed
+//         The seed for the dice.
+// Outputs
+//     function result
+// Description
+//     This function plays a game from the table and returns the final
+//     total.
+// ---------------------------------------------------------------------
+static int play_table(const struct evtable_t *table, const uint64_t seed)
+{
+    struct solver_turn_t turn = { .state = -1 };
+    struct game_t        game;
+
+    game_new(&game, seed);
+    while (!game_over(&game)) {
+        game_step(&game, evtable_choose(table, &game, &turn), &game);
+    }
+
+    return game_total(&game);
+
+}//end play_table
+
+
+// ---------------------------------------------------------------------
+// Function
+//     play_loop
+// Inputs
+//     arg
+//         The thread's trainer_t.
+// Outputs
+//     function result
+// Description
+//     This is a thread: it plays its share of the games.
+// ---------------------------------------------------------------------
+static void *play_loop(void *arg)
+{
+    struct trainer_t *t = arg;
+    int               total;
+    double            lost;
+
+    for (unsigned long g = 0; g < t->games; ++g) {
+        total = play_model(t, t->first_seed + g);
+        t->points += total;
+        if (t->table != NULL) {
+            lost = play_table(t->table, t->first_seed + g) - total;
+            t->lost         += lost;
+            t->lost_squares += lost * lost;
+        }
+    }
+
+    return NULL;
+
+}//end play_loop
+
+
+// ---------------------------------------------------------------------
+// Function
+//     play_batch
+// Inputs
+//     trainers
+//         One per thread, with the model, sums, table and chance of a
+//         random score filled in.
+//     threads
+//         How many.
+//     games
+//         How many games to play in all.
+//     seed
+//         The seed of the first.
+// Outputs
+//     none
+// Description
+//     This function plays the games, split evenly over the threads.
+// ---------------------------------------------------------------------
+static void play_batch(struct trainer_t trainers[], const int threads,
+                       const unsigned long games, const uint64_t seed)
+{
+    uint64_t next_seed = seed;
+
+    for (int i = 0; i < threads; ++i) {
+        trainers[i].first_seed   = next_seed;
+        trainers[i].games        = games / threads +
+                                   ((unsigned long)i < games % threads);
+        trainers[i].points       = 0;
+        trainers[i].lost         = 0;
+        trainers[i].lost_squares = 0;
+        next_seed += trainers[i].games;
+        pthread_create(&trainers[i].thread, NULL, play_loop, &trainers[i]);
+    }
+    for (int i = 0; i < threads; ++i) {
+        pthread_join(trainers[i].thread, NULL);
+    }
+
+}//end play_batch
+
+
+// **************************************************************************
+// *********************************  MAIN **********************************
+// **************************************************************************
+int main(int argc, char *argv[])
+{
+    static struct trainer_t trainers[MAX_THREADS];
+    static struct learn_t   model;
+    const char             *read_path = NULL;
+    const char             *write_path = NULL;
+    struct evtable_t       *table = NULL;
+    struct learn_sums_t    *all;
+    struct timespec         start;
+    unsigned long           rounds = DEFAULT_ROUNDS;
+    unsigned long           games = DEFAULT_GAMES;
+    unsigned long           tests = DEFAULT_TESTS;
+    double                  explore = DEFAULT_EXPLORE;
+    double                  ridge = DEFAULT_RIDGE;
+    uint64_t                seed = DEFAULT_SEED;
+    long                    threads = sysconf(_SC_NPROCESSORS_ONLN);
+    double                  points;
+    double                  lost;
+    double                  lost_squares;
+    int                     opt;
+
+    while ((opt = getopt(argc, argv, "t:n:g:e:l:s:v:r:w:")) != -1) {
+        if (opt == 't') {
+            threads = atoi(optarg);
+        } else if (opt == 'n') {
+            rounds = strtoul(optarg, NULL, BASE_10);
+        } else if (opt == 'g') {
+            games = strtoul(optarg, NULL, BASE_10);
+        } else if (opt == 'e') {
+            explore = atof(optarg);
+        } else if (opt == 'l') {
+            ridge = atof(optarg);
+        } else if (opt == 's') {
+            seed = strtoull(optarg, NULL, BASE_10);
+        } else if (opt == 'v') {
+            tests = strtoul(optarg, NULL, BASE_10);
+        } else if (opt == 'r') {
+            read_path = optarg;
+        } else if (opt == 'w') {
+            write_path = optarg;
+        } else {
+            threads = 0;
+            break;
+        }
+    }
+    if ((threads < 1) || (threads > MAX_THREADS) || (games == 0) ||
+        (tests == 0) || !(ridge > 0) || (explore < 0) ||
+        (explore > PERCENT)) {
+        fprintf(stderr, "Syntax: %s [-t threads] [-n rounds] "
+                "[-g games_per_round] [-e explore_percent] [-l ridge] "
+                "[-s seed] [-v test_games] [-r table_file] "
+                "[-w model_file]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (read_path != NULL) {
+        table = evtable_load(read_path);
+        if (table == NULL) {
+            perror(read_path);
+            return EXIT_FAILURE;
+        }
+    }
+
+    all = malloc(sizeof(*all));
+    for (int i = 0; i < threads; ++i) {
+        trainers[i].model   = &model;
+        trainers[i].explore = explore / PERCENT;
+        trainers[i].sums    = malloc(sizeof(*trainers[i].sums));
+        if (trainers[i].sums == NULL) {
+            all = NULL;
+        }
+    }
+    if (all == NULL) {
+        perror("sums");
+        return EXIT_FAILURE;
+    }
+    printf("Model: %i features, %zu bytes\n", LEARN_FEATURES, sizeof(model));
+
+    // Play, fit, and play again from what was fitted
+    for (unsigned long round = 0; round < rounds; ++round) {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i = 0; i < threads; ++i) {
+            memset(trainers[i].sums, 0, sizeof(*trainers[i].sums));
+        }
+        play_batch(trainers, threads, games, seed + round * games);
+
+        memset(all, 0, sizeof(*all));
+        points = 0;
+        for (int i = 0; i < threads; ++i) {
+            learn_merge(all, trainers[i].sums);
+            points += trainers[i].points;
+        }
+        if (learn_fit(all, ridge, &model) != SUCCESS) {
+            fprintf(stderr, "Error: the fit failed\n");
+            return EXIT_FAILURE;
+        }
+        printf("Round %lu: %lu games averaging %.2f, fitted to %lu "
+               "scorecards (%.2f s); now %.2f expected from a fresh "
+               "game\n", round, games, points / games, all->samples,
+               timing_since(&start), learn_value(&model, 0));
+    }
+    if ((write_path != NULL) && (learn_save(&model, write_path) != SUCCESS)) {
+        perror(write_path);
+        return EXIT_FAILURE;
+    }
+
+    // Fresh games, with no random scores
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    free(all);
+    for (int i = 0; i < threads; ++i) {
+        free(trainers[i].sums);
+        trainers[i].sums    = NULL;
+        trainers[i].explore = 0;
+        trainers[i].table   = table;
+    }
+    play_batch(trainers, threads, tests, seed + rounds * games);
+    points       = 0;
+    lost         = 0;
+    lost_squares = 0;
+    for (int i = 0; i < threads; ++i) {
+        points       += trainers[i].points;
+        lost         += trainers[i].lost;
+        lost_squares += trainers[i].lost_squares;
+    }
+    printf("Test: %lu games averaging %.2f (%.2f s)\n", tests, points / tests,
+           timing_since(&start));
+    if (table != NULL) {
+        printf("The table averages %.2f on the same games: %.2f +/- %.2f "
+               "points lost per game (%zu KB of table, %zu bytes of "
+               "model)\n", (points + lost) / tests, lost / tests,
+               sqrt((lost_squares / tests - (lost / tests) * (lost / tests)) /
+                    tests), evtable_bytes(table) / 1024, sizeof(model));
+        evtable_free(table);
+    }
+    if (write_path != NULL) {
+        printf("Saved the model in %s\n", write_path);
+    }
+
+    return EXIT_SUCCESS;
+
+} // end main
+
+// end train.c
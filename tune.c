@@ -0,0 +1,222 @@
+// ----------------------------------------------------------------------
+// File: tune.c
+//
+// Name: Al Shaffer & Marshall Liu
+//
+// Description: This is a driver for the SENS module, for tuning house
+//     rules. It solves the game once, with the derivatives of the best
+//     expected score by each scoring constant, and reports them: how
+//     many points a game each point on a constant is worth, which is
+//     also how many times a game the best play scores it.
+//
+//     Each -c NAME=value (NAME as in score.h) asks what the expected
+//     score would be with that constant changed, to first order, all
+//     the changes together. It's exact as long as the change doesn't
+//     change the best play, so small changes are better than big ones.
+//
+//     With -g, games are played from the solved values to count how
+//     often each constant is really scored, as a check.
+//
+// Syntax: ./yahtzee_tune [-t threads] [-c NAME=value ...] [-g games]
+//                        [-s seed]
+// ----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include "score.h"
+#include "rules.h"
+#include "game.h"
+#include "solver.h"
+#include "sens.h"
+#include "timing.h"
+
+#define DEFAULT_SEED 1
+#define BASE_10      10
+#define NS_PER_SEC   1e9
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     parse_change
+// Inputs
+//     text
+//         NAME=value.
+//     change
+//         Where to add the change to the constant, by SENS_ constant.
+// Outputs
+//     function result
+// Description
+//     This function reads a change to a constant, returning false if
+//     it isn't one.
+// ---------------------------------------------------------------------
+static bool parse_change(const char *text, double change[])
+{
+    const char *equals = strchr(text, '=');
+    char       *end;
+    double      value;
+
+    if (equals == NULL) {
+        return false;
+    }
+    value = strtod(equals + 1, &end);
+    if ((end == equals + 1) || (*end != '\0')) {
+        return false;
+    }
+    for (int c = 0; c < SENS_CONSTANTS; ++c) {
+        if ((strlen(sens_name(c)) == (size_t)(equals - text)) &&
+            (strncmp(text, sens_name(c), equals - text) == 0)) {
+            change[c] = value - sens_constant(c);
+            return true;
+        }
+    }
+
+    return false;
+
+}//end parse_change
+
+
+// ---------------------------------------------------------------------
+// Function
+//     count_game
+// Inputs
+//     ev
+//         The solved values.
+//     seed
+//         The seed for the dice.
+//     counts
+//         Where to add how many times the game scored each constant.
+// Outputs
+//     function result
+// Description
+//     This function plays a game for the most points and returns its
+//     final total.
+// ---------------------------------------------------------------------
+static int count_game(const float ev[], const uint64_t seed, double counts[])
+{
+    struct solver_turn_t turn = { .state = -1 };
+    struct game_t        game;
+
+    game_new(&game, seed);
+    while (!game_over(&game)) {
+        game_step(&game, solver_choose(ev, &game, &turn), &game);
+    }
+
+    counts[SENS_FULL_HOUSE]    += game.score[FULL_HOUSE] == SCORE_FULL_HOUSE;
+    counts[SENS_STRAIGHT_SM]   += game.score[STRAIGHT_SM] == SCORE_STRAIGHT_SM;
+    counts[SENS_STRAIGHT_LG]   += game.score[STRAIGHT_LG] == SCORE_STRAIGHT_LG;
+    counts[SENS_YAHTZEE]       += game.score[YAHTZEE] == SCORE_YAHTZEE;
+    counts[SENS_YAHTZEE_BONUS] += game.bonus;
+    counts[SENS_BONUS]         += game_upper(&game) >= BONUS_THRESHOLD;
+
+    return game_total(&game);
+
+}//end count_game
+
+
+// **************************************************************************
+// *********************************  MAIN **********************************
+// **************************************************************************
+int main(int argc, char *argv[])
+{
+    double          change[SENS_CONSTANTS] = { 0 };
+    double          counts[SENS_CONSTANTS] = { 0 };
+    double          predicted;
+    double          points = 0;
+    bool            changed = false;
+    long            threads = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned long   games = 0;
+    uint64_t        seed = DEFAULT_SEED;
+    struct timespec start;
+    struct sens_t  *s;
+    const float    *d;
+    float          *ev;
+    int             opt;
+
+    while ((opt = getopt(argc, argv, "t:c:g:s:")) != -1) {
+        if (opt == 't') {
+            threads = atoi(optarg);
+        } else if ((opt == 'c') && parse_change(optarg, change)) {
+            changed = true;
+        } else if (opt == 'g') {
+            games = strtoul(optarg, NULL, BASE_10);
+        } else if (opt == 's') {
+            seed = strtoull(optarg, NULL, BASE_10);
+        } else {
+            threads = 0;
+            break;
+        }
+    }
+    if (threads < 1) {
+        fprintf(stderr, "Syntax: %s [-t threads] [-c NAME=value ...] "
+                "[-g games] [-s seed]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    s = sens_solve(threads);
+    if (s == NULL) {
+        perror("sens");
+        return EXIT_FAILURE;
+    }
+    d = s->at[0];
+    printf("Solved in %.2f s: %.3f expected from a fresh game\n\n",
+           timing_since(&start), d[0]);
+
+    printf("%-20s %6s %16s\n", "Constant", "Value", "Points/point");
+    for (int c = 0; c < SENS_CONSTANTS; ++c) {
+        printf("%-20s %6i %16.5f\n", sens_name(c), sens_constant(c),
+               d[1 + c]);
+    }
+
+    if (changed) {
+        predicted = d[0];
+        printf("\nWith");
+        for (int c = 0; c < SENS_CONSTANTS; ++c) {
+            if (change[c] != 0) {
+                printf(" %s=%g", sens_name(c), sens_constant(c) + change[c]);
+                predicted += change[c] * d[1 + c];
+            }
+        }
+        printf(": about %.3f expected (%+.3f)\n", predicted,
+               predicted - d[0]);
+    }
+
+    // Count what the best play really scores
+    if (games > 0) {
+        ev = solver_alloc(SOLVER_STATES * sizeof(float));
+        if (ev == NULL) {
+            perror("ev");
+            return EXIT_FAILURE;
+        }
+        for (int state = 0; state < SOLVER_STATES; ++state) {
+            ev[state] = s->at[state][0];
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (unsigned long g = 0; g < games; ++g) {
+            points += count_game(ev, seed + g, counts);
+        }
+        printf("\n%lu games averaging %.3f (%.2f s); scored per game:\n",
+               games, points / games, timing_since(&start));
+        for (int c = 0; c < SENS_CONSTANTS; ++c) {
+            printf("%-20s %10.5f\n", sens_name(c), counts[c] / games);
+        }
+        solver_free(ev);
+    }
+
+    sens_free(s);
+
+    return EXIT_SUCCESS;
+
+} // end main
+
+// end tune.c
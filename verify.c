@@ -0,0 +1,772 @@
+// ----------------------------------------------------------------------
+// File: verify.c
+//
+// Name: Al Shaffer & Marshall Liu
+//
+// Description: This is an exhaustive check that every fast way the
+//     programs score dice agrees with the rules. The reference here is
+//     the scoring in assign_score() as play.c first had it, restated on
+//     how many of each face the dice have: each straight is checked run
+//     by run (the first version's tests for 3-4-5-6 and for a large
+//     straight were wrong), and the Joker rule is written out from the
+//     rules, not from rules.c.
+//
+//     For every one of the 7776 rolls of the dice in order, it checks:
+//
+//         - rules_score() in every item, and rules_card_score(),
+//           rules_allowed() and rules_joker() with YAHTZEE open and
+//           used
+//         - the SOLVER module's tables for the roll: which roll it
+//           is, its dice, its score in every item, its Joker scores
+//           and whether it's a YAHTZEE
+//         - for all 32 masks of dice to keep, the keep solver_keep_of()
+//           finds, what the keep holds, the keeps one die bigger, that
+//           the keep is one of the roll's keeps, and the dice
+//           solver_keep_dice() keeps for it
+//
+//     and for each of the 252 rolls in sorted order, on all 8192
+//     scorecard masks (with YAHTZEE scored 50 and 0): rules_allowed()
+//     and rules_card_score(), and solver_items(), solver_item_score()
+//     and solver_yahtzee_bonus(), which take the Joker rule from the
+//     card. Last, the chance of each roll is checked against how many
+//     of the 7776 it came up as.
+//
+//     Rolls are handed out to the threads in chunks. The first
+//     mismatch, in the order the rolls are numbered, is reported, and
+//     the program exits with EXIT_FAILURE.
+//
+// Syntax: ./yahtzee_verify [-t threads]
+// ----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "score.h"
+#include "rules.h"
+#include "game.h"
+#include "solver.h"
+#include "timing.h"
+
+#define MAX_THREADS     64
+#define ROLLS_PER_CHUNK 16
+#define ROLLS           7776     // NUMBER_OF_SIDES ^ NUMBER_OF_DICE
+#define KEEP_MASKS      (1u << NUMBER_OF_DICE)
+#define MAX_TEXT        160
+#define NS_PER_SEC      1e9
+#define YAHTZEE_TEXT(fifty) ((fifty) ? "50" : "0 or open")
+
+_Static_assert(NUMBER_OF_DICE == 5 && NUMBER_OF_SIDES == 6,
+               "ROLLS assumes five six-sided dice");
+
+
+// **************************************************************************
+// ****************************  DEFINED TYPES   ****************************
+// **************************************************************************
+
+// One checking thread
+struct checker_t {
+    pthread_t    thread;
+    int          first;                 // Roll of the first mismatch,
+                                        // or ROLLS
+    char         text[MAX_TEXT];        // What it was
+    uint64_t     checks;
+    unsigned int ways[SOLVER_ROLLS];    // Rolls in order, by roll
+};
+
+
+// **************************************************************************
+// **************************** GLOBAL VARIABLES ****************************
+// **************************************************************************
+
+static int Next_roll;              // The next chunk to be claimed
+static int First_bad = ROLLS;      // The first mismatch any thread found
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     dice_of
+// Inputs
+//     index
+//         Which of the ROLLS rolls; the last die is the least
+//         significant.
+//     dice
+//         Where to put its dice.
+// Outputs
+//     function result
+// Description
+//     This function gets the roll's dice, and returns whether they're
+//     in sorted order.
+// ---------------------------------------------------------------------
+static bool dice_of(const int index, unsigned char dice[])
+{
+    bool sorted = true;
+
+    for (int i = NUMBER_OF_DICE - 1, n = index; i >= 0; --i) {
+        dice[i] = n % NUMBER_OF_SIDES + 1;
+        n /= NUMBER_OF_SIDES;
+    }
+    for (int i = 1; i < NUMBER_OF_DICE; ++i) {
+        sorted = sorted && (dice[i - 1] <= dice[i]);
+    }
+
+    return sorted;
+
+}//end dice_of
+
+
+// ---------------------------------------------------------------------
+// Function
+//     count_faces
+// Inputs
+//     dice
+//         The face values of all the dice.
+//     keep
+//         Which of them to count; bit 0 is the first die.
+//     counts
+//         Where to put how many of each face there are.
+// Outputs
+//     none
+// Description
+//     This function counts the faces of the dice.
+// ---------------------------------------------------------------------
+static void count_faces(const unsigned char dice[], const unsigned int keep,
+                        int counts[])
+{
+    memset(counts, 0, (NUMBER_OF_SIDES + 1) * sizeof(counts[0]));
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        if (keep & (1u << i)) {
+            ++counts[dice[i]];
+        }
+    }
+
+}//end count_faces
+
+
+// ---------------------------------------------------------------------
+// Function
+//     has_run
+// Inputs
+//     counts
+//         How many of each face there are.
+//     low
+//         The lowest face of the run.
+//     length
+//         How many faces long it is.
+// Outputs
+//     function result
+// Description
+//     Returns whether there's at least one of every face of the run.
+// ---------------------------------------------------------------------
+static bool has_run(const int counts[], const int low, const int length)
+{
+    for (int face = low; face < low + length; ++face) {
+        if (counts[face] == 0) {
+            return false;
+        }
+    }
+
+    return true;
+
+}//end has_run
+
+
+// ---------------------------------------------------------------------
+// Function
+//     ref_score
+// Inputs
+//     dice
+//         The face values of all the dice.
+//     item
+//         The line in the scorecard the dice would go on.
+// Outputs
+//     function result
+// Description
+//     This is the reference for rules_score(): what the dice are worth
+//     in the item, by the rules.
+// ---------------------------------------------------------------------
+static int ref_score(const unsigned char dice[], const int item)
+{
+    int  counts[NUMBER_OF_SIDES + 1];
+    int  total = 0;
+    int  most = 0;
+    bool pair = false;
+
+    count_faces(dice, KEEP_MASKS - 1, counts);
+    for (int face = ACES; face <= NUMBER_OF_SIDES; ++face) {
+        total += counts[face] * face;
+        most   = (counts[face] > most) ? counts[face] : most;
+        pair   = pair || (counts[face] == 2);
+    }
+
+    if ((item >= ACES) && (item <= SIXES)) {
+        return counts[item] * item;
+    } else if (item == KIND3) {
+        return (most >= 3) ? total : 0;
+    } else if (item == KIND4) {
+        return (most >= 4) ? total : 0;
+    } else if (item == FULL_HOUSE) {
+        return ((most == 3) && pair) ? SCORE_FULL_HOUSE : 0;
+    } else if (item == STRAIGHT_SM) {
+        return (has_run(counts, ACES, 4) || has_run(counts, TWOS, 4) ||
+                has_run(counts, THREES, 4)) ? SCORE_STRAIGHT_SM : 0;
+    } else if (item == STRAIGHT_LG) {
+        return (has_run(counts, ACES, 5) || has_run(counts, TWOS, 5)) ?
+               SCORE_STRAIGHT_LG : 0;
+    } else if (item == YAHTZEE) {
+        return (most == NUMBER_OF_DICE) ? SCORE_YAHTZEE : 0;
+    } else if (item == CHANCE) {
+        return total;
+    }
+
+    return 0;
+
+}//end ref_score
+
+
+// ---------------------------------------------------------------------
+// Function
+//     ref_joker
+// Inputs
+//     dice
+//         The face values of all the dice.
+//     used
+//         The items used (bit item).
+// Outputs
+//     function result
+// Description
+//     This is the reference for rules_joker(): a YAHTZEE with the
+//     YAHTZEE item used.
+// ---------------------------------------------------------------------
+static bool ref_joker(const unsigned char dice[], const unsigned int used)
+{
+    return (used & (1u << YAHTZEE)) && (ref_score(dice, YAHTZEE) > 0);
+}//end ref_joker
+
+
+// ---------------------------------------------------------------------
+// Function
+//     ref_allowed
+// Inputs
+//     dice
+//         The face values of all the dice.
+//     used
+//         The items used (bit item).
+//     item
+//         The line in the scorecard the dice would go on.
+// Outputs
+//     function result
+// Description
+//     This is the reference for rules_allowed(). An open item takes
+//     any dice, except a Joker: it has to go in the upper item of its
+//     face if that's open, and otherwise in the lower section if any
+//     of it is open.
+// ---------------------------------------------------------------------
+static bool ref_allowed(const unsigned char dice[], const unsigned int used,
+                        const int item)
+{
+    bool lower_open = false;
+
+    if ((item < ACES) || (item > CHANCE) || (used & (1u << item))) {
+        return false;
+    } else if (!ref_joker(dice, used)) {
+        return true;
+    } else if (!(used & (1u << dice[0]))) {
+        return item == dice[0];
+    }
+    for (int i = KIND3; i <= CHANCE; ++i) {
+        lower_open = lower_open || !(used & (1u << i));
+    }
+
+    return !lower_open || (item >= KIND3);
+
+}//end ref_allowed
+
+
+// ---------------------------------------------------------------------
+// Function
+//     ref_card_score
+// Inputs
+//     dice
+//         The face values of all the dice.
+//     used
+//         The items used (bit item).
+//     item
+//         The line in the scorecard the dice would go on.
+// Outputs
+//     function result
+// Description
+//     This is the reference for rules_card_score(): a Joker scores a
+//     full house and the straights in full.
+// ---------------------------------------------------------------------
+static int ref_card_score(const unsigned char dice[], const unsigned int used,
+                          const int item)
+{
+    if (ref_joker(dice, used) && (item == FULL_HOUSE)) {
+        return SCORE_FULL_HOUSE;
+    } else if (ref_joker(dice, used) && (item == STRAIGHT_SM)) {
+        return SCORE_STRAIGHT_SM;
+    } else if (ref_joker(dice, used) && (item == STRAIGHT_LG)) {
+        return SCORE_STRAIGHT_LG;
+    }
+
+    return ref_score(dice, item);
+
+}//end ref_card_score
+
+
+// ---------------------------------------------------------------------
+// Function
+//     ref_keep_dice
+// Inputs
+//     dice
+//         The face values of all the dice.
+//     counts
+//         How many of each face to keep.
+// Outputs
+//     function result
+// Description
+//     This is the reference for solver_keep_dice(): the first dice of
+//     each face, as many as the counts say.
+// ---------------------------------------------------------------------
+static unsigned int ref_keep_dice(const unsigned char dice[],
+                                  const int counts[])
+{
+    int          left[NUMBER_OF_SIDES + 1];
+    unsigned int keep = 0;
+
+    memcpy(left, counts, sizeof(left));
+    for (int i = 0; i < NUMBER_OF_DICE; ++i) {
+        if (left[dice[i]] > 0) {
+            --left[dice[i]];
+            keep |= 1u << i;
+        }
+    }
+
+    return keep;
+
+}//end ref_keep_dice
+
+
+// ---------------------------------------------------------------------
+// Function
+//     same_counts
+// Inputs
+//     d
+//         The solver's tables.
+//     keep
+//         One of the SOLVER_KEEPS keeps.
+//     counts
+//         How many of each face there should be.
+// Outputs
+//     function result
+// Description
+//     Returns whether the keep holds those dice, and that many.
+// ---------------------------------------------------------------------
+static bool same_counts(const struct solver_dice_t *d, const int keep,
+                        const int counts[])
+{
+    int size = 0;
+
+    if ((keep < 0) || (keep >= SOLVER_KEEPS)) {
+        return false;
+    }
+    for (int face = ACES; face <= NUMBER_OF_SIDES; ++face) {
+        if (d->keep_counts[keep][face] != counts[face]) {
+            return false;
+        }
+        size += counts[face];
+    }
+
+    return d->keep_size[keep] == size;
+
+}//end same_counts
+
+
+// ---------------------------------------------------------------------
+// Function
+//     agree
+// Inputs
+//     c
+//         The thread checking.
+//     index
+//         The roll being checked, 0 thru ROLLS - 1.
+//     kernel
+//         What's being checked.
+//     dice
+//         The dice.
+//     got
+//         What it said.
+//     expected
+//         What the reference says.
+//     what
+//         A printf() format for anything else it was given, and its
+//         arguments.
+// Outputs
+//     function result
+// Description
+//     This function counts a check, and returns whether it passed. The
+//     first mismatch of the earliest roll is kept, for the report; it's
+//     only put into words then, since almost every check passes.
+// ---------------------------------------------------------------------
+static bool agree(struct checker_t *c, const int index, const char *kernel,
+                  const unsigned char dice[], const long got,
+                  const long expected, const char *what, ...)
+{
+    va_list args;
+    int     used;
+    int     first;
+
+    ++c->checks;
+    if (got == expected) {
+        return true;
+    } else if (index >= c->first) {
+        return false;
+    }
+
+    c->first = index;
+    used = snprintf(c->text, sizeof(c->text), "%s on dice %i %i %i %i %i",
+                    kernel, dice[0], dice[1], dice[2], dice[3], dice[4]);
+    va_start(args, what);
+    used += vsnprintf(c->text + used, sizeof(c->text) - used, what, args);
+    va_end(args);
+    snprintf(c->text + used, sizeof(c->text) - used,
+             " gave %li, the reference says %li", got, expected);
+    first = __atomic_load_n(&First_bad, __ATOMIC_RELAXED);
+    while ((index < first) &&
+           !__atomic_compare_exchange_n(&First_bad, &first, index, false,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        ;
+    }
+
+    return false;
+
+}//end agree
+
+
+// ---------------------------------------------------------------------
+// Function
+//     check_roll
+// Inputs
+//     c
+//         The thread checking.
+//     index
+//         Which of the ROLLS rolls it is.
+//     dice
+//         Its dice.
+// Outputs
+//     none
+// Description
+//     This function checks everything about one roll of the dice in
+//     order: its scores, its roll in the solver's tables, and every
+//     keep of it.
+// ---------------------------------------------------------------------
+static void check_roll(struct checker_t *c, const int index,
+                       const unsigned char dice[])
+{
+    const struct solver_dice_t *d = solver_dice();
+    unsigned char               sorted[NUMBER_OF_DICE];
+    int                         counts[NUMBER_OF_SIDES + 1];
+    unsigned int                used;
+    bool                        found;
+    int                         keep;
+    int                         child;
+    int                         r;
+
+    count_faces(dice, KEEP_MASKS - 1, counts);
+    for (int face = ACES, i = 0; face <= NUMBER_OF_SIDES; ++face) {
+        for (int k = 0; k < counts[face]; ++k) {
+            sorted[i++] = face;
+        }
+    }
+
+    // The rules, with YAHTZEE open and used
+    for (int item = 0; item <= CHANCE + 1; ++item) {
+        agree(c, index, "rules_score", dice, rules_score(dice, item),
+              ref_score(dice, item), ", item %i", item);
+    }
+    for (used = 0; used <= (1u << YAHTZEE); used += (1u << YAHTZEE)) {
+        agree(c, index, "rules_joker", dice, rules_joker(dice, used),
+              ref_joker(dice, used), ", used %#x", used);
+        for (int item = ACES; item <= CHANCE; ++item) {
+            agree(c, index, "rules_allowed", dice,
+                  rules_allowed(dice, used, item),
+                  ref_allowed(dice, used, item), ", used %#x, item %i", used,
+                  item);
+            agree(c, index, "rules_card_score", dice,
+                  rules_card_score(dice, used, item),
+                  ref_card_score(dice, used, item), ", used %#x, item %i",
+                  used, item);
+        }
+    }
+
+    // The roll in the solver's tables
+    r = solver_roll_of(dice);
+    if (!agree(c, index, "solver_roll_of", dice,
+               (r >= 0) && (r < SOLVER_ROLLS), true, " (in range)")) {
+        return;
+    }
+    ++c->ways[r];
+    agree(c, index, "solver_roll_of", dice,
+          memcmp(d->roll_dice[r], sorted, sizeof(sorted)) == 0, true,
+          " (its dice)");
+    agree(c, index, "roll_yahtzee", dice, d->roll_yahtzee[r],
+          ref_joker(dice, 1u << YAHTZEE), "");
+    for (int item = ACES; item <= CHANCE; ++item) {
+        agree(c, index, "roll_score", dice, d->roll_score[r][item],
+              ref_score(dice, item), ", item %i", item);
+        agree(c, index, "roll_joker", dice, d->roll_joker[r][item],
+              ref_card_score(dice, 1u << YAHTZEE, item), ", item %i", item);
+    }
+
+    // Every keep of the roll
+    for (unsigned int mask = 0; mask < KEEP_MASKS; ++mask) {
+        count_faces(dice, mask, counts);
+        keep = solver_keep_of(dice, mask);
+        if (!agree(c, index, "solver_keep_of", dice,
+                   same_counts(d, keep, counts), true, ", keep %#x", mask)) {
+            continue;
+        }
+        found = false;
+        for (int s = d->sub_start[r]; s < d->sub_start[r + 1]; ++s) {
+            found = found || (d->subs[s] == keep);
+        }
+        agree(c, index, "subs", dice, found, true, ", keep %#x", mask);
+        agree(c, index, "solver_keep_dice", dice,
+              solver_keep_dice(dice, keep), ref_keep_dice(dice, counts),
+              ", keep %#x", mask);
+        for (int face = ACES; (face <= NUMBER_OF_SIDES) &&
+                              (d->keep_size[keep] < NUMBER_OF_DICE); ++face) {
+            ++counts[face];
+            child = d->keep_child[keep][face - 1];
+            agree(c, index, "keep_child", dice, same_counts(d, child, counts),
+                  true, ", keep %#x plus a %i", mask, face);
+            --counts[face];
+        }
+    }
+
+}//end check_roll
+
+
+// ---------------------------------------------------------------------
+// Function
+//     check_cards
+// Inputs
+//     c
+//         The thread checking.
+//     index
+//         Which of the ROLLS rolls it is.
+//     dice
+//         Its dice, in sorted order.
+// Outputs
+//     none
+// Description
+//     This function checks the roll's keeps, and how it scores on every
+//     scorecard, which is where the Joker rule comes in.
+// ---------------------------------------------------------------------
+static void check_cards(struct checker_t *c, const int index,
+                        const unsigned char dice[])
+{
+    const struct solver_dice_t *d = solver_dice();
+    int                         r = solver_roll_of(dice);
+    int                         counts[NUMBER_OF_SIDES + 1];
+    int                         subs = 1;
+    unsigned int                used;
+    unsigned int                items;
+    unsigned int                card;
+    bool                        subset;
+    int                         state;
+    int                         item;
+
+    // The roll's keeps are its subsets, each once
+    count_faces(dice, KEEP_MASKS - 1, counts);
+    for (int face = ACES; face <= NUMBER_OF_SIDES; ++face) {
+        subs *= counts[face] + 1;
+    }
+    agree(c, index, "sub_start", dice, d->sub_start[r + 1] - d->sub_start[r],
+          subs, "");
+    for (int s = d->sub_start[r]; s < d->sub_start[r + 1]; ++s) {
+        subset = true;
+        for (int face = ACES; face <= NUMBER_OF_SIDES; ++face) {
+            subset = subset && (d->keep_counts[d->subs[s]][face] <=
+                                counts[face]);
+        }
+        agree(c, index, "subs", dice, subset, true, ", keep %i", d->subs[s]);
+    }
+
+    for (unsigned int mask = 0; mask < SOLVER_MASKS; ++mask) {
+        used = mask << 1;
+        for (int item = ACES; item <= CHANCE; ++item) {
+            agree(c, index, "rules_allowed", dice,
+                  rules_allowed(dice, used, item),
+                  ref_allowed(dice, used, item), ", used %#x, item %i", used,
+                  item);
+            if (ref_allowed(dice, used, item)) {
+                agree(c, index, "rules_card_score", dice,
+                      rules_card_score(dice, used, item),
+                      ref_card_score(dice, used, item), ", used %#x, item %i",
+                      used, item);
+            }
+        }
+
+        for (int fifty = 0; fifty <= ((mask & SOLVER_YAHTZEE_BIT) != 0);
+             ++fifty) {
+            card  = solver_card(mask, fifty);
+            state = solver_state(card, 0);
+            agree(c, index, "solver_card_mask", dice, solver_card_mask(card),
+                  mask, ", used %#x, YAHTZEE %s", used, YAHTZEE_TEXT(fifty));
+            agree(c, index, "solver_yahtzee_bonus", dice,
+                  solver_yahtzee_bonus(state, r),
+                  (fifty && ref_joker(dice, used)) ? SCORE_YAHTZEE_BONUS : 0,
+                  ", used %#x, YAHTZEE %s", used, YAHTZEE_TEXT(fifty));
+
+            items = 0;
+            for (int item = ACES; item <= CHANCE; ++item) {
+                items |= ref_allowed(dice, used, item) << (item - ACES);
+            }
+            agree(c, index, "solver_items", dice, solver_items(state, r),
+                  items, ", used %#x, YAHTZEE %s", used, YAHTZEE_TEXT(fifty));
+            for (; items != 0; items &= items - 1) {
+                item = __builtin_ctz(items) + ACES;
+                agree(c, index, "solver_item_score", dice,
+                      solver_item_score(state, r, item),
+                      ref_card_score(dice, used, item),
+                      ", used %#x, YAHTZEE %s, item %i", used,
+                      YAHTZEE_TEXT(fifty), item);
+            }
+        }
+    }
+
+}//end check_cards
+
+
+// ---------------------------------------------------------------------
+// Function
+//     check_loop
+// Inputs
+//     arg
+//         The checker_t for this thread.
+// Outputs
+//     function result
+// Description
+//     This is a checking thread. It claims chunks of rolls until there
+//     are none left, or a mismatch has been found before them.
+// ---------------------------------------------------------------------
+static void *check_loop(void *arg)
+{
+    struct checker_t *c = arg;
+    unsigned char     dice[NUMBER_OF_DICE];
+    bool              sorted;
+    int               first;
+    int               last;
+
+    for (;;) {
+        first = __atomic_fetch_add(&Next_roll, ROLLS_PER_CHUNK,
+                                   __ATOMIC_RELAXED);
+        if ((first >= ROLLS) ||
+            (first > __atomic_load_n(&First_bad, __ATOMIC_RELAXED))) {
+            break;
+        }
+        last = (first + ROLLS_PER_CHUNK < ROLLS) ? first + ROLLS_PER_CHUNK
+                                                 : ROLLS;
+
+        // A roll in sorted order stands for all its orders on the
+        // scorecards
+        for (int index = first; index < last; ++index) {
+            sorted = dice_of(index, dice);
+            check_roll(c, index, dice);
+            if (sorted) {
+                check_cards(c, index, dice);
+            }
+        }
+    }
+
+    return NULL;
+
+}//end check_loop
+
+
+// **************************************************************************
+// *********************************  MAIN **********************************
+// **************************************************************************
+int main(int argc, char *argv[])
+{
+    static struct checker_t     checkers[MAX_THREADS];
+    const struct solver_dice_t *d;
+    struct checker_t           *worst;
+    struct timespec             start;
+    long                        threads = sysconf(_SC_NPROCESSORS_ONLN);
+    uint64_t                    checks = 0;
+    unsigned int                ways;
+    int                         opt;
+
+    while ((opt = getopt(argc, argv, "t:")) != -1) {
+        if (opt == 't') {
+            threads = atoi(optarg);
+        } else {
+            threads = 0;
+            break;
+        }
+    }
+    if ((threads < 1) || (optind < argc)) {
+        fprintf(stderr, "Syntax: %s [-t threads]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    threads = (threads > MAX_THREADS) ? MAX_THREADS : threads;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    d = solver_dice();
+    for (int i = 0; i < threads; ++i) {
+        checkers[i].first = ROLLS;
+        pthread_create(&checkers[i].thread, NULL, check_loop, &checkers[i]);
+    }
+    worst = &checkers[0];
+    for (int i = 0; i < threads; ++i) {
+        pthread_join(checkers[i].thread, NULL);
+        checks += checkers[i].checks;
+        if (checkers[i].first < worst->first) {
+            worst = &checkers[i];
+        }
+    }
+
+    if (worst->first < ROLLS) {
+        printf("FAIL after %llu checks: %s\n", (unsigned long long)checks,
+               worst->text);
+        return EXIT_FAILURE;
+    }
+
+    // Each roll's chance, from how many of the rolls in order it is
+    for (int r = 0; r < SOLVER_ROLLS; ++r) {
+        ways = 0;
+        for (int i = 0; i < threads; ++i) {
+            ways += checkers[i].ways[r];
+        }
+        ++checks;
+        if (d->roll_chance[r] != ways / (float)ROLLS) {
+            printf("FAIL: roll_chance of dice %i %i %i %i %i is %g, the "
+                   "reference says %u/%i\n", d->roll_dice[r][0],
+                   d->roll_dice[r][1], d->roll_dice[r][2], d->roll_dice[r][3],
+                   d->roll_dice[r][4], d->roll_chance[r], ways, ROLLS);
+            return EXIT_FAILURE;
+        }
+    }
+
+    printf("ok: %llu checks of %i rolls, %u keeps of each and %u scorecards "
+           "for each of %i sorted rolls agree (%li thread(s), %.2f s)\n",
+           (unsigned long long)checks, ROLLS, KEEP_MASKS, SOLVER_MASKS,
+           SOLVER_ROLLS, threads, timing_since(&start));
+
+    return EXIT_SUCCESS;
+
+} // end main
+
+// end verify.c
@@ -0,0 +1,488 @@
+// ----------------------------------------------------------------------
+// File: winprob.c
+//
+// Name: Al Shaffer & Marshall Liu
+//
+// Description: This WINPROB module works out how to play to beat one
+//     opponent, which isn't the same as playing for the most points:
+//     a player who's behind late in a game should take chances that
+//     don't pay on average, and one who's ahead shouldn't.
+//
+//     The opponent is summed up by the chances of each final total
+//     they might get. Then the chance of winning only depends on one
+//     player's scorecard (as in the SOLVER module) and their total so
+//     far, so the two players' games don't have to be solved together.
+//     A tie counts as half a win.
+//
+//     Every scorecard gets a chance of winning for each total, which
+//     is worked out a whole row of totals at a time with the SOLVER
+//     module's turn pieces. Totals from which a win (or a loss) is
+//     already certain aren't stored, which leaves a fairly narrow band
+//     for each scorecard, and the chances are stored in 16 bits. Only
+//     the scorecards that can follow the one being solved from are
+//     solved.
+// ----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "score.h"
+#include "rules.h"
+#include "game.h"
+#include "solver.h"
+#include "winprob.h"
+
+#define FULL_MASK (SOLVER_MASKS - 1)
+#define SCORES    (SCORE_YAHTZEE + 1)   // Any item's score is less
+
+
+// **************************************************************************
+// *************************** INTERNAL FUNCTIONS ***************************
+// **************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     chance_at
+// Inputs
+//     w
+//         The solved chances.
+//     state
+//         A scorecard at the start of a turn.
+//     total
+//         The total so far.
+// Outputs
+//     function result
+// Description
+//     Returns the chance of winning from there.
+// ---------------------------------------------------------------------
+static inline float chance_at(const struct winprob_t *w, const int state,
+                              const int total)
+{
+    unsigned int card = state / SOLVER_UPPER;
+
+    if (total > w->highest) {
+        return 1.0f;
+    } else if (solver_card_mask(card) == FULL_MASK) {
+        return w->win[total];
+    } else if ((total < w->first[card]) || (total > w->last[card])) {
+        return 0.0f;
+    }
+
+    return w->chance[w->offset[state] + (total - w->first[card])] *
+           (1.0f / WINPROB_ONE);
+
+}//end chance_at
+
+
+// ---------------------------------------------------------------------
+// Function
+//     plan
+// Inputs
+//     w
+//         The chances to be solved, with the opponent filled in.
+// Outputs
+//     function result
+// Description
+//     This function works out which totals need storing for each
+//     scorecard, and where. It returns false if there's no memory.
+// ---------------------------------------------------------------------
+static bool plan(struct winprob_t *w)
+{
+    const struct solver_dice_t *d = solver_dice();
+    int          best[NUMBER_OF_CATEGORIES + 1] = { 0 };
+    int          most;
+    int          rest;
+    int          upper_most;
+    int          open;
+    int          state;
+    unsigned int card;
+    unsigned int mask;
+
+    for (int r = 0; r < SOLVER_ROLLS; ++r) {
+        for (int item = ACES; item <= CHANCE; ++item) {
+            if (d->roll_score[r][item] > best[item]) {
+                best[item] = d->roll_score[r][item];
+            }
+        }
+    }
+
+    w->offset = solver_alloc(SOLVER_STATES * sizeof(*w->offset));
+    if (w->offset == NULL) {
+        return false;
+    }
+    w->stored = 0;
+    for (card = 0; card < SOLVER_CARDS; ++card) {
+        // The most that could've been scored so far, and that's left
+        mask = solver_card_mask(card);
+        most = 0;
+        rest = 0;
+        upper_most = 0;
+        open = 0;
+        for (int item = ACES; item <= CHANCE; ++item) {
+            if (mask & (1u << (item - ACES))) {
+                most += best[item];
+                upper_most += (item <= SIXES) ? best[item] : 0;
+            } else {
+                rest += best[item];
+                ++open;
+            }
+        }
+        most += (upper_most >= BONUS_THRESHOLD) ? SCORE_BONUS : 0;
+        rest += ((mask & SOLVER_UPPER_BITS) != SOLVER_UPPER_BITS) ?
+                SCORE_BONUS : 0;
+
+        // And a YAHTZEE bonus every turn after YAHTZEE scored 50
+        if (card >= SOLVER_MASKS) {
+            most += (NUMBER_OF_CATEGORIES - open - 1) * SCORE_YAHTZEE_BONUS;
+            rest += open * SCORE_YAHTZEE_BONUS;
+        } else if (!(mask & SOLVER_YAHTZEE_BIT)) {
+            rest += (open - 1) * SCORE_YAHTZEE_BONUS;
+        }
+
+        w->first[card] = (w->lowest - rest > 0) ? w->lowest - rest : 0;
+        w->last[card]  = (most < w->highest) ? most : w->highest;
+
+        for (int u = 0; u < SOLVER_UPPER; ++u) {
+            state = card * SOLVER_UPPER + u;
+            w->offset[state] = WINPROB_NONE;
+            if (((mask & w->start) == w->start) && (mask != FULL_MASK) &&
+                solver_reachable(mask, u) &&
+                (solver_state(card, u) == state) &&
+                (w->first[card] <= w->last[card])) {
+                w->offset[state] = w->stored;
+                w->stored += w->last[card] - w->first[card] + 1;
+            }
+        }
+    }
+
+    w->chance = solver_alloc(w->stored * sizeof(*w->chance));
+    return (w->chance != NULL);
+
+}//end plan
+
+
+// ---------------------------------------------------------------------
+// Function
+//     solve_mask
+// Inputs
+//     mask
+//         The items used.
+//     context
+//         The chances being solved.
+//     scratch
+//         Room for a row of totals for every roll and keep, and for
+//         every item and score.
+// Outputs
+//     none
+// Description
+//     This function solves every stored scorecard with these items
+//     used, for all its totals at once, for solver_by_layer().
+//
+//     Many rolls score the same in an item, so the row of chances
+//     after scoring is looked up once for each item and score, and
+//     then each roll just takes the best of its items' rows. The
+//     few rolls that earn a YAHTZEE bonus are looked up on their own.
+// ---------------------------------------------------------------------
+static void solve_mask(const unsigned int mask, void *context, void *scratch)
+{
+    struct winprob_t *w = context;
+    float            *rolls = scratch;
+    float            *keeps;
+    float            *scored;
+    float            *after[NUMBER_OF_CATEGORIES + 1][SCORES];
+    float            *row;
+    const float      *from;
+    unsigned int      card;
+    unsigned int      items;
+    int               width;
+    int               state;
+    int               item;
+    int               next;
+    int               shift;
+    int               score;
+    int               bonus;
+    int               used;
+    uint16_t         *out;
+
+    for (int fifty = 0; fifty <= ((mask & SOLVER_YAHTZEE_BIT) != 0);
+         ++fifty) {
+        card   = solver_card(mask, fifty);
+        width  = w->last[card] - w->first[card] + 1;
+        keeps  = rolls + SOLVER_ROLLS * width;
+        scored = keeps + SOLVER_KEEPS * width;
+        for (int u = 0; u < SOLVER_UPPER; ++u) {
+            state = card * SOLVER_UPPER + u;
+            if (w->offset[state] == WINPROB_NONE) {
+                continue;
+            }
+            memset(after, 0, sizeof(after));
+            used = 0;
+
+            // After the last roll, each total moves up by what's scored
+            for (int r = 0; r < SOLVER_ROLLS; ++r) {
+                row = rolls + r * width;
+                memset(row, 0, width * sizeof(float));
+                bonus = solver_yahtzee_bonus(state, r);
+                for (items = solver_items(state, r); items != 0;
+                     items &= items - 1) {
+                    item  = __builtin_ctz(items) + ACES;
+                    score = solver_item_score(state, r, item);
+                    shift = w->first[card] + score + bonus +
+                            solver_bonus_after(u, item, score);
+                    next  = solver_state(solver_card_after(card, item, score),
+                                         solver_upper_after(u, item, score));
+                    if (bonus > 0) {
+                        for (int j = 0; j < width; ++j) {
+                            row[j] = fmaxf(row[j], chance_at(w, next,
+                                                             shift + j));
+                        }
+                        continue;
+                    }
+                    if (after[item][score] == NULL) {
+                        after[item][score] = scored + used++ * width;
+                        for (int j = 0; j < width; ++j) {
+                            after[item][score][j] = chance_at(w, next,
+                                                              shift + j);
+                        }
+                    }
+                    from = after[item][score];
+                    for (int j = 0; j < width; ++j) {
+                        row[j] = (from[j] > row[j]) ? from[j] : row[j];
+                    }
+                }
+            }
+
+            // Back through the turn, a row at a time
+            solver_expect(rolls, keeps, width);
+            solver_best(keeps, rolls, width);
+            solver_expect(rolls, keeps, width);
+            solver_best(keeps, rolls, width);
+            solver_expect(rolls, keeps, width);
+
+            out = w->chance + w->offset[state];
+            for (int j = 0; j < width; ++j) {
+                out[j] = (uint16_t)(keeps[j] * WINPROB_ONE + 0.5f);
+            }
+        }
+    }
+
+}//end solve_mask
+
+
+// ---------------------------------------------------------------------
+// Function
+//     after_score
+// Inputs
+//     w
+//         The solved chances.
+//     state
+//         The scorecard.
+//     total
+//         The total so far.
+//     r
+//         The roll being scored.
+//     item
+//         Where it's scored, one the Joker rule allows.
+// Outputs
+//     function result
+// Description
+//     Returns the chance of winning after scoring the roll there.
+// ---------------------------------------------------------------------
+static float after_score(const struct winprob_t *w, const int state,
+                         const int total, const int r, const int item)
+{
+    unsigned int card = state / SOLVER_UPPER;
+    int          upper = state % SOLVER_UPPER;
+    int          score = solver_item_score(state, r, item);
+
+    return chance_at(w, solver_state(solver_card_after(card, item, score),
+                                     solver_upper_after(upper, item, score)),
+                     total + score + solver_yahtzee_bonus(state, r) +
+                     solver_bonus_after(upper, item, score));
+
+}//end after_score
+
+
+// ************************************************************************
+// *************************  EXTERNAL FUNCTIONS **************************
+// ************************************************************************
+
+// ---------------------------------------------------------------------
+// Function
+//     winprob_solve
+// Inputs
+//     opponent
+//         The chance of the opponent finishing with each total,
+//         0 thru WINPROB_MAX_TOTAL. It needn't add up to exactly 1.
+//     start
+//         The items the player has used (bit item - 1). Only the
+//         scorecards that can follow are solved.
+//     threads
+//         How many threads to use.
+// Outputs
+//     function result
+// Description
+//     This function solves for the chance of winning, and returns it
+//     to be freed by winprob_free(), or NULL if there's no memory.
+// ---------------------------------------------------------------------
+struct winprob_t *winprob_solve(const double opponent[],
+                                const unsigned int start, const int threads)
+{
+    struct winprob_t *w = calloc(1, sizeof(*w));
+    double            sum = 0;
+    double            below = 0;
+
+    if (w == NULL) {
+        return NULL;
+    }
+    w->start   = start;
+    w->lowest  = -1;
+    w->highest = 0;
+    for (int t = 0; t < WINPROB_TOTALS; ++t) {
+        sum += opponent[t];
+        if (opponent[t] > 0) {
+            w->lowest  = (w->lowest < 0) ? t : w->lowest;
+            w->highest = t;
+        }
+    }
+    if (w->lowest < 0) {
+        w->lowest = 0;
+        sum = 1;
+    }
+    for (int t = 0; t < WINPROB_TOTALS; ++t) {
+        w->win[t] = (below + opponent[t] / 2) / sum;
+        below += opponent[t];
+    }
+
+    if (!plan(w) ||
+        (solver_by_layer(threads, solve_mask, w,
+                         (SOLVER_ROLLS + SOLVER_KEEPS +
+                          NUMBER_OF_CATEGORIES * SCORES) * WINPROB_TOTALS *
+                         sizeof(float)) != SUCCESS)) {
+        winprob_free(w);
+        return NULL;
+    }
+
+    return w;
+
+}//end winprob_solve
+
+
+// ---------------------------------------------------------------------
+// Function
+//     winprob_free
+// Inputs
+//     w
+//         Chances from winprob_solve().
+// Outputs
+//     none
+// Description
+//     This function frees the chances.
+// ---------------------------------------------------------------------
+void winprob_free(struct winprob_t *w)
+{
+    solver_free(w->offset);
+    solver_free(w->chance);
+    free(w);
+}//end winprob_free
+
+
+// ---------------------------------------------------------------------
+// Function
+//     winprob_value
+// Inputs
+//     w
+//         The solved chances.
+//     state
+//         A scorecard that follows the one solved from, at the start
+//         of a turn.
+//     total
+//         The total so far, bonus included.
+// Outputs
+//     function result
+// Description
+//     Returns the chance of winning from there, with the best play.
+// ---------------------------------------------------------------------
+double winprob_value(const struct winprob_t *w, const int state,
+                     const int total)
+{
+    return chance_at(w, state, total);
+}//end winprob_value
+
+
+// ---------------------------------------------------------------------
+// Function
+//     winprob_choose
+// Inputs
+//     w
+//         The solved chances.
+//     game
+//         A game that isn't over, whose scorecard follows the one
+//         solved from.
+//     total
+//         The game's total so far, bonus included.
+//     turn
+//         The values for the turn, if they're for this scorecard and
+//         total; otherwise they're worked out and kept here for the
+//         next call.
+// Outputs
+//     function result
+// Description
+//     Returns the best thing to do next for the best chance of winning.
+//     Of items that give the same chance, the one that scores the most
+//     is chosen.
+// ---------------------------------------------------------------------
+struct game_action_t winprob_choose(const struct winprob_t *w,
+                                    const struct game_t *game,
+                                    const int total,
+                                    struct solver_turn_t *turn)
+{
+    struct game_action_t action = { GAME_SCORE, 0 };
+    int                  state = solver_state_of(game);
+    int                  key = state * WINPROB_TOTALS + total;
+    int                  r = solver_roll_of(game->dice);
+    unsigned int         items;
+    int                  item;
+    float                value;
+    float                best = -1;
+    float                chance;
+
+    if (turn->state != key) {
+        for (int roll = 0; roll < SOLVER_ROLLS; ++roll) {
+            best = 0;
+            for (items = solver_items(state, roll); items != 0;
+                 items &= items - 1) {
+                value = after_score(w, state, total, roll,
+                                    __builtin_ctz(items) + ACES);
+                best = (value > best) ? value : best;
+            }
+            turn->roll[MAX_ROLLS - 1][roll] = best;
+        }
+        solver_turn_back(turn);
+        turn->state = key;
+    }
+    if (solver_keep_action(game, solver_best_keep(turn, game), &action)) {
+        return action;
+    }
+
+    best = -1;
+    for (items = solver_items(state, r); items != 0; items &= items - 1) {
+        item   = __builtin_ctz(items) + ACES;
+        chance = after_score(w, state, total, r, item);
+        if ((chance > best) ||
+            ((chance == best) &&
+             (solver_item_score(state, r, item) >
+              solver_item_score(state, r, action.arg)))) {
+            best = chance;
+            action.arg = item;
+        }
+    }
+
+    return action;
+
+}//end winprob_choose
+
+// end winprob.c
@@ -0,0 +1,52 @@
+// -------------------------------------------------------------------
+// File: winprob.h
+//
+// Name: Marshall Liu
+//
+// Description: This is the header file for the WINPROB module, which
+//     works out how to play to beat one opponent rather than for the
+//     most points.
+// -------------------------------------------------------------------
+
+#ifndef WINPROB_H
+#define WINPROB_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "game.h"
+#include "solver.h"
+
+#define WINPROB_MAX_TOTAL 1575     // Every item at its best, the bonus,
+                                   // and 12 YAHTZEE bonuses
+#define WINPROB_TOTALS    (WINPROB_MAX_TOTAL + 1)
+#define WINPROB_ONE       65535    // A stored chance of 1
+#define WINPROB_NONE      UINT32_MAX
+
+// The chance of winning from every scorecard and total that can come
+// after the one it was solved from. Chances are stored as 16-bit
+// fractions of WINPROB_ONE, only for the totals where they aren't
+// certain.
+struct winprob_t {
+    double    win[WINPROB_TOTALS];     // Chance of winning, finishing here
+    int       lowest;                  // The opponent's lowest finish
+    int       highest;                 // And highest
+    unsigned int start;                // The mask it was solved from
+    short     first[SOLVER_CARDS];     // Lowest total stored, by card
+    short     last[SOLVER_CARDS];      // Highest
+    uint32_t *offset;                  // By state; WINPROB_NONE if not
+    uint16_t *chance;                  // solved
+    size_t    stored;                  // Chances in chance
+};
+
+extern struct winprob_t *winprob_solve(const double opponent[],
+                                       const unsigned int start,
+                                       const int threads);
+extern void   winprob_free(struct winprob_t *w);
+extern double winprob_value(const struct winprob_t *w, const int state,
+                            const int total);
+extern struct game_action_t winprob_choose(const struct winprob_t *w,
+                                           const struct game_t *game,
+                                           const int total,
+                                           struct solver_turn_t *turn);
+
+#endif // WINPROB_H